@@ -15,7 +15,7 @@ IF(UNIX)
 	 
 	 #dpkg-shlibdeps libLidarFormat.so
 	 SET(CPACK_DEBIAN_PACKAGE_DEPENDS
-	         "libboost-filesystem1.37.0 (>= 1.37.0-1), libboost-system1.37.0 (>= 1.37.0-1), libc6 (>= 2.4), libgcc1 (>= 1:4.1.1), libstdc++6 (>= 4.2.1), libxerces-c28"
+	         "libboost-filesystem1.37.0 (>= 1.37.0-1), libboost-system1.37.0 (>= 1.37.0-1), libboost-thread1.37.0 (>= 1.37.0-1), libc6 (>= 2.4), libgcc1 (>= 1:4.1.1), libstdc++6 (>= 4.2.1), libxerces-c28"
 	     )	 
 	 
 ENDIF(UNIX)
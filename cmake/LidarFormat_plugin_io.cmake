@@ -1,18 +1,13 @@
 ####
 #### Use LAS format
 ####
-OPTION( ENABLE_LAS "Enable LAS" OFF )
-if(ENABLE_LAS)
-    ADD_DEFINITIONS(-DENABLE_LAS)
-    AUX_SOURCE_DIRECTORY(${SRC_DIR}/LidarFormat/file_formats/LAS  SRC_LAS)
-    SET( ALL_SOURCES ${ALL_SOURCES} ${SRC_LAS})
-    
-    SET( LAS_DIRECTORY "" CACHE STRING "LibLAS include directory" )
-    SET( LAS_LIBRARY "" CACHE STRING "LibLAS library" )
-    INCLUDE_DIRECTORIES(${LAS_DIRECTORY})
-    
-    SET(LidarFormat_LIBRAIRIES ${LidarFormat_LIBRAIRIES} ${LAS_LIBRARY})
-endif(ENABLE_LAS)
+# always enable because it does not add any dependency (native reader and writer, no more liblas)
+ADD_DEFINITIONS(-DENABLE_LAS)
+AUX_SOURCE_DIRECTORY(${SRC_DIR}/LidarFormat/file_formats/LAS  SRC_LAS)
+SET( ALL_SOURCES ${ALL_SOURCES} ${SRC_LAS})
+
+FILE( GLOB LAS_HEADERS src/LidarFormat/file_formats/LAS/*.h )
+SET(ALL_FILE_FORMATS_HEADER_FILES ${ALL_FILE_FORMATS_HEADER_FILES} ${LAS_HEADERS})
 
 
 ####
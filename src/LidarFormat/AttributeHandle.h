@@ -0,0 +1,101 @@
+/***********************************************************************
+
+This file is part of the LidarFormat project source files.
+
+LidarFormat is an open source library for efficiently handling 3D point 
+clouds with a variable number of attributes at runtime. 
+
+
+Homepage: 
+
+    http://code.google.com/p/lidarformat
+
+Copyright:
+
+    Institut Geographique National & CEMAGREF (2009)
+
+Author: 
+
+    Adrien Chauve
+
+Contributors:
+
+    Nicolas David, Olivier Tournaire, Bruno Vallet
+
+
+
+    LidarFormat is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LidarFormat is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with LidarFormat.  If not, see <http://www.gnu.org/licenses/>.
+
+***********************************************************************/
+
+
+
+#ifndef ATTRIBUTEHANDLE_H_
+#define ATTRIBUTEHANDLE_H_
+
+#include <cassert>
+#include <stdexcept>
+#include <string>
+
+#include "LidarFormat/AttributesInfo.h"
+
+namespace Lidar
+{
+
+/**
+* @brief Typed handle on an attribute, resolved once by name (see LidarDataContainer::getAttributeHandle)
+*
+* Gives a direct access to the attribute of type T on echoes and iterators (value<T>(handle)), without looking up its name.
+* Adding or deleting attributes makes the handle stale: isValid() returns false and accesses assert in debug.
+*
+*/
+template<typename T>
+class AttributeHandle
+{
+public:
+    typedef T value_type;
+
+    /// invalid handle
+    AttributeHandle(): m_decalage(0), m_revision(0) {}
+
+    /// throws if attributeMap has no attribute attributeName of type T
+    AttributeHandle(const AttributeMapType& attributeMap, const std::string& attributeName):
+        m_revision(attributeMap.revision())
+    {
+        const AttributeMapType::const_iterator it = attributeMap.find(attributeName);
+        if(it == attributeMap.end())
+            throw std::logic_error("AttributeHandle: no attribute " + attributeName + "\n");
+        if(it->second.dataType() != LidarTypeTraits<T>::enum_type)
+            throw std::logic_error("AttributeHandle: attribute " + attributeName + " is of type " + Name(it->second.dataType()) +
+                                   ", not " + LidarTypeTraits<T>::name() + "\n");
+        m_decalage = it->second.decalage;
+    }
+
+    /// false if the handle is not resolved in attributeMap (or in a copy of it) or if its attributes changed since
+    /// (revisions are never reused, see UnsortedAssocMap::revision)
+    bool isValid(const AttributeMapType& attributeMap) const
+    {
+        return m_revision == attributeMap.revision();
+    }
+
+    unsigned int decalage() const { return m_decalage; }
+
+private:
+    unsigned int m_decalage;
+    std::size_t m_revision;
+};
+
+} //namespace Lidar
+
+#endif /* ATTRIBUTEHANDLE_H_ */
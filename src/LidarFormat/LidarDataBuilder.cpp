@@ -0,0 +1,132 @@
+/***********************************************************************
+
+This file is part of the LidarFormat project source files.
+
+LidarFormat is an open source library for efficiently handling 3D point 
+clouds with a variable number of attributes at runtime. 
+
+
+Homepage: 
+
+    http://code.google.com/p/lidarformat
+
+Copyright:
+
+    Institut Geographique National & CEMAGREF (2009)
+
+Author: 
+
+    Adrien Chauve
+
+Contributors:
+
+    Nicolas David, Olivier Tournaire, Bruno Vallet
+
+
+
+    LidarFormat is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LidarFormat is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with LidarFormat.  If not, see <http://www.gnu.org/licenses/>.
+
+***********************************************************************/
+
+
+
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "LidarFormat/LidarDataBuilder.h"
+
+namespace Lidar
+{
+
+namespace
+{
+bool rangeBefore(const detail::_LidarBuilderRange* lhs, const detail::_LidarBuilderRange* rhs)
+{
+    return lhs->first < rhs->first;
+}
+}
+
+LidarDataBuilder::LidarDataBuilder(LidarDataContainer& lidarContainer, const std::size_t nbEchos):
+    m_lidarContainer(lidarContainer), m_first(lidarContainer.size()), m_capacity(nbEchos), m_committed(false), m_nbAppended(0)
+{
+    m_lidarContainer.reserve(m_first + m_capacity);
+    // the room is written by the cursors: the reserved columns are only counted (resize would zero them again),
+    // the records are value initialized by the std::vector
+    if(m_lidarContainer.layout() == LidarDataContainer::columnar)
+        m_lidarContainer.nbEchos_ = m_first + m_capacity;
+    else
+        m_lidarContainer.resize(m_first + m_capacity);
+}
+
+LidarDataBuilder::~LidarDataBuilder()
+{
+    commit();
+}
+
+LidarAppendCursor LidarDataBuilder::cursor(const std::size_t first, const std::size_t count)
+{
+    if(m_committed || first > m_capacity || count > m_capacity - first)
+        throw std::logic_error("LidarDataBuilder::cursor: the echoes are out of the room of the builder\n");
+
+    detail::_LidarBuilderRange range;
+    range.first = first;
+    range.capacity = count;
+    range.size = 0;
+    m_ranges.push_back(range);
+
+    const bool columnar = m_lidarContainer.layout() == LidarDataContainer::columnar;
+    return LidarAppendCursor(m_ranges.back(), m_first + first, m_lidarContainer.dataPtr(), m_lidarContainer.pointSize(),
+                             columnar ? m_lidarContainer.columnCapacity_ : 0, m_lidarContainer.getAttributeMap());
+}
+
+std::size_t LidarDataBuilder::commit()
+{
+    if(m_committed)
+        return m_nbAppended;
+    m_committed = true;
+
+    std::vector<const detail::_LidarBuilderRange*> ranges;
+    for(std::deque<detail::_LidarBuilderRange>::const_iterator it = m_ranges.begin(); it != m_ranges.end(); ++it)
+        ranges.push_back(&*it);
+    std::sort(ranges.begin(), ranges.end(), rangeBefore);
+
+    //the appended echoes of each range are moved after those of the previous ranges (never after their own position)
+    const AttributeMapType& attributeMap = m_lidarContainer.getAttributeMap();
+    const std::size_t pointSize = m_lidarContainer.pointSize();
+    for(std::size_t r = 0; r < ranges.size(); ++r)
+    {
+        const std::size_t src = m_first + ranges[r]->first, dest = m_first + m_nbAppended, count = ranges[r]->size;
+        if(src != dest && count)
+        {
+            if(m_lidarContainer.layout() == LidarDataContainer::interleaved)
+                memmove(m_lidarContainer.dataPtr() + dest*pointSize, m_lidarContainer.dataPtr() + src*pointSize, count*pointSize);
+            else
+                for(AttributeMapType::const_iterator it = attributeMap.begin(); it != attributeMap.end(); ++it)
+                {
+                    const AttributeMapType::const_iterator next = it + 1;
+                    const std::size_t size = (next == attributeMap.end() ? pointSize : next->second.decalage) - it->second.decalage;
+                    char* column = m_lidarContainer.attributeData(it->second.decalage);
+                    memmove(column + dest*size, column + src*size, count*size);
+                }
+        }
+        m_nbAppended += count;
+    }
+
+    m_lidarContainer.resize(m_first + m_nbAppended);
+    m_ranges.clear();
+    return m_nbAppended;
+}
+
+} //namespace Lidar
@@ -0,0 +1,220 @@
+/***********************************************************************
+
+This file is part of the LidarFormat project source files.
+
+LidarFormat is an open source library for efficiently handling 3D point 
+clouds with a variable number of attributes at runtime. 
+
+
+Homepage: 
+
+    http://code.google.com/p/lidarformat
+
+Copyright:
+
+    Institut Geographique National & CEMAGREF (2009)
+
+Author: 
+
+    Adrien Chauve
+
+Contributors:
+
+    Nicolas David, Olivier Tournaire, Bruno Vallet
+
+
+
+    LidarFormat is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LidarFormat is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with LidarFormat.  If not, see <http://www.gnu.org/licenses/>.
+
+***********************************************************************/
+
+
+
+
+#ifndef LIDARDATABUILDER_H_
+#define LIDARDATABUILDER_H_
+
+#include <cassert>
+#include <cstring>
+#include <deque>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+#include "LidarFormat/LidarDataContainer.h"
+#include "LidarFormat/LidarEchoRef.h"
+
+namespace Lidar
+{
+
+namespace detail
+{
+	/// echoes [first, first+capacity[ of the room of a LidarDataBuilder written by a cursor, size echoes appended
+	/// padded to a cache line: the cursors of different threads update their sizes without false sharing
+	struct _LidarBuilderRange
+	{
+		std::size_t first, capacity, size;
+		char padding[64 - 3*sizeof(std::size_t)];
+	};
+}
+
+/**
+* @brief Appends echoes to a part of the room reserved by a LidarDataBuilder
+*
+* Each thread uses its own cursor: the cursors of a builder write disjoint echoes, without lock.
+* The records or the fields are written directly in the container (no resize, no LidarEcho).
+*
+*/
+class LidarAppendCursor
+{
+public:
+    std::size_t size() const { return m_range->size; }
+    std::size_t capacity() const { return m_range->capacity; }
+    bool full() const { return m_range->size == m_range->capacity; }
+
+    /// append an interleaved record of pointSize() bytes
+    void append(const char* record)
+    {
+        assert(!full());
+        const std::size_t index = m_first + m_range->size++;
+        if(!m_columnSize)
+        {
+            memcpy(m_basePtr + index*m_pointSize, record, m_pointSize);
+            return;
+        }
+        for(AttributeMapType::const_iterator it = m_attributeMap->begin(); it != m_attributeMap->end(); ++it)
+        {
+            const std::size_t size = attributeSize(it);
+            memcpy(m_basePtr + m_columnSize*it->second.decalage + index*size, record + it->second.decalage, size);
+        }
+    }
+
+    /// append a copy of an echo with the same attributes (any layout)
+    void append(const LidarConstEchoRef& echo)
+    {
+        assert(echo.size() == m_pointSize);
+        if(!m_columnSize)
+        {
+            assert(!full());
+            echo.copyTo(m_basePtr + (m_first + m_range->size++)*m_pointSize);
+            return;
+        }
+        m_record.resize(m_pointSize);
+        echo.copyTo(&m_record[0]);
+        append(&m_record[0]);
+    }
+
+    /// append an echo whose values are then set with value<T> (they are not initialized)
+    void append()
+    {
+        assert(!full());
+        ++m_range->size;
+    }
+
+    /// drop the last appended echo
+    void pop_back()
+    {
+        assert(m_range->size);
+        --m_range->size;
+    }
+
+    /// value of an attribute of the last appended echo
+    template<typename TAttributeType>
+    TAttributeType& value(const unsigned int decalage) const
+    {
+        assert(m_range->size);
+        const std::size_t index = m_first + m_range->size - 1;
+        if(!m_columnSize)
+            return *reinterpret_cast<TAttributeType*>(m_basePtr + index*m_pointSize + decalage);
+        return *reinterpret_cast<TAttributeType*>(m_basePtr + m_columnSize*decalage + index*sizeof(TAttributeType));
+    }
+
+    template<typename TAttributeType>
+    TAttributeType& value(const AttributeHandle<TAttributeType>& handle) const
+    {
+        assert(handle.isValid(*m_attributeMap));
+        return value<TAttributeType>(handle.decalage());
+    }
+
+private:
+    friend class LidarDataBuilder;
+
+    LidarAppendCursor(detail::_LidarBuilderRange& range, const std::size_t first, char* basePtr, const std::size_t pointSize,
+                      const std::size_t columnSize, const AttributeMapType& attributeMap):
+        m_range(&range), m_first(first), m_basePtr(basePtr), m_pointSize(pointSize), m_columnSize(columnSize), m_attributeMap(&attributeMap)
+    {
+    }
+
+    std::size_t attributeSize(const AttributeMapType::const_iterator& it) const
+    {
+        const AttributeMapType::const_iterator next = it + 1;
+        return (next == m_attributeMap->end() ? m_pointSize : next->second.decalage) - it->second.decalage;
+    }
+
+    detail::_LidarBuilderRange* m_range;
+    /// index in the container of the first echo of the range
+    std::size_t m_first;
+
+    //same storage as LidarConstEchoRef: records at basePtr, or columns of columnSize echoes
+    char* m_basePtr;
+    std::size_t m_pointSize;
+    std::size_t m_columnSize;
+    const AttributeMapType* m_attributeMap;
+
+    /// columnar layout: conversion of an echo to a record
+    std::vector<char> m_record;
+};
+
+/**
+* @brief Bulk filling of a container: the room of the new echoes is allocated once, filled by cursors, and committed once
+*
+* The room is split in ranges, each one filled by a cursor (one per thread). The commit keeps the appended echoes
+* of each range, in the order of the ranges, and shrinks the container to them.
+* The container must not be modified (size, attributes, layout) until the commit.
+*
+*/
+class LidarDataBuilder : private boost::noncopyable
+{
+public:
+    /// room for nbEchos echoes after the echoes of lidarContainer (allocated in a single reallocation)
+    /// the allocation zero fills the room once (std::vector), the echoes that are not appended are dropped by the commit
+    LidarDataBuilder(LidarDataContainer& lidarContainer, const std::size_t nbEchos);
+    /// commits if it is not done
+    ~LidarDataBuilder();
+
+    std::size_t capacity() const { return m_capacity; }
+
+    /// cursor appending to the echoes [first, first+count[ of the room (throws if they are out of the room)
+    /// the ranges of the cursors must not overlap, all the cursors are invalidated by the commit
+    LidarAppendCursor cursor(const std::size_t first, const std::size_t count);
+    /// cursor on the whole room
+    LidarAppendCursor cursor() { return cursor(0, m_capacity); }
+
+    /// keep the appended echoes (in the order of the ranges) and drop the remaining room, returns the number of echoes appended
+    std::size_t commit();
+
+private:
+    LidarDataContainer& m_lidarContainer;
+    /// size of the container before the room
+    std::size_t m_first;
+    std::size_t m_capacity;
+    /// stable addresses (used by the cursors)
+    std::deque<detail::_LidarBuilderRange> m_ranges;
+    bool m_committed;
+    std::size_t m_nbAppended;
+};
+
+} //namespace Lidar
+
+#endif /* LIDARDATABUILDER_H_ */
@@ -43,7 +43,10 @@ Contributors:
 
 #include <stdexcept>
 #include <fstream>
+#include <sstream>
 #include <algorithm>
+#include <cmath>
+#include <limits>
 #include <stdio.h>
 using namespace std;
 
@@ -51,10 +54,15 @@ using namespace std;
 #include <boost/bind/placeholders.hpp>
 
 #include <boost/noncopyable.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
 
 #include "LidarFormat/LidarDataFormatTypes.h"
 #include "LidarFormat/LidarFile.h"
 #include "LidarFormat/tools/AttributeBounds.h"
+#include "LidarFormat/tools/AttributeStatistics.h"
+#include "LidarFormat/tools/ParallelBlocks.h"
+#include "LidarFormat/tools/ValueConversion.h"
 #include "apply.h"
 
 #include "LidarDataContainer.h"
@@ -67,7 +75,56 @@ namespace Lidar
 
 void LidarDataContainer::clear()
 {
-    lidarData_.clear();
+    if(layout_ == columnar)
+        nbEchos_ = 0;
+    else
+        lidarData_.clear();
+
+    mappedRegion_.reset();
+    mappedData_ = 0;
+    mappedSize_ = 0;
+}
+
+void LidarDataContainer::mapRawData(const std::string& filename, const std::size_t offset, const std::size_t nbEchos, const bool copyOnWrite)
+{
+    using namespace boost::interprocess;
+
+    if(layout_ != interleaved)
+        throw std::logic_error("LidarDataContainer::mapRawData: only available for the interleaved layout\n");
+
+    clear();
+    LidarDataContainerType().swap(lidarData_);
+
+    const std::size_t size = nbEchos*pointSize();
+    if(size == 0)
+        return;
+
+    try
+    {
+        file_mapping file(filename.c_str(), read_only);
+        mappedRegion_.reset(new mapped_region(file, copyOnWrite ? copy_on_write : read_only, offset, size));
+    }
+    catch(const interprocess_exception& e)
+    {
+        throw std::logic_error("LidarDataContainer::mapRawData: failed to map " + filename + ": " + e.what() + "\n");
+    }
+
+    mappedData_ = static_cast<char*>(mappedRegion_->get_address());
+    mappedSize_ = size;
+    copyOnWrite_ = copyOnWrite;
+}
+
+void LidarDataContainer::unmapRawData()
+{
+    if(!mappedData_)
+        return;
+
+    LidarDataContainerType data(mappedData_, mappedData_ + mappedSize_);
+    lidarData_.swap(data);
+
+    mappedRegion_.reset();
+    mappedData_ = 0;
+    mappedSize_ = 0;
 }
 
 
@@ -107,32 +164,48 @@ void LidarDataContainer::getAttributeCleanBounds(const std::string &attributeNam
     AttributesInfo & info = it->second;
     if(force_recompute || info.Dirty())
     {
-        FonctorMultiAbstractBound fmab;
-        fmab.AddAttribute(it->first, info.decalage, info.dataType());
-        fmab = std::for_each (begin(), end(), fmab);
-        fmab.mvp_attrib[0]->Get(min, max);
-        info.min(min); info.max(max);
+        std::vector<AttributeBoundValues> bounds;
+        computeAttributeBounds(*this, std::vector<std::string>(1, attributeName), bounds);
+        info.min(bounds[0].min); info.max(bounds[0].max);
     }
     min = info.min().get(); max = info.max().get();
 }
 
 void LidarDataContainer::recomputeBounds(bool force_recompute)
 {
-    FonctorMultiAbstractBound fmab;
-    for(AttributeMapType::iterator it = attributeMap_->begin(); it != attributeMap_->end(); it++)
-        if(force_recompute || it->second.Dirty())
-        {
-            fmab.AddAttribute(it->first, it->second.decalage, it->second.dataType());
-        }
-    fmab = std::for_each (begin(), end(), fmab);
-    int i=0;
+    std::vector<std::string> attributeNames;
     for(AttributeMapType::iterator it = attributeMap_->begin(); it != attributeMap_->end(); it++)
         if(force_recompute || it->second.Dirty())
+            attributeNames.push_back(it->first);
+    if(attributeNames.empty())
+        return;
+
+    // all the attributes in a single parallel pass
+    std::vector<AttributeBoundValues> bounds;
+    computeAttributeBounds(*this, attributeNames, bounds);
+    for(std::size_t i = 0; i < attributeNames.size(); ++i)
+    {
+        AttributesInfo& info = attributeMap_->find(attributeNames[i])->second;
+        info.min(bounds[i].min); info.max(bounds[i].max); // sets optional attribute as present => not dirty
+    }
+}
+
+void LidarDataContainer::computeStatistics(std::vector<AttributeStatistics>& statistics, const std::size_t nbBins)
+{
+    std::vector<std::string> attributeNames;
+    for(AttributeMapType::const_iterator it = attributeMap_->begin(); it != attributeMap_->end(); ++it)
+        attributeNames.push_back(it->first);
+
+    computeAttributeStatistics(*this, attributeNames, statistics, nbBins);
+    for(std::size_t i = 0; i < statistics.size(); ++i)
+    {
+        AttributesInfo& info = attributeMap_->find(attributeNames[i])->second;
+        info.min(statistics[i].min); info.max(statistics[i].max);
+        if(statistics[i].count)
         {
-            double min, max;
-            fmab.mvp_attrib[i++]->Get(min, max);
-            it->second.min(min); it->second.max(max); // sets optional attribute as present => not dirty
+            info.mean(statistics[i].mean()); info.stddev(statistics[i].stddev());
         }
+    }
 }
 
 bool LidarDataContainer::getCenteringTransfo(double & x, double & y) const
@@ -157,12 +230,39 @@ void LidarDataContainer::setCenteringTransfo(double x, double y) const
 
 LidarDataContainer::LidarDataContainer():
     attributeMap_(new AttributeMapType),
+    pointSize_(0),
+    layout_(interleaved),
+    nbEchos_(0),
+    columnCapacity_(0),
+    mappedData_(0),
+    mappedSize_(0),
+    copyOnWrite_(false),
+    m_xmlData(new cs::LidarDataType(cs::LidarDataType::AttributesType(0, cs::DataFormatType::binary)))
+{
+}
+
+LidarDataContainer::LidarDataContainer(Layout layout):
+    attributeMap_(new AttributeMapType),
+    pointSize_(0),
+    layout_(layout),
+    nbEchos_(0),
+    columnCapacity_(0),
+    mappedData_(0),
+    mappedSize_(0),
+    copyOnWrite_(false),
     m_xmlData(new cs::LidarDataType(cs::LidarDataType::AttributesType(0, cs::DataFormatType::binary)))
 {
 }
 
 LidarDataContainer::LidarDataContainer(shared_ptr<cs::LidarDataType> xmlData):
     attributeMap_(new AttributeMapType),
+    pointSize_(0),
+    layout_(interleaved),
+    nbEchos_(0),
+    columnCapacity_(0),
+    mappedData_(0),
+    mappedSize_(0),
+    copyOnWrite_(false),
     m_xmlData(new cs::LidarDataType(cs::LidarDataType::AttributesType(0, cs::DataFormatType::binary)))
 {
     setMapsFromXML(xmlData);
@@ -170,6 +270,13 @@ LidarDataContainer::LidarDataContainer(shared_ptr<cs::LidarDataType> xmlData):
 
 LidarDataContainer::LidarDataContainer(std::string dataFileName, bool meta_only):
     attributeMap_(new AttributeMapType),
+    pointSize_(0),
+    layout_(interleaved),
+    nbEchos_(0),
+    columnCapacity_(0),
+    mappedData_(0),
+    mappedSize_(0),
+    copyOnWrite_(false),
     m_xmlData(new cs::LidarDataType(cs::LidarDataType::AttributesType(0, cs::DataFormatType::binary)))
 {
     load(dataFileName, meta_only);
@@ -177,6 +284,13 @@ LidarDataContainer::LidarDataContainer(std::string dataFileName, bool meta_only)
 
 LidarDataContainer::LidarDataContainer(const LidarDataContainer& rhs):
     attributeMap_(new AttributeMapType),
+    pointSize_(0),
+    layout_(interleaved),
+    nbEchos_(0),
+    columnCapacity_(0),
+    mappedData_(0),
+    mappedSize_(0),
+    copyOnWrite_(false),
     m_xmlData(new cs::LidarDataType(cs::LidarDataType::AttributesType(0, cs::DataFormatType::binary)))
 {
     copy(rhs);
@@ -197,7 +311,30 @@ void LidarDataContainer::setMapsFromXML(shared_ptr<cs::LidarDataType> xmlData)
     for (itAttribute = m_xmlData->attributes().attribute().begin();
          itAttribute != m_xmlData->attributes().attribute().end(); ++itAttribute)
     {
-        //TODO adapt if we do not want to load everything
+        addAttribute(itAttribute);
+    }
+}
+
+void LidarDataContainer::setMapsFromXML(shared_ptr<cs::LidarDataType> xmlData, const std::vector<std::string>& attributeNames)
+{
+    // the attributes are selected in a copy: the container is not modified if some of them are missing
+    cs::LidarDataType selectedXmlData(*xmlData);
+    cs::LidarDataType::AttributesType::AttributeSequence& attributes = selectedXmlData.attributes().attribute();
+    cs::LidarDataType::AttributesType::AttributeIterator itAttribute = attributes.begin();
+    while(itAttribute != attributes.end())
+    {
+        if(std::find(attributeNames.begin(), attributeNames.end(), itAttribute->name()) == attributeNames.end())
+            itAttribute = attributes.erase(itAttribute);
+        else
+            ++itAttribute;
+    }
+
+    if(attributes.size() != attributeNames.size())
+        throw std::logic_error("LidarDataContainer::setMapsFromXML: some attributes to load are not in the file (or are given twice)\n");
+
+    *m_xmlData = selectedXmlData;
+    for (itAttribute = m_xmlData->attributes().attribute().begin(); itAttribute != m_xmlData->attributes().attribute().end(); ++itAttribute)
+    {
         addAttribute(itAttribute);
     }
 }
@@ -246,20 +383,218 @@ void LidarDataContainer::save(std::string dataFileName, cs::DataFormatType forma
     LidarFile::save(*this, dataFileName, format);
 }
 
+template<EnumLidarDataType T>
+struct PointSizeFunctor
+{
+    unsigned int operator()()
+    {
+        return sizeof( typename LidarEnumTypeTraits<T>::type );
+    }
+};
+
+
 void LidarDataContainer::copy(const LidarDataContainer& rhs, bool copy_data)
 {
     *attributeMap_ = *rhs.attributeMap_;
     *m_xmlData = *rhs.m_xmlData;
 
     pointSize_ = rhs.pointSize_;
-    if(copy_data) lidarData_ = rhs.lidarData_;
+    layout_ = rhs.layout_;
+    if(copy_data)
+    {
+        mappedRegion_.reset();
+        mappedData_ = 0;
+        mappedSize_ = 0;
+
+        // read only mappings are shared, copy on write mappings are private: their data is copied
+        if(rhs.mappedData_ && !rhs.copyOnWrite_)
+        {
+            LidarDataContainerType().swap(lidarData_);
+            mappedRegion_ = rhs.mappedRegion_;
+            mappedData_ = rhs.mappedData_;
+            mappedSize_ = rhs.mappedSize_;
+            copyOnWrite_ = false;
+        }
+        else if(rhs.mappedData_)
+            lidarData_.assign(rhs.mappedData_, rhs.mappedData_ + rhs.mappedSize_);
+        else
+            lidarData_ = rhs.lidarData_;
+        nbEchos_ = rhs.nbEchos_;
+        columnCapacity_ = rhs.columnCapacity_;
+    }
+    else if(layout_ == columnar)
+    {
+        lidarData_.clear();
+        nbEchos_ = columnCapacity_ = 0;
+    }
 }
 
 void LidarDataContainer::append(const LidarDataContainer& rhs)
 {
     //	assert(*rhs.attributeMap_ == *attributeMap_);
 
-    lidarData_.insert(lidarData_.end(), rhs.lidarData_.begin(), rhs.lidarData_.end());
+    if(layout_ == interleaved && rhs.layout_ == interleaved)
+    {
+        unmapRawData();
+        lidarData_.insert(lidarData_.end(), rhs.dataPtr(), rhs.dataPtr() + rhs.dataSize());
+        return;
+    }
+
+    const std::size_t oldSize = size();
+    const std::size_t rhsSize = rhs.size();
+    resize(oldSize + rhsSize);
+
+    if(rhs.layout_ == interleaved)
+        importRecords(rhs.dataPtr(), oldSize, rhsSize);
+    else if(layout_ == interleaved)
+        rhs.exportRecords(rawData(oldSize), 0, rhsSize);
+    else
+    {
+        for(AttributeMapType::const_iterator it = attributeMap_->begin(); it != attributeMap_->end(); ++it)
+        {
+            const unsigned int sizeAttribute = apply<PointSizeFunctor, unsigned int>(it->second.dataType());
+            memcpy(attributeData(it->second.decalage) + oldSize*sizeAttribute, rhs.attributeData(it->second.decalage), rhsSize*sizeAttribute);
+        }
+    }
+}
+
+unsigned int LidarDataContainer::erase(const unsigned int first, const unsigned int last)
+{
+    if(layout_ == interleaved)
+    {
+        unmapRawData();
+        lidarData_.erase(lidarData_.begin() + first*pointSize(), lidarData_.begin() + last*pointSize());
+        return first;
+    }
+
+    for(AttributeMapType::const_iterator it = attributeMap_->begin(); it != attributeMap_->end(); ++it)
+    {
+        const unsigned int sizeAttribute = apply<PointSizeFunctor, unsigned int>(it->second.dataType());
+        char* column = attributeData(it->second.decalage);
+        memmove(column + first*sizeAttribute, column + last*sizeAttribute, (nbEchos_ - last)*sizeAttribute);
+    }
+    nbEchos_ -= last - first;
+    return first;
+}
+
+namespace
+{
+/// copy count values of Size bytes between two strided arrays (interleaved records <-> columns)
+template<unsigned int Size>
+void copyStridedValues(char* dest, const std::size_t destIncrement, const char* src, const std::size_t srcIncrement, const std::size_t count)
+{
+    for(std::size_t i = 0; i < count; ++i, dest += destIncrement, src += srcIncrement)
+        memcpy(dest, src, Size);
+}
+
+void copyStridedValues(char* dest, const std::size_t destIncrement, const char* src, const std::size_t srcIncrement, const std::size_t count, const unsigned int size)
+{
+    if(destIncrement == size && srcIncrement == size)
+    {
+        memcpy(dest, src, count*size);
+        return;
+    }
+    switch(size)
+    {
+    case 1: copyStridedValues<1>(dest, destIncrement, src, srcIncrement, count); break;
+    case 2: copyStridedValues<2>(dest, destIncrement, src, srcIncrement, count); break;
+    case 4: copyStridedValues<4>(dest, destIncrement, src, srcIncrement, count); break;
+    case 8: copyStridedValues<8>(dest, destIncrement, src, srcIncrement, count); break;
+    default:
+        for(std::size_t i = 0; i < count; ++i, dest += destIncrement, src += srcIncrement)
+            memcpy(dest, src, size);
+    }
+}
+}
+
+void LidarDataContainer::exportRecords(char* dest, const std::size_t first, const std::size_t count) const
+{
+    assert(first + count <= size());
+
+    if(layout_ == interleaved)
+    {
+        memcpy(dest, dataPtr() + first*pointSize(), count*pointSize());
+        return;
+    }
+
+    for(AttributeMapType::const_iterator it = attributeMap_->begin(); it != attributeMap_->end(); ++it)
+    {
+        const unsigned int sizeAttribute = apply<PointSizeFunctor, unsigned int>(it->second.dataType());
+        copyStridedValues(dest + it->second.decalage, pointSize(), attributeData(it->second.decalage) + first*sizeAttribute, sizeAttribute, count, sizeAttribute);
+    }
+}
+
+void LidarDataContainer::importRecords(const char* src, const std::size_t first, const std::size_t count)
+{
+    assert(first + count <= size());
+
+    if(layout_ == interleaved)
+    {
+        memcpy(rawData() + first*pointSize(), src, count*pointSize());
+        return;
+    }
+
+    for(AttributeMapType::const_iterator it = attributeMap_->begin(); it != attributeMap_->end(); ++it)
+    {
+        const unsigned int sizeAttribute = apply<PointSizeFunctor, unsigned int>(it->second.dataType());
+        copyStridedValues(attributeData(it->second.decalage) + first*sizeAttribute, sizeAttribute, src + it->second.decalage, pointSize(), count, sizeAttribute);
+    }
+}
+
+void LidarDataContainer::setLayout(Layout layout)
+{
+    if(layout == layout_)
+        return;
+
+    const std::size_t nbEchos = size();
+    LidarDataContainerType data(nbEchos*pointSize());
+
+    if(layout == interleaved)
+    {
+        if(nbEchos)
+            exportRecords(&data.front(), 0, nbEchos);
+    }
+    else
+    {
+        for(AttributeMapType::const_iterator it = attributeMap_->begin(); it != attributeMap_->end(); ++it)
+        {
+            const unsigned int sizeAttribute = apply<PointSizeFunctor, unsigned int>(it->second.dataType());
+            if(nbEchos)
+                copyStridedValues(&data.front() + nbEchos*it->second.decalage, sizeAttribute, dataPtr() + it->second.decalage, pointSize(), nbEchos, sizeAttribute);
+        }
+    }
+
+    unmapRawData();
+    lidarData_.swap(data);
+    layout_ = layout;
+    nbEchos_ = columnCapacity_ = (layout == columnar ? nbEchos : 0);
+}
+
+void LidarDataContainer::setColumnCapacity(const std::size_t capacity)
+{
+    assert(layout_ == columnar && capacity >= nbEchos_);
+
+    LidarDataContainerType data(capacity*pointSize());
+    for(AttributeMapType::const_iterator it = attributeMap_->begin(); it != attributeMap_->end(); ++it)
+    {
+        const unsigned int sizeAttribute = apply<PointSizeFunctor, unsigned int>(it->second.dataType());
+        if(nbEchos_)
+            memcpy(&data.front() + capacity*it->second.decalage, attributeData(it->second.decalage), nbEchos_*sizeAttribute);
+    }
+
+    lidarData_.swap(data);
+    columnCapacity_ = capacity;
+}
+
+void LidarDataContainer::zeroColumns(const std::size_t first, const std::size_t last)
+{
+    assert(layout_ == columnar && first <= last && last <= columnCapacity_);
+
+    for(AttributeMapType::const_iterator it = attributeMap_->begin(); it != attributeMap_->end(); ++it)
+    {
+        const unsigned int sizeAttribute = apply<PointSizeFunctor, unsigned int>(it->second.dataType());
+        memset(attributeData(it->second.decalage) + first*sizeAttribute, 0, (last - first)*sizeAttribute);
+    }
 }
 
 //struct FunctorAddAttributeParameters
@@ -293,18 +628,17 @@ void LidarDataContainer::append(const LidarDataContainer& rhs)
 //};
 
 
-template<EnumLidarDataType T>
-struct PointSizeFunctor
+void LidarDataContainer::updateAttributeContent(const unsigned int oldPointSize)
 {
-    unsigned int operator()()
+    // columnar layout: the new columns are simply added after the existing ones
+    if(layout_ == columnar)
     {
-        return sizeof( typename LidarEnumTypeTraits<T>::type );
+        lidarData_.resize(columnCapacity_*pointSize_);
+        return;
     }
-};
 
+    unmapRawData();
 
-void LidarDataContainer::updateAttributeContent(const unsigned int oldPointSize)
-{
     lidarData_.resize(lidarData_.size()/oldPointSize*pointSize_);
 
     /// update data, shift attributes and initialise new attribute
@@ -359,7 +693,7 @@ bool LidarDataContainer::addAttribute(cs::LidarDataType::AttributesType::Attribu
     if(!attributeAdded)
         return false;
 
-    if(!empty())
+    if(layout_ == columnar || !empty())
         updateAttributeContent(oldPointSize);
 
     return true;
@@ -376,21 +710,9 @@ bool LidarDataContainer::addAttribute(std::string name, EnumLidarDataType type)
 
 void LidarDataContainer::addAttributeList(const std::vector<std::pair<std::string, EnumLidarDataType> > attributes)
 {
-    const unsigned int oldPointSize = pointSize_;
-
-
-    std::vector<std::pair<std::string, EnumLidarDataType> >::const_iterator itb = attributes.begin();
-    const std::vector<std::pair<std::string, EnumLidarDataType> >::const_iterator ite = attributes.end();
-
-    for( ; itb != ite; ++itb)
-    {
-        cs::AttributeType attrib_type(itb->second, itb->first);
-        m_xmlData->attributes().attribute().push_back(attrib_type);
-        cs::LidarDataType::AttributesType::AttributeIterator it = m_xmlData->attributes().attribute().end(); it--;
-        addAttributeHelper(it);
-    }
-    if(!empty())
-        updateAttributeContent(oldPointSize);
+    AttributeChanges changes;
+    changes.added = attributes;
+    changeAttributes(changes);
 }
 
 struct predicate_true
@@ -415,6 +737,7 @@ bool LidarDataContainer::delAttribute(const std::string& attributeName)
     // update pointSize :
     const unsigned int oldPointSize = pointSize_;
     const unsigned int nbPoints = size();
+    unmapRawData();
     pointSize_ -= sizeAttribute;
     //cout << "strideAttribute=" << strideAttribute << endl;
     //cout << "sizeAttribute=" << sizeAttribute << endl;
@@ -423,6 +746,13 @@ bool LidarDataContainer::delAttribute(const std::string& attributeName)
     //cout << "afterAttribSize_=" << oldPointSize - strideAttribute - sizeAttribute << endl;
     //cout << "nbPoints=" << nbPoints << endl;
 
+    if(layout_ == columnar)
+    {
+        // the following columns are all moved in a single operation
+        lidarData_.erase(lidarData_.begin() + columnCapacity_*strideAttribute, lidarData_.begin() + columnCapacity_*(strideAttribute + sizeAttribute));
+    }
+    else
+    {
     /// update data, shift attributes
     LidarDataContainerType::iterator itOldAttributePosition = lidarData_.begin() + strideAttribute;
     LidarDataContainerType::iterator itNewAttributePosition = itOldAttributePosition;
@@ -436,6 +766,7 @@ bool LidarDataContainer::delAttribute(const std::string& attributeName)
 
     // resize the container to its new size nbPoints*pointSize_ < old size = nbPoints*oldPointSize
     lidarData_.erase(lidarData_.begin() + nbPoints*pointSize_, lidarData_.end());
+    }
 
     // delete attribute in the maps, update shifts after deleted attribute
     AttributeMapType::iterator itSuccessor = attributeMap_->erase(attributeMap_->find(attributeName));
@@ -448,8 +779,340 @@ bool LidarDataContainer::delAttribute(const std::string& attributeName)
 
 void LidarDataContainer::delAttributeList(const std::vector<std::string>& attributeNames)
 {
-    for(std::vector<std::string>::const_iterator it = attributeNames.begin(); it != attributeNames.end(); ++it)
-        delAttribute(*it);
+    AttributeChanges changes;
+    changes.removed = attributeNames;
+    changeAttributes(changes);
+}
+
+namespace
+{
+/// number of echoes under which the attributes are reshaped by a single thread
+const std::size_t reshapeBlockSize = 1 << 16;
+
+/// copy of the values of an attribute (or of consecutive attributes not converted) from the old data to the new data in changeAttributes
+struct AttributeReshape
+{
+    std::size_t srcOffset, srcIncrement, destOffset, destIncrement;
+    unsigned int size;
+    EnumLidarDataType srcType, destType;
+    AttributeChanges::Policy policy;
+    double shift;
+    std::string name;
+
+    bool isCopy() const { return srcType == destType && shift == 0.; }
+};
+
+/// conversion of count values of type TSource to the type TDestType, between strided arrays, shift is subtracted first (in double)
+/// returns the number of values out of the range of TDestType (not counted with the cast policy)
+template<typename TSource>
+struct ConvertValues
+{
+    template<EnumLidarDataType TDestType>
+    struct Functor
+    {
+        typedef typename LidarEnumTypeTraits<TDestType>::type DestType;
+
+        std::size_t operator()(char* dest, const std::size_t destIncrement, const char* src, const std::size_t srcIncrement, const std::size_t count,
+                               const AttributeChanges::Policy policy, const double shift)
+        {
+            // columns: typed loops over contiguous values, that the compiler vectorizes (subtract and narrow for the centering)
+            if(destIncrement == sizeof(DestType) && srcIncrement == sizeof(TSource))
+            {
+                DestType* destValues = reinterpret_cast<DestType*>(dest);
+                const TSource* srcValues = reinterpret_cast<const TSource*>(src);
+                if(policy == AttributeChanges::cast)
+                {
+                    if(shift == 0.)
+                        for(std::size_t i = 0; i < count; ++i)
+                            destValues[i] = static_cast<DestType>(srcValues[i]);
+                    else
+                        for(std::size_t i = 0; i < count; ++i)
+                            destValues[i] = static_cast<DestType>(srcValues[i] - shift);
+                    return 0;
+                }
+
+                // clamp and check: same loops with the range test, the policy only matters to the caller
+                std::size_t outOfRange = 0;
+                if(shift == 0.)
+                    for(std::size_t i = 0; i < count; ++i)
+                        outOfRange += !Lidar::convertValue(srcValues[i], destValues[i]);
+                else
+                    for(std::size_t i = 0; i < count; ++i)
+                        outOfRange += !Lidar::convertValue(static_cast<double>(srcValues[i]) - shift, destValues[i]);
+                return outOfRange;
+            }
+
+            // interleaved records: the cast (and the subtract and narrow of the centering) without test in the loop
+            if(policy == AttributeChanges::cast)
+            {
+                TSource value;
+                DestType converted;
+                if(shift == 0.)
+                    for(std::size_t i = 0; i < count; ++i, dest += destIncrement, src += srcIncrement)
+                    {
+                        memcpy(&value, src, sizeof(TSource));
+                        converted = static_cast<DestType>(value);
+                        memcpy(dest, &converted, sizeof(DestType));
+                    }
+                else
+                    for(std::size_t i = 0; i < count; ++i, dest += destIncrement, src += srcIncrement)
+                    {
+                        memcpy(&value, src, sizeof(TSource));
+                        converted = static_cast<DestType>(value - shift);
+                        memcpy(dest, &converted, sizeof(DestType));
+                    }
+                return 0;
+            }
+
+            std::size_t outOfRange = 0;
+            for(std::size_t i = 0; i < count; ++i, dest += destIncrement, src += srcIncrement)
+            {
+                TSource value;
+                memcpy(&value, src, sizeof(TSource));
+                DestType converted;
+                if(shift == 0.)
+                    outOfRange += !convertValue(value, converted);
+                else
+                    outOfRange += !convertValue(static_cast<double>(value) - shift, converted);
+                memcpy(dest, &converted, sizeof(DestType));
+            }
+            return outOfRange;
+        }
+    };
+};
+
+template<EnumLidarDataType TSourceType>
+struct ConvertFunctor
+{
+    std::size_t operator()(const EnumLidarDataType destType, char* dest, const std::size_t destIncrement, const char* src, const std::size_t srcIncrement,
+                           const std::size_t count, const AttributeChanges::Policy policy, const double shift)
+    {
+        typedef typename LidarEnumTypeTraits<TSourceType>::type SourceType;
+        return apply<ConvertValues<SourceType>::template Functor, std::size_t, char*, const std::size_t, const char*, const std::size_t, const std::size_t,
+                     const AttributeChanges::Policy, const double>(destType, dest, destIncrement, src, srcIncrement, count, policy, shift);
+    }
+};
+
+/// reshape of the echoes [srcFirst, srcFirst+count[ of src to the echoes [destFirst, destFirst+count[ of dest
+/// counts the values out of the range of their new type for each reshape
+void reshapeBlock(const char* src, char* dest, const std::vector<AttributeReshape>& reshapes, const std::size_t srcFirst, const std::size_t destFirst,
+                  const std::size_t count, std::vector<std::size_t>& outOfRange)
+{
+    outOfRange.assign(reshapes.size(), 0);
+    for(std::size_t r = 0; r < reshapes.size(); ++r)
+    {
+        const AttributeReshape& reshape = reshapes[r];
+        const char* srcValues = src + reshape.srcOffset + srcFirst*reshape.srcIncrement;
+        char* destValues = dest + reshape.destOffset + destFirst*reshape.destIncrement;
+        if(reshape.isCopy())
+            copyStridedValues(destValues, reshape.destIncrement, srcValues, reshape.srcIncrement, count, reshape.size);
+        else
+            outOfRange[r] = apply<ConvertFunctor, std::size_t, const EnumLidarDataType, char*, const std::size_t, const char*, const std::size_t, const std::size_t,
+                                  const AttributeChanges::Policy, const double>(
+                        reshape.srcType, reshape.destType, destValues, reshape.destIncrement, srcValues, reshape.srcIncrement, count, reshape.policy, reshape.shift);
+    }
+}
+
+/// reshape of the echoes [first, first+count[ of src to the same echoes of dest, the out of range values are counted in outOfRange[block]
+void reshapeEchoes(const char* src, char* dest, const std::vector<AttributeReshape>& reshapes, std::vector<std::vector<std::size_t> >& outOfRange,
+                   const std::size_t block, const std::size_t first, const std::size_t count)
+{
+    reshapeBlock(src, dest, reshapes, first, first, count, outOfRange[block]);
+}
+
+/// reshape of the echoes [roundFirst+first, roundFirst+first+count[ of data to buffers[block] (grown to count records of newPointSize bytes)
+void reshapeToBuffer(const char* data, std::vector<std::vector<char> >& buffers, const std::vector<AttributeReshape>& reshapes, const std::size_t roundFirst,
+                     const unsigned int newPointSize, std::vector<std::vector<std::size_t> >& outOfRange, const std::size_t block, const std::size_t first, const std::size_t count)
+{
+    if(buffers[block].size() < count*newPointSize)
+        buffers[block].resize(count*newPointSize);
+    reshapeBlock(data, &buffers[block].front(), reshapes, roundFirst + first, 0, count, outOfRange[block]);
+}
+
+/// in place reshape of interleaved records which do not grow: rounds of blocks reshaped by several threads in small buffers,
+/// then copied in order (the records of a round are written over the old records of the round and of the previous ones)
+void reshapeInPlace(char* data, const std::vector<AttributeReshape>& reshapes, const std::size_t nbEchos, const unsigned int newPointSize)
+{
+    const std::size_t nbThreads = nbParallelBlocks(nbEchos, reshapeBlockSize);
+    std::vector<std::vector<char> > buffers(nbThreads);
+    std::vector<std::vector<std::size_t> > outOfRange(nbThreads);
+    for(std::size_t roundFirst = 0; roundFirst < nbEchos; roundFirst += nbThreads*reshapeBlockSize)
+    {
+        const std::size_t roundCount = std::min(nbThreads*reshapeBlockSize, nbEchos - roundFirst);
+        parallelForBlocks(roundCount, reshapeBlockSize, boost::bind(&reshapeToBuffer, data, boost::ref(buffers), boost::cref(reshapes), roundFirst, newPointSize,
+                                                                    boost::ref(outOfRange), _1, _2, _3));
+
+        const std::size_t blockSize = parallelBlockSize(roundCount, reshapeBlockSize);
+        for(std::size_t t = 0; t < nbParallelBlocks(roundCount, reshapeBlockSize); ++t)
+            memmove(data + (roundFirst + t*blockSize)*newPointSize, &buffers[t].front(), std::min(blockSize, roundCount - t*blockSize)*newPointSize);
+    }
+}
+}
+
+void LidarDataContainer::changeAttributes(const AttributeChanges& changes)
+{
+    typedef std::vector<AttributeChanges::TypeChange>::const_iterator TypeChangeIterator;
+    typedef std::vector<std::pair<std::string, EnumLidarDataType> >::const_iterator AddIterator;
+    for(TypeChangeIterator it = changes.typeChanges.begin(); it != changes.typeChanges.end(); ++it)
+        if(!checkAttributeIsPresent(it->name))
+            throw std::logic_error("LidarDataContainer::changeAttributes: attribute " + it->name + " is not in the container\n");
+
+    // new attributes: the kept ones with their new types, then the added ones
+    AttributeMapType attributeMap;
+    std::vector<const AttributesInfo*> keptAttributes;
+    std::vector<AttributeChanges::Policy> policies;
+    std::vector<double> shifts;
+    unsigned int newPointSize = 0;
+    for(AttributeMapType::const_iterator it = attributeMap_->begin(); it != attributeMap_->end(); ++it)
+    {
+        if(std::find(changes.removed.begin(), changes.removed.end(), it->first) != changes.removed.end())
+            continue;
+
+        AttributesInfo infos(it->second);
+        AttributeChanges::Policy policy = AttributeChanges::cast;
+        double shift = 0.;
+        for(TypeChangeIterator itType = changes.typeChanges.begin(); itType != changes.typeChanges.end(); ++itType)
+            if(itType->name == it->first)
+            {
+                infos.dataType(itType->type);
+                policy = itType->policy;
+                shift = itType->shift;
+            }
+        if(infos.dataType() != it->second.dataType() || shift != 0.)
+        {
+            // the statistics of the attribute are recomputed on demand
+            infos.min().reset(); infos.max().reset();
+            infos.mean().reset(); infos.stddev().reset();
+        }
+        infos.decalage = newPointSize;
+        newPointSize += apply<PointSizeFunctor, unsigned int>(infos.dataType());
+        attributeMap.push_back(AttributeMapType::value_type(it->first, infos));
+        keptAttributes.push_back(&it->second);
+        policies.push_back(policy);
+        shifts.push_back(shift);
+    }
+    std::vector<cs::AttributeType> addedAttributes;
+    for(AddIterator it = changes.added.begin(); it != changes.added.end(); ++it)
+    {
+        if(attributeMap.find(it->first) != attributeMap.end())
+            continue;
+
+        cs::AttributeType attrib_type(it->second, it->first);
+        addedAttributes.push_back(attrib_type);
+        AttributesInfo infos(attrib_type);
+        infos.decalage = newPointSize;
+        newPointSize += apply<PointSizeFunctor, unsigned int>(it->second);
+        attributeMap.push_back(AttributeMapType::value_type(it->first, infos));
+    }
+
+    // copies of the kept attributes (in a single copy per echo for consecutive attributes not converted in interleaved layout)
+    const std::size_t nbEchos = size();
+    const std::size_t capacity = layout_ == columnar ? columnCapacity_ : nbEchos;
+    std::vector<AttributeReshape> reshapes;
+    for(std::size_t k = 0; k < keptAttributes.size(); ++k)
+    {
+        const AttributeMapType::value_type& newAttribute = *(attributeMap.begin() + k);
+        AttributeReshape reshape;
+        reshape.srcType = keptAttributes[k]->dataType();
+        reshape.destType = newAttribute.second.dataType();
+        reshape.size = apply<PointSizeFunctor, unsigned int>(reshape.destType);
+        reshape.policy = policies[k];
+        reshape.shift = shifts[k];
+        reshape.name = newAttribute.first;
+        if(layout_ == columnar)
+        {
+            reshape.srcOffset = columnCapacity_*keptAttributes[k]->decalage;
+            reshape.srcIncrement = apply<PointSizeFunctor, unsigned int>(reshape.srcType);
+            reshape.destOffset = capacity*newAttribute.second.decalage;
+            reshape.destIncrement = reshape.size;
+        }
+        else
+        {
+            reshape.srcOffset = keptAttributes[k]->decalage;
+            reshape.srcIncrement = pointSize_;
+            reshape.destOffset = newAttribute.second.decalage;
+            reshape.destIncrement = newPointSize;
+
+            AttributeReshape* last = reshapes.empty() ? 0 : &reshapes.back();
+            if(reshape.isCopy() && last && last->isCopy() &&
+               last->srcOffset + last->size == reshape.srcOffset && last->destOffset + last->size == reshape.destOffset)
+            {
+                last->size += reshape.size;
+                continue;
+            }
+        }
+        reshapes.push_back(reshape);
+    }
+
+    bool checked = false;
+    for(std::size_t r = 0; r < reshapes.size(); ++r)
+        checked = checked || reshapes[r].policy == AttributeChanges::check;
+
+    if(layout_ == interleaved && !mappedData_ && !checked && (newPointSize <= pointSize_ || nbEchos == 0))
+    {
+        if(nbEchos && !reshapes.empty())
+            reshapeInPlace(dataPtr(), reshapes, nbEchos, newPointSize);
+        lidarData_.resize(nbEchos*newPointSize);
+        setAttributes(attributeMap, newPointSize, addedAttributes);
+        return;
+    }
+
+    LidarDataContainerType data(capacity*newPointSize);
+    std::vector<std::vector<std::size_t> > outOfRange;
+    if(nbEchos && !reshapes.empty())
+    {
+        outOfRange.resize(nbParallelBlocks(nbEchos, reshapeBlockSize));
+        parallelForBlocks(nbEchos, reshapeBlockSize, boost::bind(&reshapeEchoes, dataPtr(), &data.front(), boost::cref(reshapes), boost::ref(outOfRange), _1, _2, _3));
+    }
+
+    // the container is not modified if a checked conversion fails
+    for(std::size_t r = 0; r < reshapes.size(); ++r)
+    {
+        std::size_t nbOutOfRange = 0;
+        for(std::size_t t = 0; t < outOfRange.size(); ++t)
+            nbOutOfRange += outOfRange[t][r];
+        if(reshapes[r].policy == AttributeChanges::check && nbOutOfRange)
+        {
+            std::ostringstream oss;
+            oss << "LidarDataContainer::changeAttributes: " << nbOutOfRange << " values of attribute " << reshapes[r].name << " are out of the range of its new type\n";
+            throw std::logic_error(oss.str());
+        }
+    }
+
+    // the old buffer (or mapping) is released
+    lidarData_.swap(data);
+    mappedRegion_.reset();
+    mappedData_ = 0;
+    mappedSize_ = 0;
+    setAttributes(attributeMap, newPointSize, addedAttributes);
+}
+
+void LidarDataContainer::setAttributes(const AttributeMapType& attributeMap, const unsigned int pointSize, const std::vector<cs::AttributeType>& addedAttributes)
+{
+    *attributeMap_ = attributeMap;
+    pointSize_ = pointSize;
+
+    // the xml attributes follow the removals and type changes, the added ones are appended as in addAttribute
+    cs::LidarDataType::AttributesType::AttributeSequence& xmlAttributes = m_xmlData->attributes().attribute();
+    cs::LidarDataType::AttributesType::AttributeIterator itXml = xmlAttributes.begin();
+    while(itXml != xmlAttributes.end())
+    {
+        const AttributeMapType::const_iterator it = attributeMap.find(itXml->name());
+        if(it == attributeMap.end())
+            itXml = xmlAttributes.erase(itXml);
+        else
+        {
+            itXml->dataType(it->second.dataType());
+            ++itXml;
+        }
+    }
+    for(std::vector<cs::AttributeType>::const_iterator it = addedAttributes.begin(); it != addedAttributes.end(); ++it)
+        xmlAttributes.push_back(*it);
+}
+
+void LidarDataContainer::changeAttributeType(const std::string& attributeName, const EnumLidarDataType type, const AttributeChanges::Policy policy)
+{
+    changeAttributes(AttributeChanges().changeType(attributeName, type, policy));
 }
 
 
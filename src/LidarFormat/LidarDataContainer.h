@@ -52,23 +52,86 @@ Contributors:
 #include <iterator>
 //#include <map>
 #include <cassert>
+#include <algorithm>
 
 #include <boost/bind.hpp>
 #include <boost/shared_ptr.hpp>
 #include <boost/shared_array.hpp>
 
 #include "LidarFormat/AttributesInfo.h"
+#include "LidarFormat/AttributeHandle.h"
 #include "LidarFormat/LidarIteratorAttribute.h"
 #include "LidarFormat/LidarIteratorEcho.h"
 #include "LidarFormat/LidarIteratorXYZ.h"
 #include "LidarFormat/LidarDataFormatTypes.h"
 #include "LidarFormat/geometry/LidarCenteringTransfo.h"
+#include "LidarFormat/apply.h"
+
+namespace boost
+{
+namespace interprocess
+{
+class mapped_region;
+}
+}
 
 namespace Lidar
 {
 
 using boost::shared_ptr;
 
+struct AttributeStatistics;
+
+namespace detail
+{
+/// apply functor of LidarDataContainer::applyOnAttribute (TContainer is const for the const version)
+template<typename TContainer, typename TKernel>
+struct ApplyOnAttribute
+{
+    template<EnumLidarDataType TAttributeType>
+    struct Functor
+    {
+        void operator()(TContainer& lidarContainer, const std::string& attributeName, TKernel& kernel)
+        {
+            typedef typename LidarEnumTypeTraits<TAttributeType>::type AttributeType;
+            kernel(lidarContainer.template beginAttribute<AttributeType>(attributeName), lidarContainer.template endAttribute<AttributeType>(attributeName));
+        }
+    };
+};
+}
+
+/// batch of changes of the attributes of a container, applied in a single pass over the data (see LidarDataContainer::changeAttributes)
+struct AttributeChanges
+{
+    /// conversion of the values when the type of an attribute changes
+    /// cast: static_cast (the values must be in the range of the new type), clamp: values out of the range are clamped (NaN to 0 for integers),
+    /// check: throws if a value is out of the range (the container is not modified)
+    enum Policy { cast, clamp, check };
+
+    /// shift is subtracted from the values before their conversion (centering of coordinates), the type may then be the same
+    struct TypeChange
+    {
+        TypeChange(const std::string& name_, const EnumLidarDataType type_, const Policy policy_, const double shift_):
+            name(name_), type(type_), policy(policy_), shift(shift_) {}
+        std::string name;
+        EnumLidarDataType type;
+        Policy policy;
+        double shift;
+    };
+
+    AttributeChanges& add(const std::string& name, const EnumLidarDataType type) { added.push_back(std::make_pair(name, type)); return *this; }
+    AttributeChanges& remove(const std::string& name) { removed.push_back(name); return *this; }
+    AttributeChanges& changeType(const std::string& name, const EnumLidarDataType type, const Policy policy = clamp, const double shift = 0.)
+    {
+        typeChanges.push_back(TypeChange(name, type, policy, shift));
+        return *this;
+    }
+
+    std::vector<std::pair<std::string, EnumLidarDataType> > added;
+    std::vector<std::string> removed;
+    std::vector<TypeChange> typeChanges;
+};
+
 
 class LidarDataContainer
 {
@@ -90,19 +153,31 @@ public:
 
     typedef unsigned int IndexType;
 
+    /// memory layout of the echoes
+    /// interleaved: one record of pointSize() bytes per echo (default, same as the binary files)
+    /// columnar: one contiguous column per attribute, for processings that only read a few attributes
+    enum Layout { interleaved, columnar };
+
 
     LidarDataContainer();
+    explicit LidarDataContainer(Layout layout);
     LidarDataContainer(shared_ptr<cs::LidarDataType> xmlData);
     LidarDataContainer(std::string dataFileName, bool meta_only=false);
     LidarDataContainer(const LidarDataContainer&);
     LidarDataContainer& operator=(const LidarDataContainer&);
 
     void setMapsFromXML(shared_ptr<cs::LidarDataType> xmlData);
+    /// only keep the attributes of xmlData which are in attributeNames (in the order of xmlData)
+    void setMapsFromXML(shared_ptr<cs::LidarDataType> xmlData, const std::vector<std::string>& attributeNames);
     void updateXMLStructure(
             const std::string& dataFileName,
             const cs::DataFormatType format,
             const LidarCenteringTransfo& transfo);
 
+    Layout layout() const { return layout_; }
+    /// change the memory layout, the data already in the container is converted
+    void setLayout(Layout layout);
+
     /// BV: very practical to use in client code
     void load(std::string dataFileName, bool meta_only=false);
     void save(std::string dataFileName);
@@ -111,6 +186,7 @@ public:
 
     /// vector like Interface
     bool empty() const;
+    /// one resize per echo: LidarDataBuilder fills many echoes with a single allocation
     void push_back(const LidarEcho& echo);
     void reserve(const std::size_t nbEchos);
     void resize(const std::size_t nbEchos);
@@ -145,6 +221,10 @@ public:
     template<typename T> LidarIteratorAttribute<T> endAttribute(const std::string &attributeName);
     template<typename T> LidarConstIteratorAttribute<T> beginAttribute(const std::string &attributeName) const;
     template<typename T> LidarConstIteratorAttribute<T> endAttribute(const std::string &attributeName) const;
+    template<typename T> LidarIteratorAttribute<T> beginAttribute(const AttributeHandle<T> &handle);
+    template<typename T> LidarIteratorAttribute<T> endAttribute(const AttributeHandle<T> &handle);
+    template<typename T> LidarConstIteratorAttribute<T> beginAttribute(const AttributeHandle<T> &handle) const;
+    template<typename T> LidarConstIteratorAttribute<T> endAttribute(const AttributeHandle<T> &handle) const;
 
     template<typename T> LidarIteratorXYZ<T> beginXYZ();
     template<typename T> LidarIteratorXYZ<T> endXYZ();
@@ -171,12 +251,26 @@ public:
     bool delAttribute(const std::string& attributeName);
     void delAttributeList(const std::vector<std::string>& attributeNames);
 
+    /// apply all the changes in a single pass over the echoes (in parallel over blocks of echoes) into a new buffer, the old one is released
+    /// interleaved records which do not grow are reshaped in place (by blocks through small buffers) unless a conversion is checked
+    /// the kept attributes stay in the same order, the added ones (zero values) are after them, attributes already present are not added
+    /// the removed attributes which are not present are ignored, the type changes convert the values (see AttributeChanges::Policy), throws if the attribute is absent
+    /// WARNING : makes all current iterators obsolete
+    void changeAttributes(const AttributeChanges& changes);
+    /// change the type of a single attribute (see changeAttributes), for instance to narrow the attributes of a file to their useful range
+    void changeAttributeType(const std::string& attributeName, const EnumLidarDataType type, const AttributeChanges::Policy policy = AttributeChanges::clamp);
+
     bool checkAttributeIsPresent(const std::string& attributeName);
 
     bool checkAttributeIsPresentAndType(const std::string& attributeName, const EnumLidarDataType type);
 
     EnumLidarDataType getAttributeType(const std::string &attributeName) const;
 
+    /// dispatch once on the type T of the attribute, the loop over the echoes is in the kernel:
+    /// calls kernel(beginAttribute<T>(attributeName), endAttribute<T>(attributeName)), kernel has a template operator() on T
+    template<typename TKernel> void applyOnAttribute(const std::string &attributeName, TKernel &kernel);
+    template<typename TKernel> void applyOnAttribute(const std::string &attributeName, TKernel &kernel) const;
+
     /// only sets min and max if bounds are present, else returns false
     bool getAttributeBounds(const std::string &attributeName,
                             double & min, double & max) const;
@@ -186,6 +280,10 @@ public:
                                  double & min, double & max,
                                  bool force_recompute=false); // not const because bounds might be recomputed
 
+    /// statistics of all the attributes (histograms of nbBins bins), see computeAttributeStatistics
+    /// their bounds, mean and standard deviation are stored in the meta data of the attributes (saved in the xml)
+    void computeStatistics(std::vector<AttributeStatistics>& statistics, const std::size_t nbBins=100);
+
     /// recomputes attribute bounds if they are dirty or force_recompute is true
     void recomputeBounds(bool force_recompute=false);
 
@@ -211,8 +309,23 @@ public:
 
     /// WARNING: returns a pointer to the data in the container -> dangerous !
     /// (used by classe LidarFile to load binary data in a single operation
-    char* rawData() { return &lidarData_.front(); }
-    const char* rawData() const { return &lidarData_.front(); }
+    /// in columnar layout, this is the start of the first column (use importRecords/exportRecords instead)
+    char* rawData() { return dataPtr(); }
+    const char* rawData() const { return dataPtr(); }
+
+    /// use a memory mapping of nbEchos interleaved records of filename (starting at offset) as data, instead of loading them
+    /// only the pages that are accessed are read, and read only mappings of the same file share the system page cache
+    /// copyOnWrite=false: read only, the data must not be modified (writing through an iterator crashes)
+    /// copyOnWrite=true: modifications are private to the container and never written to the file
+    /// any change of size, attributes or layout first copies the data in memory
+    /// (interleaved layout only)
+    void mapRawData(const std::string& filename, const std::size_t offset, const std::size_t nbEchos, const bool copyOnWrite=false);
+    bool isMapped() const { return mappedData_ != 0; }
+
+    /// copy count echoes starting at first to dest, as interleaved records, whatever the layout
+    void exportRecords(char* dest, const std::size_t first, const std::size_t count) const;
+    /// set count echoes starting at first from interleaved records, whatever the layout
+    void importRecords(const char* src, const std::size_t first, const std::size_t count);
 
     const AttributeMapType& getAttributeMap() const { return *attributeMap_; }
 
@@ -220,37 +333,79 @@ public:
 
     /// WARNING
     void push_back(const char* echo);
-    /// WARNING
-    const char* rawData(const unsigned int index) const { return rawData() + index*pointSize();}
-    char* rawData(const unsigned int index) { return rawData() + index*pointSize();}
+    /// WARNING (interleaved layout only)
+    const char* rawData(const unsigned int index) const { assert(layout_ == interleaved); return rawData() + index*pointSize();}
+    char* rawData(const unsigned int index) { assert(layout_ == interleaved); return rawData() + index*pointSize();}
 
     unsigned int getDecalage(const std::string &attributeName) const
     {
         return attributeMap_->find(attributeName)->second.decalage;
     }
 
+    /// resolve the attribute once for typed accesses without name lookup (throws if absent or not of type T)
+    /// the handle becomes stale when attributes are added or deleted
+    template<typename T> AttributeHandle<T> getAttributeHandle(const std::string &attributeName) const
+    {
+        return AttributeHandle<T>(*attributeMap_, attributeName);
+    }
+    template<typename T> bool isValid(const AttributeHandle<T> &handle) const { return handle.isValid(*attributeMap_); }
+
     /// BV: added option copy_data to optionnaly copy only attribute map without data (more memory efficient for some usages)
     void copy(const LidarDataContainer& rhs, bool copy_data=true);
 
 private:
+    friend class LidarDataBuilder;
 
     ///Update container content after having added attributes
     void updateAttributeContent(const unsigned int oldPointSize);
     bool addAttributeHelper(cs::LidarDataType::AttributesType::AttributeIterator it);
 
+    ///columnar layout: move the columns to a new column size (capacity)
+    void setColumnCapacity(const std::size_t capacity);
+    ///columnar layout: set the echoes [first, last[ of each column to 0 (as the echoes added to an interleaved container)
+    void zeroColumns(const std::size_t first, const std::size_t last);
+
+    ///changeAttributes: set the new attributes once the data is reshaped (the xml attributes are updated)
+    void setAttributes(const AttributeMapType& attributeMap, const unsigned int pointSize, const std::vector<cs::AttributeType>& addedAttributes);
+
+    ///copy the mapped data in memory and release the mapping
+    void unmapRawData();
+
 
     /////Structure interne
     typedef char BaseType;
     typedef std::vector<BaseType> LidarDataContainerType;
 
-    LidarIteratorEcho createLidarIteratorEcho(char* data) const
+    char* dataPtr() const
     {
-        return LidarIteratorEcho(data, pointSize(), attributeMap_);
+        if(mappedData_)
+            return mappedData_;
+        return lidarData_.empty() ? 0 : &lidarData_.front();
     }
+    std::size_t dataSize() const { return mappedData_ ? mappedSize_ : lidarData_.size(); }
 
-    LidarConstIteratorEcho createLidarConstIteratorEcho(char* data) const
+    /// start of the values of the attribute with shift decalage, and distance between two echoes
+    char* attributeData(const unsigned int decalage) const
     {
-        return LidarConstIteratorEcho(data, pointSize(), attributeMap_);
+        return dataPtr() + (layout_ == columnar ? columnCapacity_ : 1)*decalage;
+    }
+    template<typename T> std::size_t attributeIncrement() const
+    {
+        return layout_ == columnar ? sizeof(T) : pointSize();
+    }
+
+    LidarIteratorEcho createLidarIteratorEcho(const std::size_t index) const
+    {
+        if(layout_ == columnar)
+            return LidarIteratorEcho(dataPtr() + index, attributeMap_.get(), dataPtr(), columnCapacity_, pointSize());
+        return LidarIteratorEcho(dataPtr() + index*pointSize(), pointSize(), attributeMap_.get());
+    }
+
+    LidarConstIteratorEcho createLidarConstIteratorEcho(const std::size_t index) const
+    {
+        if(layout_ == columnar)
+            return LidarConstIteratorEcho(dataPtr() + index, attributeMap_.get(), dataPtr(), columnCapacity_, pointSize());
+        return LidarConstIteratorEcho(dataPtr() + index*pointSize(), pointSize(), attributeMap_.get());
     }
 
 
@@ -264,6 +419,17 @@ private:
 
     unsigned int pointSize_;
 
+    Layout layout_;
+    //columnar layout only: number of echoes and size of the columns
+    std::size_t nbEchos_;
+    std::size_t columnCapacity_;
+
+    //data mapped from a file (used instead of lidarData_ if mappedData_ is not null)
+    shared_ptr<boost::interprocess::mapped_region> mappedRegion_;
+    char* mappedData_;
+    std::size_t mappedSize_;
+    bool copyOnWrite_;
+
 public:
     shared_ptr<cs::LidarDataType> m_xmlData; // data from the xml, can be modified by accessors
 
@@ -276,32 +442,74 @@ public:
 
 inline LidarEcho LidarDataContainer::createEcho() const
 {
-    return LidarEcho(pointSize(), boost::shared_array<BaseType>(new BaseType[pointSize()]).get(), attributeMap_);
+    return LidarEcho(pointSize(), attributeMap_);
 }
 
 
 template<typename T>
 inline LidarIteratorAttribute<T> LidarDataContainer::beginAttribute(const std::string &attributeName)
 {
-    return LidarIteratorAttribute<T>(rawData() + getDecalage(attributeName), pointSize());
+    return LidarIteratorAttribute<T>(attributeData(getDecalage(attributeName)), attributeIncrement<T>());
 }
 
 template<typename T>
 inline LidarIteratorAttribute<T> LidarDataContainer::endAttribute(const std::string &attributeName)
 {
-    return LidarIteratorAttribute<T>(rawData(size()) + getDecalage(attributeName), pointSize());
+    return LidarIteratorAttribute<T>(attributeData(getDecalage(attributeName)) + size()*attributeIncrement<T>(), attributeIncrement<T>());
 }
 
 template<typename T>
 inline LidarConstIteratorAttribute<T> LidarDataContainer::beginAttribute(const std::string &attributeName) const
 {
-    return LidarConstIteratorAttribute<T>(&lidarData_.front() + getDecalage(attributeName), pointSize());
+    return LidarConstIteratorAttribute<T>(attributeData(getDecalage(attributeName)), attributeIncrement<T>());
 }
 
 template<typename T>
 inline LidarConstIteratorAttribute<T> LidarDataContainer::endAttribute(const std::string &attributeName) const
 {
-    return LidarConstIteratorAttribute<T>(&lidarData_.front() + pointSize()*size() + getDecalage(attributeName), pointSize());
+    return LidarConstIteratorAttribute<T>(attributeData(getDecalage(attributeName)) + size()*attributeIncrement<T>(), attributeIncrement<T>());
+}
+
+template<typename TKernel>
+inline void LidarDataContainer::applyOnAttribute(const std::string &attributeName, TKernel &kernel)
+{
+    apply<detail::ApplyOnAttribute<LidarDataContainer, TKernel>::template Functor, void, LidarDataContainer&, const std::string&, TKernel&>(
+                getAttributeType(attributeName), *this, attributeName, kernel);
+}
+
+template<typename TKernel>
+inline void LidarDataContainer::applyOnAttribute(const std::string &attributeName, TKernel &kernel) const
+{
+    apply<detail::ApplyOnAttribute<const LidarDataContainer, TKernel>::template Functor, void, const LidarDataContainer&, const std::string&, TKernel&>(
+                getAttributeType(attributeName), *this, attributeName, kernel);
+}
+
+template<typename T>
+inline LidarIteratorAttribute<T> LidarDataContainer::beginAttribute(const AttributeHandle<T> &handle)
+{
+    assert(isValid(handle));
+    return LidarIteratorAttribute<T>(attributeData(handle.decalage()), attributeIncrement<T>());
+}
+
+template<typename T>
+inline LidarIteratorAttribute<T> LidarDataContainer::endAttribute(const AttributeHandle<T> &handle)
+{
+    assert(isValid(handle));
+    return LidarIteratorAttribute<T>(attributeData(handle.decalage()) + size()*attributeIncrement<T>(), attributeIncrement<T>());
+}
+
+template<typename T>
+inline LidarConstIteratorAttribute<T> LidarDataContainer::beginAttribute(const AttributeHandle<T> &handle) const
+{
+    assert(isValid(handle));
+    return LidarConstIteratorAttribute<T>(attributeData(handle.decalage()), attributeIncrement<T>());
+}
+
+template<typename T>
+inline LidarConstIteratorAttribute<T> LidarDataContainer::endAttribute(const AttributeHandle<T> &handle) const
+{
+    assert(isValid(handle));
+    return LidarConstIteratorAttribute<T>(attributeData(handle.decalage()) + size()*attributeIncrement<T>(), attributeIncrement<T>());
 }
 
 
@@ -309,25 +517,29 @@ inline LidarConstIteratorAttribute<T> LidarDataContainer::endAttribute(const std
 template<typename T>
 inline LidarIteratorXYZ<T> LidarDataContainer::beginXYZ()
 {
+    if(layout_ == columnar)
+        return LidarIteratorXYZ<T>(attributeData(getDecalage("x")), sizeof(T), columnCapacity_*sizeof(T));
     return LidarIteratorXYZ<T>(rawData() + getDecalage("x"), pointSize());
 }
 
 template<typename T>
 inline LidarIteratorXYZ<T> LidarDataContainer::endXYZ()
 {
-    return LidarIteratorXYZ<T>(rawData(size()) + getDecalage("x"), pointSize());
+    return beginXYZ<T>() + size();
 }
 
 template<typename T>
 inline LidarConstIteratorXYZ<T> LidarDataContainer::beginXYZ() const
 {
-    return LidarConstIteratorXYZ<T>(&lidarData_.front() + getDecalage("x"), pointSize());
+    if(layout_ == columnar)
+        return LidarConstIteratorXYZ<T>(attributeData(getDecalage("x")), sizeof(T), columnCapacity_*sizeof(T));
+    return LidarConstIteratorXYZ<T>(dataPtr() + getDecalage("x"), pointSize());
 }
 
 template<typename T>
 inline LidarConstIteratorXYZ<T> LidarDataContainer::endXYZ() const
 {
-    return LidarConstIteratorXYZ<T>(&lidarData_.front() + pointSize()*size() + getDecalage("x"), pointSize());
+    return beginXYZ<T>() + size();
 }
 
 
@@ -336,22 +548,22 @@ inline LidarConstIteratorXYZ<T> LidarDataContainer::endXYZ() const
 
 inline LidarIteratorEcho LidarDataContainer::begin()
 {
-    return createLidarIteratorEcho(rawData());
+    return createLidarIteratorEcho(0);
 }
 
 inline LidarIteratorEcho LidarDataContainer::end()
 {
-    return createLidarIteratorEcho(rawData(size()));
+    return createLidarIteratorEcho(size());
 }
 
 inline LidarConstIteratorEcho LidarDataContainer::begin() const
 {
-    return createLidarConstIteratorEcho(&lidarData_.front());
+    return createLidarConstIteratorEcho(0);
 }
 
 inline LidarConstIteratorEcho LidarDataContainer::end() const
 {
-    return createLidarConstIteratorEcho(&lidarData_.front() + pointSize()*size());
+    return createLidarConstIteratorEcho(size());
 }
 
 inline LidarDataContainer::reverse_iterator LidarDataContainer::rbegin()
@@ -376,17 +588,23 @@ inline LidarDataContainer::const_reverse_iterator LidarDataContainer::rend() con
 
 inline std::size_t LidarDataContainer::size() const
 {
-    return lidarData_.size()/pointSize();
+    if(layout_ == columnar)
+        return nbEchos_;
+    return pointSize() ? dataSize()/pointSize() : 0;
 }
 
 inline std::size_t LidarDataContainer::max_size() const
 {
-    return lidarData_.max_size()/pointSize();
+    return pointSize() ? lidarData_.max_size()/pointSize() : lidarData_.max_size();
 }
 
 inline std::size_t LidarDataContainer::capacity() const
 {
-    return lidarData_.capacity()/pointSize();
+    if(layout_ == columnar)
+        return columnCapacity_;
+    if(mappedData_)
+        return size();
+    return pointSize() ? lidarData_.capacity()/pointSize() : 0;
 }
 
 inline bool LidarDataContainer::empty() const
@@ -396,6 +614,17 @@ inline bool LidarDataContainer::empty() const
 
 inline void LidarDataContainer::resize(const std::size_t nbEchos)
 {
+    if(layout_ == columnar)
+    {
+        if(nbEchos > columnCapacity_)
+            setColumnCapacity(std::max(nbEchos, 2*columnCapacity_));
+        else if(nbEchos > nbEchos_)
+            zeroColumns(nbEchos_, nbEchos);
+        nbEchos_ = nbEchos;
+        return;
+    }
+    if(mappedData_)
+        unmapRawData();
     lidarData_.resize(nbEchos*pointSize());
 }
 
@@ -428,24 +657,25 @@ inline void LidarDataContainer::push_back(const char* echo)
     resize(size()+1);
 
     //recopie de l'écho
-    memcpy(rawData() + (size()-1)*pointSize(), echo, pointSize());
+    importRecords(echo, size()-1, 1);
 }
 
 inline void LidarDataContainer::reserve(const std::size_t nbEchos)
 {
+    if(layout_ == columnar)
+    {
+        if(nbEchos > columnCapacity_)
+            setColumnCapacity(nbEchos);
+        return;
+    }
+    if(mappedData_)
+        unmapRawData();
     lidarData_.reserve(nbEchos*pointSize());
 }
 
 inline unsigned int LidarDataContainer::erase(const unsigned int position)
 {
-    LidarDataContainerType::iterator erase_pos = lidarData_.erase(lidarData_.begin() + position*pointSize(), lidarData_.begin() + (position+1)*pointSize());
-    return  erase_pos - lidarData_.begin();
-}
-
-inline unsigned int LidarDataContainer::erase(const unsigned int first, const unsigned int last)
-{
-    LidarDataContainerType::iterator erase_pos = lidarData_.erase(lidarData_.begin() + first*pointSize(), lidarData_.begin() + last*pointSize());
-    return erase_pos - lidarData_.begin();
+    return erase(position, position+1);
 }
 
 inline LidarIteratorEcho LidarDataContainer::erase(const LidarIteratorEcho& position)
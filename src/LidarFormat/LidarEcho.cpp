@@ -43,6 +43,7 @@ Contributors:
 #include <iostream>
 
 #include "LidarEcho.h"
+#include "LidarEchoRef.h"
 
 #include "apply.h"
 
@@ -55,7 +56,7 @@ char LidarEcho::m_separator = '\t';
 template<Lidar::EnumLidarDataType T>
 struct PrintFunctor
 {
-	void operator()(std::ostream &os, const LidarEcho &echo, const std::string &name)
+	void operator()(std::ostream &os, const LidarConstEchoRef &echo, const std::string &name)
 	{
 		os << echo.value<typename Lidar::LidarEnumTypeTraits<T>::type>(name) << LidarEcho::m_separator ;
 	}
@@ -64,7 +65,7 @@ struct PrintFunctor
 template<>
 struct PrintFunctor<LidarDataType::int8>
 {
-	void operator()(std::ostream &os, const LidarEcho &echo, const std::string &name)
+	void operator()(std::ostream &os, const LidarConstEchoRef &echo, const std::string &name)
 	{
 		os << (int) echo.value<int8>(name) << LidarEcho::m_separator ;
 	}
@@ -73,25 +74,30 @@ struct PrintFunctor<LidarDataType::int8>
 template<>
 struct PrintFunctor<LidarDataType::uint8>
 {
-	void operator()(std::ostream &os, const LidarEcho &echo, const std::string &name)
+	void operator()(std::ostream &os, const LidarConstEchoRef &echo, const std::string &name)
 	{
 		os << (unsigned int) echo.value<uint8>(name) << LidarEcho::m_separator ;
 	}
 };
 
-std::ostream& operator<<( std::ostream& os, const LidarEcho& echo )
+std::ostream& operator<<( std::ostream& os, const LidarConstEchoRef& echo )
 {
 
-	for(AttributeMapType::const_iterator it = echo.attributeMap_->begin(); it != echo.attributeMap_->end(); ++it)
+	for(AttributeMapType::const_iterator it = echo.m_attributeMap->begin(); it != echo.m_attributeMap->end(); ++it)
 	{
         EnumLidarDataType type = it->second.dataType();
-		apply<PrintFunctor, void, std::ostream &, const LidarEcho &, const std::string &>(type, os, echo, it->first);
+		apply<PrintFunctor, void, std::ostream &, const LidarConstEchoRef &, const std::string &>(type, os, echo, it->first);
 
 	}
 
 	return os;
 }
 
+std::ostream& operator<<( std::ostream& os, const LidarEcho& echo )
+{
+	return os << LidarConstEchoRef(echo);
+}
+
 
 template<EnumLidarDataType T>
 struct PointSizeFunctor
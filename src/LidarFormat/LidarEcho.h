@@ -52,6 +52,7 @@ Contributors:
 #include <boost/shared_array.hpp>
 
 #include "LidarFormat/AttributesInfo.h"
+#include "LidarFormat/AttributeHandle.h"
 #include "LidarFormat/LidarDataFormatTypes.h"
 
 namespace Lidar
@@ -66,10 +67,18 @@ namespace Lidar
 
 using boost::shared_ptr;
 
+class LidarConstEchoRef;
+
 
 class LidarEcho
 {
 	public:
+		///echo aux donnees non initialisees
+		explicit LidarEcho(const unsigned int size, const shared_ptr<AttributeMapType> &attributeMap):
+			echoPtr_(new char[size]), size_(size), attributeMap_(attributeMap)
+		{
+		}
+
 		explicit LidarEcho(const unsigned int size, const char *data, const shared_ptr<AttributeMapType> &attributeMap):
 			echoPtr_(new char[size]), size_(size), attributeMap_(attributeMap)
 		{
@@ -81,7 +90,8 @@ class LidarEcho
 			copy(rhs);
 		}
 
-//		LidarEcho(const LidarEchoRef& echo);
+		///copy of an echo of a container (defined in LidarEchoRef.h)
+		LidarEcho(const LidarConstEchoRef &echo);
 
 		LidarEcho &operator=(const LidarEcho &rhs)
 		{
@@ -89,6 +99,9 @@ class LidarEcho
 			return *this;
 		}
 
+		///keeps the data buffer if the echo has the same size
+		LidarEcho &operator=(const LidarConstEchoRef &echo);
+
 		inline friend bool operator== (const LidarEcho &lhs, const LidarEcho &rhs)
 		{
 			assert(lhs.size_ == rhs.size_);
@@ -123,6 +136,21 @@ class LidarEcho
 			return *reinterpret_cast<TAttributeType*>(ptr);
 		}
 
+		///typed access without name lookup (see LidarDataContainer::getAttributeHandle)
+		template<typename TAttributeType>
+		const TAttributeType value(const AttributeHandle<TAttributeType> &handle) const
+		{
+			assert(handle.isValid(*attributeMap_));
+			return value<TAttributeType>(handle.decalage());
+		}
+
+		template<typename TAttributeType>
+		TAttributeType& value(const AttributeHandle<TAttributeType> &handle)
+		{
+			assert(handle.isValid(*attributeMap_));
+			return value<TAttributeType>(handle.decalage());
+		}
+
 
 
 		Lidar::EnumLidarDataType getAttributeType(const std::string &attributeName) const
@@ -154,6 +182,8 @@ class LidarEcho
 		static char m_separator;
 
 	protected:
+		friend class LidarConstEchoRef;
+
 		boost::shared_array<char> echoPtr_; //donnees d'un echo
 		unsigned int size_; //taille d'un echo
 
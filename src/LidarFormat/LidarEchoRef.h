@@ -0,0 +1,301 @@
+/***********************************************************************
+
+This file is part of the LidarFormat project source files.
+
+LidarFormat is an open source library for efficiently handling 3D point 
+clouds with a variable number of attributes at runtime. 
+
+
+Homepage: 
+
+    http://code.google.com/p/lidarformat
+
+Copyright:
+
+    Institut Geographique National & CEMAGREF (2009)
+
+Author: 
+
+    Adrien Chauve
+
+Contributors:
+
+    Nicolas David, Olivier Tournaire, Bruno Vallet
+
+
+
+    LidarFormat is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LidarFormat is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with LidarFormat.  If not, see <http://www.gnu.org/licenses/>.
+
+***********************************************************************/
+
+
+
+#ifndef LIDARECHOREF_H_
+#define LIDARECHOREF_H_
+
+#include <cassert>
+#include <cstring>
+#include <string>
+#include <iosfwd>
+
+#include <boost/shared_ptr.hpp>
+
+#include "LidarFormat/AttributesInfo.h"
+#include "LidarFormat/AttributeHandle.h"
+#include "LidarFormat/LidarEcho.h"
+
+namespace Lidar
+{
+
+/**
+* @brief Reference on an echo stored in a container, without copy of its data (see LidarEcho for an owning copy)
+*
+* Returned by the dereference of the echo iterators. Same value<T> API as LidarEcho.
+* A reference is invalidated as the iterators of its container (resize, reserve, change of attributes, ...).
+* It points to the attribute infos of its container without owning them, a LidarEcho copied from it copies them.
+*
+*/
+class LidarConstEchoRef
+{
+	public:
+		///reference on an interleaved record of pointSize bytes
+		LidarConstEchoRef(const char *dataPtr, const std::size_t pointSize, const AttributeMapType *attributeMap):
+			m_dataPtr(dataPtr), m_pointSize(pointSize), m_attributeMap(attributeMap), m_basePtr(0), m_columnSize(0)
+		{
+		}
+
+		///reference on an echo of a columnar storage: dataPtr-basePtr is the index of the echo, the column of an attribute starts at basePtr + columnSize*decalage
+		LidarConstEchoRef(const char *dataPtr, const std::size_t pointSize, const AttributeMapType *attributeMap, const char *basePtr, const std::size_t columnSize):
+			m_dataPtr(dataPtr), m_pointSize(pointSize), m_attributeMap(attributeMap), m_basePtr(basePtr), m_columnSize(columnSize)
+		{
+		}
+
+		///reference on the data of an owning echo
+		LidarConstEchoRef(const LidarEcho &echo):
+			m_dataPtr(echo.getRawData()), m_pointSize(echo.size()), m_attributeMap(echo.attributeMap_.get()), m_basePtr(0), m_columnSize(0)
+		{
+		}
+
+		template<typename TAttributeType>
+		const TAttributeType& value(const std::string &attributeName) const
+		{
+			return *attributePtr<TAttributeType>(getDecalage(attributeName));
+		}
+
+		template<typename TAttributeType>
+		const TAttributeType& value(const unsigned int decalage) const
+		{
+			return *attributePtr<TAttributeType>(decalage);
+		}
+
+		template<typename TAttributeType>
+		const TAttributeType& value(const AttributeHandle<TAttributeType> &handle) const
+		{
+			assert(handle.isValid(*m_attributeMap));
+			return *attributePtr<TAttributeType>(handle.decalage());
+		}
+
+		Lidar::EnumLidarDataType getAttributeType(const std::string &attributeName) const
+		{
+			return m_attributeMap->find(attributeName)->second.dataType();
+		}
+
+		unsigned int getDecalage(const std::string &attributeName) const
+		{
+			return m_attributeMap->find(attributeName)->second.decalage;
+		}
+
+		unsigned int size() const
+		{
+			return m_pointSize;
+		}
+
+		///copy the echo to an interleaved record of size() bytes
+		void copyTo(char *record) const
+		{
+			if(!m_columnSize)
+			{
+				memcpy(record, m_dataPtr, m_pointSize);
+				return;
+			}
+			for(AttributeMapType::const_iterator it = m_attributeMap->begin(); it != m_attributeMap->end(); ++it)
+			{
+				const std::size_t size = attributeSize(it);
+				memcpy(record + it->second.decalage, attributeData(it->second.decalage, size), size);
+			}
+		}
+
+		inline friend bool operator==(const LidarConstEchoRef &lhs, const LidarConstEchoRef &rhs)
+		{
+			assert(lhs.m_pointSize == rhs.m_pointSize);
+			if(!lhs.m_columnSize && !rhs.m_columnSize)
+				return memcmp(lhs.m_dataPtr, rhs.m_dataPtr, lhs.m_pointSize) == 0;
+			for(AttributeMapType::const_iterator it = lhs.m_attributeMap->begin(); it != lhs.m_attributeMap->end(); ++it)
+			{
+				const std::size_t size = lhs.attributeSize(it);
+				if(memcmp(lhs.attributeData(it->second.decalage, size), rhs.attributeData(it->second.decalage, size), size) != 0)
+					return false;
+			}
+			return true;
+		}
+
+		inline friend bool operator==(const LidarConstEchoRef &lhs, const LidarEcho &rhs)
+		{
+			return lhs == LidarConstEchoRef(rhs);
+		}
+
+		inline friend bool operator==(const LidarEcho &lhs, const LidarConstEchoRef &rhs)
+		{
+			return LidarConstEchoRef(lhs) == rhs;
+		}
+
+		friend std::ostream& operator<<(std::ostream& os, const LidarConstEchoRef& echo);
+
+	protected:
+		template<typename TAttributeType>
+		const TAttributeType* attributePtr(const unsigned int decalage) const
+		{
+			return reinterpret_cast<const TAttributeType*>(attributeData(decalage, sizeof(TAttributeType)));
+		}
+
+		///data of the attribute at decalage, of size bytes
+		const char* attributeData(const unsigned int decalage, const std::size_t size) const
+		{
+			if(!m_columnSize)
+				return m_dataPtr + decalage;
+			return m_basePtr + m_columnSize*decalage + (m_dataPtr - m_basePtr)*size;
+		}
+
+		std::size_t attributeSize(const AttributeMapType::const_iterator &it) const
+		{
+			const AttributeMapType::const_iterator next = it + 1;
+			return (next == m_attributeMap->end() ? m_pointSize : next->second.decalage) - it->second.decalage;
+		}
+
+		const char *m_dataPtr;
+		std::size_t m_pointSize;
+		const AttributeMapType* m_attributeMap; //infos sur les attributs
+
+		//stockage colonne : debut des colonnes et taille d'une colonne (0 pour un stockage par echo)
+		const char *m_basePtr;
+		std::size_t m_columnSize;
+
+	private:
+		friend class LidarEcho;
+		friend class LidarEchoRef;
+
+		///a reference can not be rebound
+		LidarConstEchoRef& operator=(const LidarConstEchoRef&);
+};
+
+/**
+* @brief Mutable reference on an echo stored in a container (see LidarConstEchoRef)
+*
+* Assigning an echo (reference or LidarEcho) to it copies the data of the echo in the container.
+*
+*/
+class LidarEchoRef : public LidarConstEchoRef
+{
+	public:
+		LidarEchoRef(char *dataPtr, const std::size_t pointSize, const AttributeMapType *attributeMap):
+			LidarConstEchoRef(dataPtr, pointSize, attributeMap)
+		{
+		}
+
+		LidarEchoRef(char *dataPtr, const std::size_t pointSize, const AttributeMapType *attributeMap, char *basePtr, const std::size_t columnSize):
+			LidarConstEchoRef(dataPtr, pointSize, attributeMap, basePtr, columnSize)
+		{
+		}
+
+		LidarEchoRef& operator=(const LidarEchoRef &rhs)
+		{
+			assign(rhs);
+			return *this;
+		}
+
+		LidarEchoRef& operator=(const LidarConstEchoRef &rhs)
+		{
+			assign(rhs);
+			return *this;
+		}
+
+		LidarEchoRef& operator=(const LidarEcho &rhs)
+		{
+			assign(LidarConstEchoRef(rhs));
+			return *this;
+		}
+
+		template<typename TAttributeType>
+		TAttributeType& value(const std::string &attributeName) const
+		{
+			return const_cast<TAttributeType&>(LidarConstEchoRef::value<TAttributeType>(attributeName));
+		}
+
+		template<typename TAttributeType>
+		TAttributeType& value(const unsigned int decalage) const
+		{
+			return const_cast<TAttributeType&>(LidarConstEchoRef::value<TAttributeType>(decalage));
+		}
+
+		template<typename TAttributeType>
+		TAttributeType& value(const AttributeHandle<TAttributeType> &handle) const
+		{
+			return const_cast<TAttributeType&>(LidarConstEchoRef::value(handle));
+		}
+
+	private:
+		///the echoes have the same attributes
+		void assign(const LidarConstEchoRef &rhs)
+		{
+			assert(m_pointSize == rhs.m_pointSize);
+			if(!m_columnSize && !rhs.m_columnSize)
+			{
+				memmove(const_cast<char*>(m_dataPtr), rhs.m_dataPtr, m_pointSize);
+				return;
+			}
+			for(AttributeMapType::const_iterator it = m_attributeMap->begin(); it != m_attributeMap->end(); ++it)
+			{
+				const std::size_t size = attributeSize(it);
+				memmove(const_cast<char*>(attributeData(it->second.decalage, size)), rhs.attributeData(it->second.decalage, size), size);
+			}
+		}
+};
+
+///swap the data of two echoes of the same attributes (used by the STL algorithms on echo iterators)
+void swap(LidarEchoRef lhs, LidarEchoRef rhs);
+
+
+inline LidarEcho::LidarEcho(const LidarConstEchoRef &echo):
+	echoPtr_(new char[echo.size()]), size_(echo.size()), attributeMap_(new AttributeMapType(*echo.m_attributeMap))
+{
+	echo.copyTo(echoPtr_.get());
+}
+
+inline LidarEcho& LidarEcho::operator=(const LidarConstEchoRef &echo)
+{
+	if(!echoPtr_ || size_ != echo.size())
+	{
+		size_ = echo.size();
+		echoPtr_ = boost::shared_array<char>(new char[size_]);
+	}
+	echo.copyTo(echoPtr_.get());
+	// the attribute infos are copied only if they changed (same revision: same attributes)
+	if(!attributeMap_ || attributeMap_->revision() != echo.m_attributeMap->revision())
+		attributeMap_.reset(new AttributeMapType(*echo.m_attributeMap));
+	return *this;
+}
+
+} //namespace Lidar
+
+#endif /* LIDARECHOREF_H_ */
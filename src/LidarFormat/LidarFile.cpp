@@ -54,9 +54,7 @@ Contributors:
 
 #include "LidarFormat/LidarFile.h"
 #include "file_formats/PlyArchi/Ply2Lf.h"
-#ifdef ENABLE_LAS
 #include "file_formats/LAS/Las2Lf.h"
-#endif // ENABLE_LAS
 
 using namespace boost::filesystem;
 
@@ -149,6 +147,55 @@ void LidarFile::loadData(LidarDataContainer& lidarContainer)
     reader->loadData(lidarContainer, m_xmlFileName);
 }
 
+void LidarFile::loadData(LidarDataContainer& lidarContainer, const std::vector<std::string>& attributeNames)
+{
+    if(!isValid())
+        throw std::logic_error("LidarFile::loadData: " + m_xmlFileName + " is not valid !\n");
+
+    LidarDataContainer fileMetaData(m_xmlData);
+    lidarContainer.setMapsFromXML(m_xmlData, attributeNames);
+    lidarContainer.resize(m_xmlData->attributes().dataSize());
+    boost::shared_ptr<LidarFileIO> reader = LidarIOFactory::instance().createObject(m_xmlData->attributes().dataFormat());
+    reader->loadAttributes(lidarContainer, fileMetaData, m_xmlFileName);
+}
+
+void LidarFile::loadRange(LidarDataContainer& lidarContainer, const std::size_t first, const std::size_t count)
+{
+    if(!isValid())
+        throw std::logic_error("LidarFile::loadRange: " + m_xmlFileName + " is not valid !\n");
+
+    lidarContainer.setMapsFromXML(m_xmlData);
+    boost::shared_ptr<LidarFileIO> reader = LidarIOFactory::instance().createObject(m_xmlData->attributes().dataFormat());
+    reader->loadRange(lidarContainer, m_xmlFileName, first, count);
+}
+
+void LidarFile::loadRange(LidarDataContainer& lidarContainer, const std::vector<std::string>& attributeNames, const std::size_t first, const std::size_t count)
+{
+    if(!isValid())
+        throw std::logic_error("LidarFile::loadRange: " + m_xmlFileName + " is not valid !\n");
+
+    LidarDataContainer fileMetaData(m_xmlData);
+    lidarContainer.setMapsFromXML(m_xmlData, attributeNames);
+    const std::size_t dataSize = m_xmlData->attributes().dataSize();
+    lidarContainer.resize(first < dataSize ? std::min(count, dataSize - first) : 0);
+    boost::shared_ptr<LidarFileIO> reader = LidarIOFactory::instance().createObject(m_xmlData->attributes().dataFormat());
+    reader->loadAttributes(lidarContainer, fileMetaData, m_xmlFileName, first, count);
+}
+
+void LidarFile::mapData(LidarDataContainer& lidarContainer, bool copyOnWrite)
+{
+    if(!isValid())
+        throw std::logic_error("LidarFile::mapData: " + m_xmlFileName + " is not valid !\n");
+
+    lidarContainer.setMapsFromXML(m_xmlData);
+    boost::shared_ptr<LidarFileIO> reader = LidarIOFactory::instance().createObject(m_xmlData->attributes().dataFormat());
+    if(reader->mapData(lidarContainer, m_xmlFileName, copyOnWrite))
+        return;
+
+    lidarContainer.resize(m_xmlData->attributes().dataSize());
+    reader->loadData(lidarContainer, m_xmlFileName);
+}
+
 void LidarFile::loadTransfo(LidarCenteringTransfo& transfo) const
 {
     transfo.setTransfo(0,0);
@@ -44,6 +44,7 @@ Contributors:
 #define LIDARFILE_H_
 
 #include <string>
+#include <vector>
 #include <boost/shared_ptr.hpp>
 
 #include "LidarFormat/LidarDataFormatTypes.h"
@@ -96,6 +97,18 @@ public:
     /// load data from file to a lidar container
     void loadData(LidarDataContainer& lidarContainer);
 
+    /// load only some attributes of the file (projection)
+    void loadData(LidarDataContainer& lidarContainer, const std::vector<std::string>& attributeNames);
+
+    /// map the data file in memory instead of loading it when the format allows it (binary), else load it
+    /// copyOnWrite=false: read only data, copyOnWrite=true: modifications are kept private to the container
+    void mapData(LidarDataContainer& lidarContainer, bool copyOnWrite=false);
+
+    /// load only the echoes [first, first+count[ of the file (less at the end of the file)
+    /// a single positioned read for binary formats, the other formats read (and drop) the echoes before first
+    void loadRange(LidarDataContainer& lidarContainer, const std::size_t first, const std::size_t count);
+    void loadRange(LidarDataContainer& lidarContainer, const std::vector<std::string>& attributeNames, const std::size_t first, const std::size_t count);
+
     /// Save container data in a file
     static void save(LidarDataContainer& lidarContainer,
                      const std::string& xmlFileName,
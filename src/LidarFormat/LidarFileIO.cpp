@@ -40,13 +40,23 @@ Contributors:
 ***********************************************************************/
 
 
+#include <fstream>
+
 #include "LidarFileIO.h"
 #include "LidarDataContainer.h"
+#include "apply.h"
+#include "tools/AsciiNumbers.h"
+#include "tools/ParallelBlocks.h"
 #include "boost/filesystem.hpp"
+#include <boost/bind.hpp>
+#include <boost/ref.hpp>
 
 namespace Lidar
 {
 
+/// number of echoes read or converted at once
+static const std::size_t recordsBufferSize = 1 << 16;
+
 MetaDataIO::MetaDataIO()
 {
 }
@@ -87,12 +97,257 @@ void LidarFileIO::getPaths(const LidarDataContainer& lidarContainer, std::string
 
 }
 
+bool LidarFileIO::mapData(LidarDataContainer& lidarContainer, std::string filename, bool copyOnWrite)
+{
+    return false;
+}
+
+void LidarFileIO::openStream(const LidarDataContainer& lidarContainer, std::string filename)
+{
+    m_streamData.reset(new LidarDataContainer(lidarContainer.getXmlStructure()));
+    m_streamData->resize(lidarContainer.getXmlStructure()->attributes().dataSize());
+    loadData(*m_streamData, filename);
+    m_streamSize = m_streamData->size();
+    m_streamPosition = 0;
+}
+
+std::size_t LidarFileIO::readChunk(LidarDataContainer& lidarContainer, const std::size_t nbEchos)
+{
+    if(!m_streamData)
+        return 0;
+    const std::size_t n = std::min(nbEchos, m_streamSize - m_streamPosition);
+    lidarContainer.resize(n);
+    const LidarDataContainer::iterator itb = m_streamData->begin() + m_streamPosition;
+    std::copy(itb, itb + n, lidarContainer.begin());
+    m_streamPosition += n;
+    return n;
+}
+
+std::size_t LidarFileIO::readRecordsChunk(LidarDataContainer& lidarContainer, const std::size_t nbEchos)
+{
+    const std::size_t n = std::min(nbEchos, m_streamSize - m_streamPosition);
+    lidarContainer.resize(n);
+    readRecords(*m_stream, lidarContainer, 0, n);
+    if(!m_stream->good())
+        throw std::logic_error("LidarFileIO::readRecordsChunk: Failed to read " + m_data_path + "\n");
+    m_streamPosition += n;
+    return n;
+}
+
+template<EnumLidarDataType T>
+struct ProjectAttributeFunctor
+{
+    typedef typename LidarEnumTypeTraits<T>::type AttributeType;
+
+    void operator()(const LidarDataContainer& src, LidarDataContainer& dest, const std::string& name, const std::size_t destFirst)
+    {
+        std::copy(src.beginAttribute<AttributeType>(name), src.endAttribute<AttributeType>(name), dest.beginAttribute<AttributeType>(name) + destFirst);
+    }
+};
+
+void LidarFileIO::projectAttributes(const LidarDataContainer& src, LidarDataContainer& dest, const std::size_t destFirst)
+{
+    assert(destFirst + src.size() <= dest.size());
+    if(src.empty())
+        return;
+
+    const AttributeMapType& attributeMap = dest.getAttributeMap();
+    for(AttributeMapType::const_iterator it = attributeMap.begin(); it != attributeMap.end(); ++it)
+    {
+        apply<ProjectAttributeFunctor, void, const LidarDataContainer&, LidarDataContainer&, const std::string&, const std::size_t>(
+                    it->second.dataType(), src, dest, it->first, destFirst);
+    }
+}
+
+void LidarFileIO::seekStream(LidarDataContainer& lidarContainer, const std::size_t position)
+{
+    if(m_streamData)
+    {
+        m_streamPosition = std::min(position, m_streamSize);
+        return;
+    }
+    if(position < m_streamPosition)
+        throw std::logic_error("LidarFileIO::seekStream: cannot go backwards in " + m_data_path + "\n");
+
+    while(m_streamPosition < position && readChunk(lidarContainer, std::min(recordsBufferSize, position - m_streamPosition)) > 0)
+        ;
+}
+
+void LidarFileIO::seekRecords(const LidarDataContainer& lidarContainer, const std::size_t position)
+{
+    m_streamPosition = std::min(position, m_streamSize);
+    m_stream->clear();
+    m_stream->seekg(m_streamOffset + static_cast<std::streamoff>(m_streamPosition) * lidarContainer.pointSize());
+    if(!m_stream->good())
+        throw std::logic_error("LidarFileIO::seekRecords: Failed to seek in " + m_data_path + "\n");
+}
+
+void LidarFileIO::loadRange(LidarDataContainer& lidarContainer, std::string filename, const std::size_t first, const std::size_t count)
+{
+    openStream(lidarContainer, filename);
+    seekStream(lidarContainer, first);
+    readChunk(lidarContainer, count);
+}
+
+void LidarFileIO::loadAttributes(LidarDataContainer& lidarContainer, const LidarDataContainer& fileMetaData, std::string filename,
+                                 const std::size_t first, const std::size_t count)
+{
+    LidarDataContainer fileChunk;
+    fileChunk.copy(fileMetaData, false);
+
+    openStream(fileMetaData, filename);
+    if(first > 0)
+        seekStream(fileChunk, first);
+    std::size_t position = 0, n = 0;
+    while(position < count && (n = readChunk(fileChunk, std::min(recordsBufferSize, count - position))) > 0)
+    {
+        if(lidarContainer.size() < position + n)
+            lidarContainer.resize(position + n);
+        projectAttributes(fileChunk, lidarContainer, position);
+        position += n;
+    }
+    lidarContainer.resize(position);
+}
+
 void LidarFileIO::setXMLData(const boost::shared_ptr<cs::LidarDataType>& xmlData)
 {
 }
 
 
-LidarFileIO::LidarFileIO(std::string ext):m_xml_path(""), m_data_path(""),m_ext(ext)
+void LidarFileIO::readRecords(std::istream& is, LidarDataContainer& lidarContainer, const std::size_t first, const std::size_t count)
+{
+    const std::size_t pointSize = lidarContainer.pointSize();
+    if(lidarContainer.layout() == LidarDataContainer::interleaved)
+    {
+        is.read(lidarContainer.rawData() + first*pointSize, count*pointSize);
+        return;
+    }
+
+    std::vector<char> buffer(std::min(count, recordsBufferSize)*pointSize);
+    for(std::size_t done = 0; done < count && is.good(); )
+    {
+        const std::size_t n = std::min(count - done, recordsBufferSize);
+        is.read(&buffer.front(), n*pointSize);
+        lidarContainer.importRecords(&buffer.front(), first + done, n);
+        done += n;
+    }
+}
+
+void LidarFileIO::writeRecords(std::ostream& os, const LidarDataContainer& lidarContainer, const std::size_t first, const std::size_t count)
+{
+    const std::size_t pointSize = lidarContainer.pointSize();
+    if(lidarContainer.layout() == LidarDataContainer::interleaved)
+    {
+        os.write(lidarContainer.rawData() + first*pointSize, count*pointSize);
+        return;
+    }
+
+    std::vector<char> buffer(std::min(count, recordsBufferSize)*pointSize);
+    for(std::size_t done = 0; done < count && os.good(); )
+    {
+        const std::size_t n = std::min(count - done, recordsBufferSize);
+        lidarContainer.exportRecords(&buffer.front(), first + done, n);
+        os.write(&buffer.front(), n*pointSize);
+        done += n;
+    }
+}
+
+/// formatter of the values of an attribute: the type is resolved once per attribute, not for each value
+struct AsciiAttributeFormatter
+{
+    virtual ~AsciiAttributeFormatter() {}
+    /// write the value of the attribute of the index-th echo at out, returns the end of the value
+    virtual char* format(char* out, const std::size_t index) const = 0;
+};
+
+template<typename T>
+struct TAsciiAttributeFormatter : public AsciiAttributeFormatter
+{
+    TAsciiAttributeFormatter(const LidarConstIteratorAttribute<T>& begin, const int precision): m_begin(begin), m_precision(precision) {}
+
+    char* format(char* out, const std::size_t index) const
+    {
+        return formatAsciiValue(out, m_begin[index], m_precision);
+    }
+
+    LidarConstIteratorAttribute<T> m_begin;
+    int m_precision;
+};
+
+template<EnumLidarDataType T>
+struct CreateAsciiAttributeFormatterFunctor
+{
+    typedef typename LidarEnumTypeTraits<T>::type AttributeType;
+
+    AsciiAttributeFormatter* operator()(const LidarDataContainer& lidarContainer, const std::string& name, const int float32Precision, const int float64Precision)
+    {
+        return new TAsciiAttributeFormatter<AttributeType>(lidarContainer.beginAttribute<AttributeType>(name),
+                                                           T == LidarDataType::float32 ? float32Precision : float64Precision);
+    }
+};
+
+typedef std::vector<boost::shared_ptr<AsciiAttributeFormatter> > AsciiAttributeFormatters;
+
+/// lines formatted by a thread in its buffer
+struct AsciiBlock
+{
+    std::vector<char> buffer;
+    std::size_t size;
+};
+
+/// echoes [roundFirst+first, roundFirst+first+count[ formatted in blocks[block], its buffer is grown to count lines of at most lineSize characters
+static void formatAsciiBlock(std::vector<AsciiBlock>& blocks, const std::size_t roundFirst, const std::size_t lineSize, const AsciiAttributeFormatters& formatters,
+                             const char separator, const bool trailingSeparator, const std::size_t block, const std::size_t first, const std::size_t count)
+{
+    AsciiBlock& asciiBlock = blocks[block];
+    asciiBlock.size = 0;
+    if(count == 0)
+        return;
+    if(asciiBlock.buffer.size() < count*lineSize)
+        asciiBlock.buffer.resize(count*lineSize);
+    char* out = &asciiBlock.buffer.front();
+    for(std::size_t i = roundFirst + first; i < roundFirst + first + count; ++i)
+    {
+        for(std::size_t a = 0; a < formatters.size(); ++a)
+        {
+            out = formatters[a]->format(out, i);
+            if(trailingSeparator || a + 1 < formatters.size())
+                *out++ = separator;
+        }
+        *out++ = '\n';
+    }
+    asciiBlock.size = out - &asciiBlock.buffer.front();
+}
+
+void LidarFileIO::writeAsciiRecords(std::ostream& os, const LidarDataContainer& lidarContainer, const char separator, const bool trailingSeparator,
+                                    const int float32Precision, const int float64Precision)
+{
+    const AttributeMapType& attributeMap = lidarContainer.getAttributeMap();
+    AsciiAttributeFormatters formatters;
+    for(AttributeMapType::const_iterator it = attributeMap.begin(); it != attributeMap.end(); ++it)
+        formatters.push_back(boost::shared_ptr<AsciiAttributeFormatter>(
+                                 apply<CreateAsciiAttributeFormatterFunctor, AsciiAttributeFormatter*, const LidarDataContainer&, const std::string&, const int, const int>(
+                                     it->second.dataType(), lidarContainer, it->first, float32Precision, float64Precision)));
+
+    // longest value: sign, digits, point and exponent (integers have at most 20 digits)
+    const std::size_t valueSize = 32 + std::max(std::max(float32Precision, float64Precision), 0);
+    const std::size_t lineSize = formatters.size()*(valueSize + 1) + 1;
+    const std::size_t blockSize = std::max<std::size_t>(1, recordsBufferSize / 4);
+
+    // rounds of one block per thread, written in order
+    std::vector<AsciiBlock> blocks(nbParallelBlocks(lidarContainer.size(), blockSize));
+    for(std::size_t roundFirst = 0; roundFirst < lidarContainer.size() && os.good(); roundFirst += blocks.size()*blockSize)
+    {
+        const std::size_t roundCount = std::min(blocks.size()*blockSize, lidarContainer.size() - roundFirst);
+        parallelForBlocks(roundCount, blockSize, boost::bind(&formatAsciiBlock, boost::ref(blocks), roundFirst, lineSize, boost::cref(formatters),
+                                                             separator, trailingSeparator, _1, _2, _3));
+
+        for(std::size_t t = 0; t < nbParallelBlocks(roundCount, blockSize); ++t)
+            os.write(&blocks[t].buffer.front(), blocks[t].size);
+    }
+}
+
+LidarFileIO::LidarFileIO(std::string ext):m_xml_path(""), m_data_path(""),m_ext(ext), m_streamSize(0), m_streamPosition(0), m_streamOffset(0)
 {
 }
 
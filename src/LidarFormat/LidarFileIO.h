@@ -45,6 +45,7 @@ Contributors:
 
 #include <string>
 #include <vector>
+#include <iosfwd>
 #include <boost/shared_ptr.hpp>
 
 #include "LidarFormat/LidarDataFormatTypes.h"
@@ -83,6 +84,11 @@ public:
     /// throws on error
     virtual void loadData(LidarDataContainer& lidarContainer, std::string filename)=0;
 
+    /// use a memory mapping of the data file instead of loading it (see LidarDataContainer::mapRawData)
+    /// only meta data is assumed loaded in the container (no memory allocated)
+    /// returns false if the format (or the container layout) does not allow it, loadData should then be used
+    virtual bool mapData(LidarDataContainer& lidarContainer, std::string filename, bool copyOnWrite);
+
     /// data filename is in the container's xml structure.
     /// for lidarformat, accompanying xml filename is inferred from data filename by replacing ext by .xml
     virtual void save(const LidarDataContainer& lidarContainer, std::string filename)=0;
@@ -95,11 +101,59 @@ public:
     /// DEPRECATED, xmlData is in the container to save
     void setXMLData(const boost::shared_ptr<cs::LidarDataType>& xmlData);
 
+    /// streaming read of the data by consecutive chunks, with a bounded memory (see LidarStreamReader)
+    /// openStream: meta data is loaded in the container (no data), opens the data file
+    /// readChunk: resizes the container to at most nbEchos echoes and fills it with the next echoes of the file
+    /// returns the number of echoes read (0 at the end of the data)
+    /// the default implementation loads all the data at once, formats should redefine both
+    virtual void openStream(const LidarDataContainer& lidarContainer, std::string filename);
+    virtual std::size_t readChunk(LidarDataContainer& lidarContainer, const std::size_t nbEchos);
+    /// seekStream: the next chunk starts at echo position (at the end of the stream if position is after it)
+    /// lidarContainer has the attributes of the file, the default implementation uses it as a buffer to read and drop
+    /// the echoes before position (forward only), formats with fixed size records redefine it with a positioned read
+    virtual void seekStream(LidarDataContainer& lidarContainer, const std::size_t position);
+
+    /// load the echoes [first, first+count[ of the file (less at the end of the file)
+    /// the container has the attributes of the file, a single read at the right offset for fixed size records formats
+    void loadRange(LidarDataContainer& lidarContainer, std::string filename, const std::size_t first, const std::size_t count);
+
+    /// projection: load only the attributes of lidarContainer, a subset of the attributes of the file (described by fileMetaData, without data)
+    /// the file is read by chunks with all its attributes (blocks of records for binary formats) and only the attributes of the container are kept
+    /// only the echoes [first, first+count[ are loaded
+    void loadAttributes(LidarDataContainer& lidarContainer, const LidarDataContainer& fileMetaData, std::string filename,
+                        const std::size_t first = 0, const std::size_t count = std::size_t(-1));
+
+    /// copy the attributes of dest (a subset of the attributes of src) from all the echoes of src, to the echoes of dest starting at destFirst
+    static void projectAttributes(const LidarDataContainer& src, LidarDataContainer& dest, const std::size_t destFirst);
+
+    /// read/write count echoes stored as interleaved records (as in .bin files), whatever the layout of the container
+    static void readRecords(std::istream& is, LidarDataContainer& lidarContainer, const std::size_t first, const std::size_t count);
+    static void writeRecords(std::ostream& os, const LidarDataContainer& lidarContainer, const std::size_t first, const std::size_t count);
+
+    /// write the echoes as text, one echo per line, values separated by separator (also after the last value if trailingSeparator)
+    /// floating point values have float32Precision/float64Precision significant digits (same output as ostream::precision)
+    /// blocks of echoes are formatted concurrently in per thread buffers and written in order
+    static void writeAsciiRecords(std::ostream& os, const LidarDataContainer& lidarContainer, const char separator, const bool trailingSeparator,
+                                  const int float32Precision, const int float64Precision);
+
 protected:
     LidarFileIO(std::string ext);
     /// paths for meta data and data, default data file extention
     std::string m_xml_path, m_data_path, m_ext;
 
+    /// streaming: opened data file, number of echoes in the stream and number of echoes already read
+    boost::shared_ptr<std::ifstream> m_stream;
+    std::size_t m_streamSize, m_streamPosition;
+    /// streaming of formats storing interleaved records (m_stream at the first record to read)
+    std::size_t readRecordsChunk(LidarDataContainer& lidarContainer, const std::size_t nbEchos);
+    /// positioned read of these formats: the first record is at m_streamOffset in m_stream
+    void seekRecords(const LidarDataContainer& lidarContainer, const std::size_t position);
+    std::streamoff m_streamOffset;
+
+private:
+    /// default streaming: all the data, kept until the stream is reopened (seekStream can go backwards)
+    boost::shared_ptr<LidarDataContainer> m_streamData;
+
 };
 
 } //namespace Lidar
@@ -52,18 +52,16 @@ knowledge of the CeCILL-B license and that you accept its terms.
 
 
 
-#include <iostream>
-
 #include "LidarIteratorEcho.h"
 
-
-void swap(Lidar::detail::_LidarEchoProxy p1, Lidar::detail::_LidarEchoProxy p2)
+namespace Lidar
 {
-	using namespace Lidar;
-
-	LidarEcho temp(p1);
-	p1 = p2;
-	p2 = temp;
 
-	std::cout << "called \n" << std::endl;
+void swap(LidarEchoRef lhs, LidarEchoRef rhs)
+{
+	const LidarEcho temp(lhs);
+	lhs = rhs;
+	rhs = temp;
 }
+
+} //namespace Lidar
@@ -49,6 +49,7 @@ Contributors:
 #include <boost/shared_ptr.hpp>
 
 #include "LidarFormat/LidarEcho.h"
+#include "LidarFormat/LidarEchoRef.h"
 
 
 namespace Lidar
@@ -58,56 +59,39 @@ using boost::shared_ptr;
 
 namespace detail
 {
-	struct _LidarEchoProxy
+	/// result of operator-> of the echo iterators: holds the reference on the echo
+	template<typename TEchoRef>
+	struct _LidarEchoRefArrow
 	{
-		_LidarEchoProxy(char *dataPtr, const std::size_t increment, const shared_ptr<AttributeMapType>& attributeMap):
-			m_dataPtr(dataPtr), m_increment(increment), m_attributeMap(attributeMap)
-		{
-		}
-
-		_LidarEchoProxy():
-			m_dataPtr(0), m_increment(0), m_attributeMap(new AttributeMapType)
-		{
-		}
+		explicit _LidarEchoRefArrow(const TEchoRef& ref): m_ref(ref) {}
 
-		_LidarEchoProxy& operator=(const _LidarEchoProxy& rhs)
+		const TEchoRef* operator->() const
 		{
-			memcpy(m_dataPtr, rhs.m_dataPtr, m_increment);
-			return *this;
-		}
-
-		_LidarEchoProxy& operator=(const LidarEcho& rhs)
-		{
-			memcpy(m_dataPtr, rhs.getRawData(), m_increment);
-			return *this;
-		}
-
-	    bool
-	    operator==(const _LidarEchoProxy& rhs) const
-	    {
-	    	return LidarEcho(*this) == LidarEcho(rhs);
-	    }
-
-		operator LidarEcho() const
-		{
-			return LidarEcho(m_increment, m_dataPtr, m_attributeMap);
+			return &m_ref;
 		}
 
 		private:
-			char *m_dataPtr;
-			std::size_t m_increment;
-			shared_ptr<AttributeMapType> m_attributeMap; //infos sur les attributs
+			TEchoRef m_ref;
 	};
 
 	struct _LidarIteratorEchoBase : public std::iterator<std::random_access_iterator_tag, LidarEcho>
 	{
-		_LidarIteratorEchoBase(char *dataPtr, const std::size_t increment, const shared_ptr<AttributeMapType>& attributeMap):
-			m_dataPtr(dataPtr), m_increment(increment), m_attributeMap(attributeMap)
+		_LidarIteratorEchoBase(char *dataPtr, const std::size_t increment, const AttributeMapType* attributeMap):
+			m_dataPtr(dataPtr), m_increment(increment), m_attributeMap(attributeMap),
+			m_basePtr(0), m_columnSize(0), m_pointSize(increment)
+		{
+		}
+
+		/// iterator on a columnar container: dataPtr = basePtr + index, increment is 1
+		_LidarIteratorEchoBase(char *dataPtr, const AttributeMapType* attributeMap, char *basePtr, const std::size_t columnSize, const std::size_t pointSize):
+			m_dataPtr(dataPtr), m_increment(1), m_attributeMap(attributeMap),
+			m_basePtr(basePtr), m_columnSize(columnSize), m_pointSize(pointSize)
 		{
 		}
 
 		_LidarIteratorEchoBase():
-			m_dataPtr(0), m_increment(0), m_attributeMap(new AttributeMapType)
+			m_dataPtr(0), m_increment(0), m_attributeMap(0),
+			m_basePtr(0), m_columnSize(0), m_pointSize(0)
 		{
 		}
 
@@ -165,9 +149,29 @@ namespace detail
 				m_dataPtr -= m_increment;
 			}
 
+			template<typename TAttributeType>
+			TAttributeType* attributePtr(const unsigned int decalage) const
+			{
+				if(!m_columnSize)
+					return reinterpret_cast<TAttributeType*>(m_dataPtr + decalage);
+				return reinterpret_cast<TAttributeType*>(m_basePtr + m_columnSize*decalage + (m_dataPtr - m_basePtr)*sizeof(TAttributeType));
+			}
+
+			LidarEchoRef echoRef() const
+			{
+				if(!m_columnSize)
+					return LidarEchoRef(m_dataPtr, m_pointSize, m_attributeMap);
+				return LidarEchoRef(m_dataPtr, m_pointSize, m_attributeMap, m_basePtr, m_columnSize);
+			}
+
 			char *m_dataPtr;
 			std::size_t m_increment;
-			shared_ptr<AttributeMapType> m_attributeMap; //infos sur les attributs
+			const AttributeMapType* m_attributeMap; //infos sur les attributs
+
+			//stockage colonne : debut des colonnes et taille d'une colonne (0 pour un stockage par echo)
+			char *m_basePtr;
+			std::size_t m_columnSize;
+			std::size_t m_pointSize;
 	};
 }
 
@@ -181,24 +185,27 @@ struct LidarIteratorEcho : public detail::_LidarIteratorEchoBase
 
 		typedef LidarIteratorEcho Self;
 
-	    typedef detail::_LidarEchoProxy  reference;
-	    typedef shared_ptr<detail::_LidarEchoProxy> pointer;
+	    typedef LidarEchoRef  reference;
+	    typedef detail::_LidarEchoRefArrow<LidarEchoRef> pointer;
 
 	    LidarIteratorEcho(){}
 
-		LidarIteratorEcho(char *dataPtr, const std::size_t increment, const shared_ptr<AttributeMapType>& attributeMap):
+		LidarIteratorEcho(char *dataPtr, const std::size_t increment, const AttributeMapType* attributeMap):
 			detail::_LidarIteratorEchoBase(dataPtr, increment, attributeMap) {}
 
+		LidarIteratorEcho(char *dataPtr, const AttributeMapType* attributeMap, char *basePtr, const std::size_t columnSize, const std::size_t pointSize):
+			detail::_LidarIteratorEchoBase(dataPtr, attributeMap, basePtr, columnSize, pointSize) {}
+
 
 
 		reference operator*() const
 		{
-			return reference(m_dataPtr, m_increment, m_attributeMap);
+			return echoRef();
 		}
 
 		pointer operator->() const
 		{
-			return pointer(new reference(**this));
+			return pointer(**this);
 		}
 
 		const Self operator--(int)
@@ -276,14 +283,21 @@ struct LidarIteratorEcho : public detail::_LidarIteratorEchoBase
 		template<typename TAttributeType>
 		TAttributeType& value(const std::string &attributeName) const
 		{
-			return *reinterpret_cast<TAttributeType*>(m_dataPtr + getDecalage(attributeName));
+			return *attributePtr<TAttributeType>(getDecalage(attributeName));
 		}
 
 
 		template<typename TAttributeType>
 		TAttributeType& value(const unsigned int decalage) const
 		{
-			return *reinterpret_cast<TAttributeType*>(m_dataPtr + decalage);
+			return *attributePtr<TAttributeType>(decalage);
+		}
+
+		template<typename TAttributeType>
+		TAttributeType& value(const AttributeHandle<TAttributeType> &handle) const
+		{
+			assert(handle.isValid(*m_attributeMap));
+			return *attributePtr<TAttributeType>(handle.decalage());
 		}
 
 		friend struct LidarConstIteratorEcho;
@@ -299,26 +313,29 @@ struct LidarConstIteratorEcho : public detail::_LidarIteratorEchoBase
 
 		typedef LidarConstIteratorEcho Self;
 
-	    typedef const LidarEcho  reference;
-	    typedef shared_ptr<const LidarEcho> pointer;
+	    typedef LidarConstEchoRef  reference;
+	    typedef detail::_LidarEchoRefArrow<LidarConstEchoRef> pointer;
 
 	    LidarConstIteratorEcho(){}
 
-	    LidarConstIteratorEcho(char *dataPtr, const std::size_t increment, const shared_ptr<AttributeMapType>& attributeMap):
+	    LidarConstIteratorEcho(char *dataPtr, const std::size_t increment, const AttributeMapType* attributeMap):
 			detail::_LidarIteratorEchoBase(dataPtr, increment, attributeMap) {}
 
+	    LidarConstIteratorEcho(char *dataPtr, const AttributeMapType* attributeMap, char *basePtr, const std::size_t columnSize, const std::size_t pointSize):
+			detail::_LidarIteratorEchoBase(dataPtr, attributeMap, basePtr, columnSize, pointSize) {}
+
 	    LidarConstIteratorEcho(const LidarIteratorEcho& rhs):
-			detail::_LidarIteratorEchoBase(rhs.m_dataPtr, rhs.m_increment, rhs.m_attributeMap) {}
+			detail::_LidarIteratorEchoBase(rhs) {}
 
 
 	    reference operator*() const
 		{
-			return reference(m_increment, m_dataPtr, m_attributeMap);
+			return echoRef();
 		}
 
 		pointer operator->() const
 		{
-			return pointer(new reference(**this));
+			return pointer(**this);
 		}
 
 		const Self operator--(int)
@@ -389,13 +406,20 @@ struct LidarConstIteratorEcho : public detail::_LidarIteratorEchoBase
 		template<typename TAttributeType>
 		const TAttributeType value(const std::string &attributeName) const
 		{
-			return *reinterpret_cast<TAttributeType*>(m_dataPtr + getDecalage(attributeName));
+			return *attributePtr<TAttributeType>(getDecalage(attributeName));
 		}
 
 		template<typename TAttributeType>
 		const TAttributeType value(const unsigned int decalage) const
 		{
-			return *reinterpret_cast<TAttributeType*>(m_dataPtr + decalage);
+			return *attributePtr<TAttributeType>(decalage);
+		}
+
+		template<typename TAttributeType>
+		const TAttributeType value(const AttributeHandle<TAttributeType> &handle) const
+		{
+			assert(handle.isValid(*m_attributeMap));
+			return *attributePtr<TAttributeType>(handle.decalage());
 		}
 
 
@@ -407,7 +431,4 @@ struct LidarConstIteratorEcho : public detail::_LidarIteratorEchoBase
 } //namespace Lidar
 
 
-void swap(Lidar::detail::_LidarEchoProxy p1, Lidar::detail::_LidarEchoProxy p2);
-
-
 #endif /* LIDARITERATORECHO_H_ */
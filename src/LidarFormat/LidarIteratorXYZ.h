@@ -81,8 +81,7 @@ namespace detail
 
 		Self& operator=(const Self& rhs)
 		{
-			memcpy(m_dataPtr, rhs.m_dataPtr, m_stride);
-			return *this;
+			return *this = PointType(rhs);
 		}
 
 		Self& operator=(const PointType& rhs)
@@ -120,12 +119,18 @@ namespace detail
 	struct _LidarIteratorXYZBase : public std::iterator<std::random_access_iterator_tag, const TPoint3D<T> >
 	{
 		_LidarIteratorXYZBase(char *dataPtr, const std::size_t increment):
-			m_dataPtr(dataPtr), m_increment(increment)
+			m_dataPtr(dataPtr), m_increment(increment), m_stride(sizeof(T))
+		{
+		}
+
+		/// stride : distance entre x, y et z (sizeof(T) pour un stockage par echo, taille d'une colonne pour un stockage colonne)
+		_LidarIteratorXYZBase(char *dataPtr, const std::size_t increment, const std::size_t stride):
+			m_dataPtr(dataPtr), m_increment(increment), m_stride(stride)
 		{
 		}
 
 		_LidarIteratorXYZBase():
-			m_dataPtr(0), m_increment(0)
+			m_dataPtr(0), m_increment(0), m_stride(sizeof(T))
 		{
 		}
 
@@ -178,6 +183,7 @@ namespace detail
 
 			char *m_dataPtr;
 			std::size_t m_increment;
+			std::size_t m_stride;
 	};
 }
 
@@ -192,6 +198,7 @@ class LidarIteratorXYZ : public detail::_LidarIteratorXYZBase<T>
 {
 	public:
 		LidarIteratorXYZ(char *dataPtr, const unsigned int increment): detail::_LidarIteratorXYZBase<T>(dataPtr, increment) {}
+		LidarIteratorXYZ(char *dataPtr, const unsigned int increment, const std::size_t stride): detail::_LidarIteratorXYZBase<T>(dataPtr, increment, stride) {}
 
 		typedef LidarIteratorXYZ<T> Self;
 		typedef detail::_LidarIteratorXYZBase<T> Super;
@@ -201,8 +208,8 @@ class LidarIteratorXYZ : public detail::_LidarIteratorXYZBase<T>
 		typedef typename Super::difference_type difference_type;
 
 		T& x() const { return *reinterpret_cast<T*>(Super::m_dataPtr); }
-		T& y() const { return *reinterpret_cast<T*>(Super::m_dataPtr + sizeof(T)); }
-		T& z() const { return *reinterpret_cast<T*>(Super::m_dataPtr + 2*sizeof(T)); }
+		T& y() const { return *reinterpret_cast<T*>(Super::m_dataPtr + Super::m_stride); }
+		T& z() const { return *reinterpret_cast<T*>(Super::m_dataPtr + 2*Super::m_stride); }
 
 		const TPoint2D<T> xy() const { return TPoint2D<T>(x(), y()); }
 
@@ -211,7 +218,7 @@ class LidarIteratorXYZ : public detail::_LidarIteratorXYZBase<T>
 
 	    reference operator*() const
 		{
-			return reference(Super::m_dataPtr, sizeof(T));
+			return reference(Super::m_dataPtr, Super::m_stride);
 		}
 
 	    pointer operator->() const
@@ -291,9 +298,10 @@ class LidarConstIteratorXYZ : public detail::_LidarIteratorXYZBase<T>
 {
 	public:
 		LidarConstIteratorXYZ(char *dataPtr, const unsigned int increment): detail::_LidarIteratorXYZBase<T>(dataPtr, increment) {}
+		LidarConstIteratorXYZ(char *dataPtr, const unsigned int increment, const std::size_t stride): detail::_LidarIteratorXYZBase<T>(dataPtr, increment, stride) {}
 
 		LidarConstIteratorXYZ(const LidarIteratorXYZ<T>& rhs):
-			detail::_LidarIteratorXYZBase<T>(rhs.m_dataPtr, rhs.m_increment) {}
+			detail::_LidarIteratorXYZBase<T>(rhs.m_dataPtr, rhs.m_increment, rhs.m_stride) {}
 
 
 		typedef LidarConstIteratorXYZ<T> Self;
@@ -304,8 +312,8 @@ class LidarConstIteratorXYZ : public detail::_LidarIteratorXYZBase<T>
 		typedef typename Super::difference_type difference_type;
 
 		const T x() const { return *reinterpret_cast<T*>(Super::m_dataPtr); }
-		const T y() const { return *reinterpret_cast<T*>(Super::m_dataPtr + sizeof(T)); }
-		const T z() const { return *reinterpret_cast<T*>(Super::m_dataPtr + 2*sizeof(T)); }
+		const T y() const { return *reinterpret_cast<T*>(Super::m_dataPtr + Super::m_stride); }
+		const T z() const { return *reinterpret_cast<T*>(Super::m_dataPtr + 2*Super::m_stride); }
 
 		const TPoint2D<T> xy() const { return TPoint2D<T>(x(), y()); }
 
@@ -0,0 +1,189 @@
+/***********************************************************************
+
+This file is part of the LidarFormat project source files.
+
+LidarFormat is an open source library for efficiently handling 3D point 
+clouds with a variable number of attributes at runtime. 
+
+
+Homepage: 
+
+    http://code.google.com/p/lidarformat
+
+Copyright:
+
+    Institut Geographique National & CEMAGREF (2009)
+
+Author: 
+
+    Adrien Chauve
+
+Contributors:
+
+    Nicolas David, Olivier Tournaire, Bruno Vallet
+
+
+
+    LidarFormat is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LidarFormat is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with LidarFormat.  If not, see <http://www.gnu.org/licenses/>.
+
+***********************************************************************/
+
+
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "LidarFormat/LidarSegmentedData.h"
+
+namespace Lidar
+{
+
+namespace
+{
+/// same attributes (names, types and positions) in the same order
+bool sameAttributes(const AttributeMapType& lhs, const AttributeMapType& rhs)
+{
+    if(lhs.revision() == rhs.revision())
+        return true;
+    if(lhs.size() != rhs.size())
+        return false;
+    for(AttributeMapType::const_iterator itl = lhs.begin(), itr = rhs.begin(); itl != lhs.end(); ++itl, ++itr)
+        if(itl->first != itr->first || itl->second.dataType() != itr->second.dataType() || itl->second.decalage != itr->second.decalage)
+            return false;
+    return true;
+}
+}
+
+LidarSegmentedData::LidarSegmentedData(const LidarDataContainer& metaData, const std::size_t blockSize):
+    m_attributeMap(new AttributeMapType(metaData.getAttributeMap())), m_blockSize(std::max<std::size_t>(1, blockSize)), m_size(0)
+{
+    m_metaData.copy(metaData, false);
+}
+
+char* LidarSegmentedData::appendRoom(const std::size_t count, std::size_t& nbEchos)
+{
+    if(m_blocks.empty() || m_blocks.back().size == m_blocks.back().capacity)
+    {
+        detail::_LidarDataBlock block;
+        block.data = boost::shared_array<char>(new char[m_blockSize*pointSize()]);
+        block.size = 0;
+        block.capacity = m_blockSize;
+        m_blocks.push_back(block);
+        m_blockFirst.push_back(m_size);
+    }
+    detail::_LidarDataBlock& block = m_blocks.back();
+    nbEchos = std::min(count, block.capacity - block.size);
+    char* room = block.data.get() + block.size*pointSize();
+    block.size += nbEchos;
+    m_size += nbEchos;
+    return room;
+}
+
+void LidarSegmentedData::append(const LidarDataContainer& lidarContainer)
+{
+    if(!sameAttributes(lidarContainer.getAttributeMap(), *m_attributeMap))
+        throw std::logic_error("LidarSegmentedData::append: the container does not have the same attributes\n");
+
+    for(std::size_t first = 0; first < lidarContainer.size(); )
+    {
+        std::size_t nbEchos;
+        char* room = appendRoom(lidarContainer.size() - first, nbEchos);
+        lidarContainer.exportRecords(room, first, nbEchos);
+        first += nbEchos;
+    }
+}
+
+void LidarSegmentedData::append(const char* records, const std::size_t count)
+{
+    for(std::size_t first = 0; first < count; )
+    {
+        std::size_t nbEchos;
+        char* room = appendRoom(count - first, nbEchos);
+        memcpy(room, records + first*pointSize(), nbEchos*pointSize());
+        first += nbEchos;
+    }
+}
+
+void LidarSegmentedData::push_back(const LidarConstEchoRef& echo)
+{
+    assert(echo.size() == pointSize());
+    std::size_t nbEchos;
+    echo.copyTo(appendRoom(1, nbEchos));
+}
+
+void LidarSegmentedData::splice(LidarSegmentedData& rhs)
+{
+    if(!sameAttributes(*rhs.m_attributeMap, *m_attributeMap))
+        throw std::logic_error("LidarSegmentedData::splice: the segmented data does not have the same attributes\n");
+    if(&rhs == this)
+        return;
+
+    for(std::size_t b = 0; b < rhs.m_blocks.size(); ++b)
+    {
+        m_blocks.push_back(rhs.m_blocks[b]);
+        m_blockFirst.push_back(m_size);
+        m_size += rhs.m_blocks[b].size;
+    }
+    rhs.clear();
+}
+
+std::size_t LidarSegmentedData::findBlock(const std::size_t index, std::size_t& indexInBlock) const
+{
+    assert(index < m_size);
+    const std::size_t block = std::upper_bound(m_blockFirst.begin(), m_blockFirst.end(), index) - m_blockFirst.begin() - 1;
+    indexInBlock = index - m_blockFirst[block];
+    return block;
+}
+
+LidarEchoRef LidarSegmentedData::operator[](const std::size_t index)
+{
+    std::size_t indexInBlock;
+    const std::size_t block = findBlock(index, indexInBlock);
+    return LidarEchoRef(m_blocks[block].data.get() + indexInBlock*pointSize(), pointSize(), m_attributeMap.get());
+}
+
+LidarConstEchoRef LidarSegmentedData::operator[](const std::size_t index) const
+{
+    std::size_t indexInBlock;
+    const std::size_t block = findBlock(index, indexInBlock);
+    return LidarConstEchoRef(m_blocks[block].data.get() + indexInBlock*pointSize(), pointSize(), m_attributeMap.get());
+}
+
+void LidarSegmentedData::moveTo(LidarDataContainer& lidarContainer)
+{
+    const LidarDataContainer::Layout layout = lidarContainer.layout();
+    lidarContainer.clear();
+    lidarContainer.copy(m_metaData, false);
+    lidarContainer.setLayout(layout);
+
+    // the final size is allocated once (a geometric growth would peak at about 3 times the data),
+    // each block is released as soon as it is copied
+    lidarContainer.reserve(m_size);
+    for(std::size_t b = 0; b < m_blocks.size(); ++b)
+    {
+        lidarContainer.resize(m_blockFirst[b] + m_blocks[b].size);
+        lidarContainer.importRecords(m_blocks[b].data.get(), m_blockFirst[b], m_blocks[b].size);
+        m_blocks[b].data.reset();
+    }
+    clear();
+}
+
+void LidarSegmentedData::clear()
+{
+    std::vector<detail::_LidarDataBlock>().swap(m_blocks);
+    std::vector<std::size_t>().swap(m_blockFirst);
+    m_size = 0;
+}
+
+} //namespace Lidar
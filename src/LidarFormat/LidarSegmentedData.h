@@ -0,0 +1,194 @@
+/***********************************************************************
+
+This file is part of the LidarFormat project source files.
+
+LidarFormat is an open source library for efficiently handling 3D point 
+clouds with a variable number of attributes at runtime. 
+
+
+Homepage: 
+
+    http://code.google.com/p/lidarformat
+
+Copyright:
+
+    Institut Geographique National & CEMAGREF (2009)
+
+Author: 
+
+    Adrien Chauve
+
+Contributors:
+
+    Nicolas David, Olivier Tournaire, Bruno Vallet
+
+
+
+    LidarFormat is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LidarFormat is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with LidarFormat.  If not, see <http://www.gnu.org/licenses/>.
+
+***********************************************************************/
+
+
+
+#ifndef LIDARSEGMENTEDDATA_H_
+#define LIDARSEGMENTEDDATA_H_
+
+#include <cassert>
+#include <iterator>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/shared_array.hpp>
+
+#include "LidarFormat/LidarDataContainer.h"
+#include "LidarFormat/LidarEchoRef.h"
+
+namespace Lidar
+{
+
+namespace detail
+{
+	/// block of interleaved records of LidarSegmentedData
+	struct _LidarDataBlock
+	{
+		boost::shared_array<char> data;
+		std::size_t size, capacity;
+	};
+
+	/// iterator on the echoes of LidarSegmentedData, crossing the blocks (TEchoRef is LidarEchoRef or LidarConstEchoRef)
+	template<typename TEchoRef>
+	struct _LidarSegmentedIterator : public std::iterator<std::forward_iterator_tag, LidarEcho, std::ptrdiff_t, _LidarEchoRefArrow<TEchoRef>, TEchoRef>
+	{
+		typedef _LidarSegmentedIterator Self;
+
+		_LidarSegmentedIterator(): m_blocks(0), m_block(0), m_index(0), m_pointSize(0) {}
+
+		_LidarSegmentedIterator(const std::vector<_LidarDataBlock>& blocks, const std::size_t block, const std::size_t pointSize, const AttributeMapType* attributeMap):
+			m_blocks(&blocks), m_block(block), m_index(0), m_pointSize(pointSize), m_attributeMap(attributeMap)
+		{
+		}
+
+		/// copy, and conversion of an iterator to a const iterator
+		_LidarSegmentedIterator(const _LidarSegmentedIterator<LidarEchoRef>& rhs):
+			m_blocks(rhs.m_blocks), m_block(rhs.m_block), m_index(rhs.m_index), m_pointSize(rhs.m_pointSize), m_attributeMap(rhs.m_attributeMap)
+		{
+		}
+
+		TEchoRef operator*() const
+		{
+			return TEchoRef((*m_blocks)[m_block].data.get() + m_index*m_pointSize, m_pointSize, m_attributeMap);
+		}
+
+		_LidarEchoRefArrow<TEchoRef> operator->() const
+		{
+			return _LidarEchoRefArrow<TEchoRef>(**this);
+		}
+
+		Self& operator++()
+		{
+			if(++m_index == (*m_blocks)[m_block].size)
+			{
+				++m_block;
+				m_index = 0;
+			}
+			return *this;
+		}
+
+		const Self operator++(int)
+		{
+			Self newSelf(*this);
+			++(*this);
+			return newSelf;
+		}
+
+		bool operator==(const Self& rhs) const { return m_block == rhs.m_block && m_index == rhs.m_index; }
+		bool operator!=(const Self& rhs) const { return !(*this == rhs); }
+
+		private:
+			template<typename> friend struct _LidarSegmentedIterator;
+
+			const std::vector<_LidarDataBlock>* m_blocks;
+			std::size_t m_block, m_index;
+			std::size_t m_pointSize;
+			const AttributeMapType* m_attributeMap;
+	};
+}
+
+/**
+* @brief Echoes stored as interleaved records in blocks of fixed size
+*
+* Appending never moves the echoes already stored (no reallocation of the whole data) and containers are concatenated
+* without copy (splice), for instance to merge many tiles with a memory close to the final size.
+* The echoes are accessed through references (LidarEchoRef) or moved to a LidarDataContainer at the end.
+*
+*/
+class LidarSegmentedData
+{
+public:
+    typedef detail::_LidarSegmentedIterator<LidarEchoRef> iterator;
+    typedef detail::_LidarSegmentedIterator<LidarConstEchoRef> const_iterator;
+
+    /// blocks of blockSize echoes with the attributes of metaData (its data is not used)
+    explicit LidarSegmentedData(const LidarDataContainer& metaData, const std::size_t blockSize = 1 << 16);
+
+    std::size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+    unsigned int pointSize() const { return m_metaData.pointSize(); }
+    std::size_t blockSize() const { return m_blockSize; }
+    std::size_t nbBlocks() const { return m_blocks.size(); }
+
+    /// append copies of the echoes of a container of the same attributes (any layout)
+    void append(const LidarDataContainer& lidarContainer);
+    /// append count interleaved records
+    void append(const char* records, const std::size_t count);
+    void push_back(const LidarConstEchoRef& echo);
+
+    /// concatenation without copy: the blocks of rhs (same attributes, throws otherwise) are moved after the echoes, rhs is empty after
+    void splice(LidarSegmentedData& rhs);
+
+    /// random access (search of the block)
+    LidarEchoRef operator[](const std::size_t index);
+    LidarConstEchoRef operator[](const std::size_t index) const;
+
+    iterator begin() { return iterator(m_blocks, 0, pointSize(), m_attributeMap.get()); }
+    iterator end() { return iterator(m_blocks, m_blocks.size(), pointSize(), m_attributeMap.get()); }
+    const_iterator begin() const { return const_iterator(m_blocks, 0, pointSize(), m_attributeMap.get()); }
+    const_iterator end() const { return const_iterator(m_blocks, m_blocks.size(), pointSize(), m_attributeMap.get()); }
+
+    /// move the echoes to lidarContainer (attributes of the meta data, the layout of lidarContainer is kept)
+    /// the container grows block by block and each block is released as soon as it is copied, the segmented data is empty after
+    void moveTo(LidarDataContainer& lidarContainer);
+
+    void clear();
+
+private:
+    /// room for at most count echoes at the end of the last block (a new block is added if it is full)
+    /// returns the start of the room and its number of echoes, that are counted in the size
+    char* appendRoom(const std::size_t count, std::size_t& nbEchos);
+    /// block of an echo, index of the echo in the block
+    std::size_t findBlock(const std::size_t index, std::size_t& indexInBlock) const;
+
+    LidarDataContainer m_metaData;
+    shared_ptr<AttributeMapType> m_attributeMap;
+    std::size_t m_blockSize;
+
+    std::vector<detail::_LidarDataBlock> m_blocks;
+    /// index of the first echo of each block
+    std::vector<std::size_t> m_blockFirst;
+    std::size_t m_size;
+};
+
+} //namespace Lidar
+
+#endif /* LIDARSEGMENTEDDATA_H_ */
@@ -0,0 +1,158 @@
+/***********************************************************************
+
+This file is part of the LidarFormat project source files.
+
+LidarFormat is an open source library for efficiently handling 3D point 
+clouds with a variable number of attributes at runtime. 
+
+
+Homepage: 
+
+    http://code.google.com/p/lidarformat
+
+Copyright:
+
+    Institut Geographique National & CEMAGREF (2009)
+
+Author: 
+
+    Adrien Chauve
+
+Contributors:
+
+    Nicolas David, Olivier Tournaire, Bruno Vallet
+
+
+
+    LidarFormat is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LidarFormat is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with LidarFormat.  If not, see <http://www.gnu.org/licenses/>.
+
+***********************************************************************/
+
+
+#include <stdexcept>
+#include <algorithm>
+
+#include "LidarIOFactory.h"
+
+#include "LidarFormat/LidarStreamReader.h"
+
+namespace Lidar
+{
+
+LidarStreamReader::LidarStreamReader(const std::string &filename, const std::size_t chunkSize):
+    m_file(filename), m_projection(false), m_chunkSize(chunkSize), m_position(0), m_end(std::size_t(-1)), m_centering(false),
+    m_fileTransfoX(0), m_fileTransfoY(0)
+{
+    m_file.loadMetaData(m_metaData);
+    m_chunkMetaData.copy(m_metaData, false);
+    m_fileChunk.copy(m_metaData, false);
+    openStream(filename);
+}
+
+LidarStreamReader::LidarStreamReader(const std::string &filename, const std::vector<std::string>& attributeNames, const std::size_t chunkSize):
+    m_file(filename), m_projection(true), m_chunkSize(chunkSize), m_position(0), m_end(std::size_t(-1)), m_centering(false),
+    m_fileTransfoX(0), m_fileTransfoY(0)
+{
+    m_file.loadMetaData(m_metaData);
+    m_chunkMetaData.setMapsFromXML(m_metaData.getXmlStructure(), attributeNames);
+    m_fileChunk.copy(m_metaData, false);
+    openStream(filename);
+}
+
+void LidarStreamReader::openStream(const std::string &filename)
+{
+    if(m_chunkSize == 0)
+        throw std::logic_error("LidarStreamReader: chunk size should be strictly positive\n");
+
+    m_reader = LidarIOFactory::instance().createObject(m_metaData.getXmlStructure()->attributes().dataFormat());
+    m_reader->openStream(m_metaData, filename);
+}
+
+void LidarStreamReader::loadMetaData(LidarDataContainer& lidarContainer) const
+{
+    lidarContainer.setMapsFromXML(m_chunkMetaData.getXmlStructure());
+}
+
+bool LidarStreamReader::readChunk(LidarDataContainer& lidarContainer)
+{
+    if(lidarContainer.getAttributeMap().empty())
+        loadMetaData(lidarContainer);
+    else if(lidarContainer.pointSize() != m_chunkMetaData.pointSize())
+        throw std::logic_error("LidarStreamReader::readChunk: the container attributes do not match the file\n");
+
+    if(m_centering)
+    {
+        lidarContainer.resize(0);
+        lidarContainer.changeAttributes(m_uncentering);
+        lidarContainer.setCenteringTransfo(m_fileTransfoX, m_fileTransfoY);
+    }
+
+    const std::size_t chunkSize = std::min(m_chunkSize, m_end - std::min(m_position, m_end));
+    std::size_t n = 0;
+    if(chunkSize == 0)
+        lidarContainer.resize(0);
+    else if(m_projection)
+    {
+        n = m_reader->readChunk(m_fileChunk, chunkSize);
+        lidarContainer.resize(n);
+        LidarFileIO::projectAttributes(m_fileChunk, lidarContainer, 0);
+    }
+    else
+        n = m_reader->readChunk(lidarContainer, chunkSize);
+
+    if(m_centering)
+    {
+        const bool computed = m_transfo.x() == 0 && m_transfo.y() == 0 && n > 0;
+        m_transfo.centerLidarDataContainerInPlace(lidarContainer, m_x.c_str(), m_y.c_str(), m_z.c_str());
+        if(computed)
+            m_chunkMetaData.setCenteringTransfo(m_fileTransfoX + m_transfo.x(), m_fileTransfoY + m_transfo.y());
+    }
+
+    m_position += n;
+    return n > 0;
+}
+
+void LidarStreamReader::setRange(const std::size_t first, const std::size_t count)
+{
+    m_reader->seekStream(m_fileChunk, first);
+    m_position = first;
+    m_end = first + std::min(count, std::size_t(-1) - first);
+}
+
+void LidarStreamReader::setCentering(const LidarCenteringTransfo& transfo, const std::string& x, const std::string& y, const std::string& z)
+{
+    if(m_centering)
+        throw std::logic_error("LidarStreamReader::setCentering: the chunks are already centered\n");
+
+    m_uncentering = AttributeChanges()
+            .changeType(x, m_chunkMetaData.getAttributeType(x), AttributeChanges::cast)
+            .changeType(y, m_chunkMetaData.getAttributeType(y), AttributeChanges::cast)
+            .changeType(z, m_chunkMetaData.getAttributeType(z), AttributeChanges::cast);
+    m_chunkMetaData.getCenteringTransfo(m_fileTransfoX, m_fileTransfoY);
+
+    // schema of the chunks: the meta data is centered (without data)
+    m_transfo = transfo;
+    m_transfo.centerLidarDataContainerInPlace(m_chunkMetaData, x.c_str(), y.c_str(), z.c_str());
+    m_x = x;
+    m_y = y;
+    m_z = z;
+    m_centering = true;
+}
+
+std::size_t LidarStreamReader::getNbPoints() const
+{
+    return m_file.getNbPoints();
+}
+
+} //namespace Lidar
@@ -0,0 +1,121 @@
+/***********************************************************************
+
+This file is part of the LidarFormat project source files.
+
+LidarFormat is an open source library for efficiently handling 3D point 
+clouds with a variable number of attributes at runtime. 
+
+
+Homepage: 
+
+    http://code.google.com/p/lidarformat
+
+Copyright:
+
+    Institut Geographique National & CEMAGREF (2009)
+
+Author: 
+
+    Adrien Chauve
+
+Contributors:
+
+    Nicolas David, Olivier Tournaire, Bruno Vallet
+
+
+
+    LidarFormat is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LidarFormat is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with LidarFormat.  If not, see <http://www.gnu.org/licenses/>.
+
+***********************************************************************/
+
+
+#ifndef LIDARSTREAMREADER_H_
+#define LIDARSTREAMREADER_H_
+
+#include <string>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+
+#include "LidarFormat/LidarFile.h"
+#include "LidarFormat/LidarDataContainer.h"
+#include "LidarFormat/geometry/LidarCenteringTransfo.h"
+
+namespace Lidar
+{
+
+/**
+* @brief Out of core reading of a lidar file by consecutive chunks of echoes
+*
+* Works for all registered formats (same filenames as LidarFile), the memory used is bounded by the chunk size
+* (except for formats that do not redefine LidarFileIO::openStream/readChunk)
+*
+*/
+class LidarStreamReader
+{
+public:
+    explicit LidarStreamReader(const std::string &filename, const std::size_t chunkSize = 1 << 20);
+    /// projection: the chunks only have the attributes in attributeNames
+    LidarStreamReader(const std::string &filename, const std::vector<std::string>& attributeNames, const std::size_t chunkSize = 1 << 20);
+
+    /// load meta data (schema of the chunks) in a container
+    void loadMetaData(LidarDataContainer& lidarContainer) const;
+
+    /// read the next chunk of at most chunkSize() echoes in the container
+    /// the meta data is loaded in the container if it has no attributes
+    /// returns false if all echoes were already read (the container is then empty)
+    bool readChunk(LidarDataContainer& lidarContainer);
+
+    std::size_t chunkSize() const { return m_chunkSize; }
+    /// number of echoes announced by the meta data
+    std::size_t getNbPoints() const;
+    /// index of the first echo of the next chunk
+    std::size_t position() const { return m_position; }
+
+    /// restrict the reading to the echoes [first, first+count[ of the file
+    /// positioned read for binary formats, for the other formats first should not be before position()
+    void setRange(const std::size_t first, const std::size_t count);
+
+    /// centering of the chunks while streaming (see LidarCenteringTransfo::centerLidarDataContainerInPlace), to call before reading
+    /// x, y, z of the chunks (and of the meta data) become float32, the transfo is computed from the first echo read if it is 0
+    void setCentering(const LidarCenteringTransfo& transfo, const std::string& x="x", const std::string& y="y", const std::string& z="z");
+    const LidarCenteringTransfo& centeringTransfo() const { return m_transfo; }
+
+private:
+    void openStream(const std::string &filename);
+
+    LidarFile m_file;
+    /// meta data of the file and of the chunks
+    LidarDataContainer m_metaData, m_chunkMetaData;
+    boost::shared_ptr<LidarFileIO> m_reader;
+
+    /// projection: the chunks are read with all attributes in m_fileChunk (also used as a buffer to seek)
+    bool m_projection;
+    LidarDataContainer m_fileChunk;
+
+    std::size_t m_chunkSize;
+    /// next echo to read, end of the range to read
+    std::size_t m_position, m_end;
+
+    /// centering: a chunk gets back the types of the file before reading the next one in place (same memory)
+    bool m_centering;
+    LidarCenteringTransfo m_transfo;
+    std::string m_x, m_y, m_z;
+    AttributeChanges m_uncentering;
+    /// centering transfo of the file (0 if none)
+    double m_fileTransfoX, m_fileTransfoY;
+};
+
+} //namespace Lidar
+
+#endif /* LIDARSTREAMREADER_H_ */
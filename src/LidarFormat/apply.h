@@ -51,8 +51,7 @@ Contributors:
 #include <boost/preprocessor/comma_if.hpp>
 #include <boost/preprocessor/inc.hpp>
 
-#include <boost/bind.hpp>
-#include <boost/function.hpp>
+#include <stdexcept>
 
 #include <boost/preprocessor/seq/for_each.hpp>
 
@@ -77,8 +76,7 @@ Contributors:
 
 		#define SWITCH_GENERATION(r, data, TYPE)\
 			case LidarDataType::TYPE:\
-				result = boost::bind(&TFunctor<LidarDataType::TYPE>::operator(), TFunctor<LidarDataType::TYPE>() BOOST_PP_COMMA_IF(N) BOOST_PP_ENUM_SHIFTED_PARAMS_Z(1, BOOST_PP_INC(N), _) );\
-				break;
+				return TFunctor<LidarDataType::TYPE>()(BOOST_PP_ENUM_PARAMS_Z(1, N, a));
 
 
 		template
@@ -89,21 +87,19 @@ Contributors:
 		>
 		R apply(const EnumLidarDataType switchedVariable BOOST_PP_COMMA_IF(N) BOOST_PP_ENUM_BINARY_PARAMS_Z(1, N, A, a))
 		{
-
-			boost::function<R( BOOST_PP_ENUM_PARAMS_Z(1, N, A) )> result;
+			// direct call of the functor of the type (the arguments are passed with the types A given explicitly)
 			switch(switchedVariable)
 			{
 				BOOST_PP_SEQ_FOR_EACH(SWITCH_GENERATION, N, TYPES)
 			}
 
-			return result(BOOST_PP_ENUM_PARAMS_Z(1, N, a));
-
+			throw std::logic_error("apply: unknown attribute type\n");
 		}
 
 
 		#undef TYPES
 		#undef N
-		#undef SWITCH_GENERATION_NEW
+		#undef SWITCH_GENERATION
 
 
 	}
@@ -41,10 +41,11 @@ std::string WriteLasXmlHeader(const std::string& las_filename, bool debug)
     ofs << "    <Attribute DataType=\"float64\" Name=\"x\"/>\n";
     ofs << "    <Attribute DataType=\"float64\" Name=\"y\"/>\n";
     ofs << "    <Attribute DataType=\"float64\" Name=\"z\"/>\n";
-    ofs << "    <Attribute DataType=\"uint32\" Name=\"intensity\"/>\n";
-    ofs << "    <Attribute DataType=\"uint32\" Name=\"classification\"/>\n";
-    ofs << "    <Attribute DataType=\"uint32\" Name=\"returnNumber\"/>\n";
-    ofs << "    <Attribute DataType=\"uint32\" Name=\"numberOfReturns\"/>\n";
+    // same types as the las point records (the values are converted to the types of the header when decoded)
+    ofs << "    <Attribute DataType=\"uint16\" Name=\"intensity\"/>\n";
+    ofs << "    <Attribute DataType=\"uint8\" Name=\"classification\"/>\n";
+    ofs << "    <Attribute DataType=\"uint8\" Name=\"returnNumber\"/>\n";
+    ofs << "    <Attribute DataType=\"uint8\" Name=\"numberOfReturns\"/>\n";
     ofs << "  </Attributes>\n</LidarData>\n";
     return lasxml_filepath.string();
 }
@@ -0,0 +1,408 @@
+/***********************************************************************
+
+This file is part of the LidarFormat project source files.
+
+LidarFormat is an open source library for efficiently handling 3D point 
+clouds with a variable number of attributes at runtime. 
+
+
+Homepage: 
+
+    http://code.google.com/p/lidarformat
+
+Copyright:
+
+    Institut Geographique National & CEMAGREF (2009)
+
+Author: 
+
+    Adrien Chauve
+
+Contributors:
+
+    Nicolas David, Olivier Tournaire, Bruno Vallet
+
+
+
+    LidarFormat is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LidarFormat is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with LidarFormat.  If not, see <http://www.gnu.org/licenses/>.
+
+***********************************************************************/
+
+
+#include <cstring>
+#include <stdexcept>
+#include <algorithm>
+
+#include "LasFormat.h"
+
+namespace Lidar
+{
+
+template<typename T>
+static void putValue(char* buffer, const unsigned int offset, const T value)
+{
+    std::memcpy(buffer + offset, &value, sizeof(T));
+}
+
+template<typename T>
+static T getValue(const char* buffer, const unsigned int offset)
+{
+    T value;
+    std::memcpy(&value, buffer + offset, sizeof(T));
+    return value;
+}
+
+static std::string getString(const char* buffer, const unsigned int offset, const std::size_t size)
+{
+    const char* begin = buffer + offset;
+    return std::string(begin, std::find(begin, begin + size, '\0'));
+}
+
+static void putString(char* buffer, const unsigned int offset, const std::string& value, const std::size_t size)
+{
+    std::memset(buffer + offset, 0, size);
+    std::memcpy(buffer + offset, value.data(), std::min(size, value.size()));
+}
+
+/// waveform packets fields (formats 4, 5, 9 and 10)
+static void addLasWaveFields(std::vector<LasPointField>& fields, const unsigned int offset)
+{
+    fields.push_back(LasPointField("wavePacketDescriptorIndex", LidarDataType::uint8, offset));
+    fields.push_back(LasPointField("waveformDataOffset", LidarDataType::uint64, offset + 1));
+    fields.push_back(LasPointField("waveformPacketSize", LidarDataType::uint32, offset + 9));
+    fields.push_back(LasPointField("returnPointWaveformLocation", LidarDataType::float32, offset + 13));
+    fields.push_back(LasPointField("xt", LidarDataType::float32, offset + 17));
+    fields.push_back(LasPointField("yt", LidarDataType::float32, offset + 21));
+    fields.push_back(LasPointField("zt", LidarDataType::float32, offset + 25));
+}
+
+static void addLasRGBFields(std::vector<LasPointField>& fields, const unsigned int offset)
+{
+    fields.push_back(LasPointField("red", LidarDataType::uint16, offset));
+    fields.push_back(LasPointField("green", LidarDataType::uint16, offset + 2));
+    fields.push_back(LasPointField("blue", LidarDataType::uint16, offset + 4));
+}
+
+static std::vector<LasPointField> makeLasPointFields(const int pointFormat)
+{
+    std::vector<LasPointField> fields;
+    fields.push_back(LasPointField("x", LidarDataType::int32, 0));
+    fields.push_back(LasPointField("y", LidarDataType::int32, 4));
+    fields.push_back(LasPointField("z", LidarDataType::int32, 8));
+    fields.push_back(LasPointField("intensity", LidarDataType::uint16, 12));
+    if(pointFormat < 6)
+    {
+        fields.push_back(LasPointField("returnNumber", LidarDataType::uint8, 14, 0, 3));
+        fields.push_back(LasPointField("numberOfReturns", LidarDataType::uint8, 14, 3, 3));
+        fields.push_back(LasPointField("scanDirectionFlag", LidarDataType::uint8, 14, 6, 1));
+        fields.push_back(LasPointField("edgeOfFlightLine", LidarDataType::uint8, 14, 7, 1));
+        fields.push_back(LasPointField("classification", LidarDataType::uint8, 15, 0, 5));
+        fields.push_back(LasPointField("classificationFlags", LidarDataType::uint8, 15, 5, 3));
+        fields.push_back(LasPointField("scanAngleRank", LidarDataType::int8, 16));
+        fields.push_back(LasPointField("userData", LidarDataType::uint8, 17));
+        fields.push_back(LasPointField("pointSourceId", LidarDataType::uint16, 18));
+        switch(pointFormat)
+        {
+        case 0: break;
+        case 1: fields.push_back(LasPointField("gpsTime", LidarDataType::float64, 20)); break;
+        case 2: addLasRGBFields(fields, 20); break;
+        case 3:
+        case 5:
+            fields.push_back(LasPointField("gpsTime", LidarDataType::float64, 20));
+            addLasRGBFields(fields, 28);
+            if(pointFormat == 5) addLasWaveFields(fields, 34);
+            break;
+        case 4:
+            fields.push_back(LasPointField("gpsTime", LidarDataType::float64, 20));
+            addLasWaveFields(fields, 28);
+            break;
+        default: throw std::logic_error("LAS: unknown point data record format\n");
+        }
+        return fields;
+    }
+
+    fields.push_back(LasPointField("returnNumber", LidarDataType::uint8, 14, 0, 4));
+    fields.push_back(LasPointField("numberOfReturns", LidarDataType::uint8, 14, 4, 4));
+    fields.push_back(LasPointField("classificationFlags", LidarDataType::uint8, 15, 0, 4));
+    fields.push_back(LasPointField("scannerChannel", LidarDataType::uint8, 15, 4, 2));
+    fields.push_back(LasPointField("scanDirectionFlag", LidarDataType::uint8, 15, 6, 1));
+    fields.push_back(LasPointField("edgeOfFlightLine", LidarDataType::uint8, 15, 7, 1));
+    fields.push_back(LasPointField("classification", LidarDataType::uint8, 16));
+    fields.push_back(LasPointField("userData", LidarDataType::uint8, 17));
+    fields.push_back(LasPointField("scanAngle", LidarDataType::int16, 18));
+    fields.push_back(LasPointField("pointSourceId", LidarDataType::uint16, 20));
+    fields.push_back(LasPointField("gpsTime", LidarDataType::float64, 22));
+    switch(pointFormat)
+    {
+    case 6: break;
+    case 7: addLasRGBFields(fields, 30); break;
+    case 8:
+    case 10:
+        addLasRGBFields(fields, 30);
+        fields.push_back(LasPointField("nir", LidarDataType::uint16, 36));
+        if(pointFormat == 10) addLasWaveFields(fields, 38);
+        break;
+    case 9: addLasWaveFields(fields, 30); break;
+    default: throw std::logic_error("LAS: unknown point data record format\n");
+    }
+    return fields;
+}
+
+const std::vector<LasPointField>& getLasPointFields(const int pointFormat)
+{
+    static std::vector<std::vector<LasPointField> > allFields;
+    if(allFields.empty())
+        for(int format = 0; format <= 10; ++format)
+            allFields.push_back(makeLasPointFields(format));
+
+    if(pointFormat < 0 || pointFormat > 10)
+        throw std::logic_error("LAS: unknown point data record format\n");
+    return allFields[pointFormat];
+}
+
+unsigned int getLasPointRecordLength(const int pointFormat)
+{
+    static const unsigned int recordLengths[] = {20, 28, 26, 34, 57, 63, 30, 36, 38, 59, 67};
+    if(pointFormat < 0 || pointFormat > 10)
+        throw std::logic_error("LAS: unknown point data record format\n");
+    return recordLengths[pointFormat];
+}
+
+int chooseLasPointFormat(const std::vector<std::string>& attributeNames)
+{
+    bool gpsTime = false, rgb = false, nir = false, wave = false, las14 = false;
+    for(std::vector<std::string>::const_iterator it = attributeNames.begin(); it != attributeNames.end(); ++it)
+    {
+        gpsTime = gpsTime || *it == "gpsTime";
+        rgb = rgb || *it == "red" || *it == "green" || *it == "blue";
+        nir = nir || *it == "nir";
+        wave = wave || *it == "wavePacketDescriptorIndex" || *it == "waveformDataOffset" || *it == "waveformPacketSize" ||
+                *it == "returnPointWaveformLocation" || *it == "xt" || *it == "yt" || *it == "zt";
+        las14 = las14 || *it == "scannerChannel" || *it == "scanAngle";
+    }
+
+    if(las14 || nir)
+    {
+        if(wave) return rgb || nir ? 10 : 9;
+        if(nir) return 8;
+        return rgb ? 7 : 6;
+    }
+    if(wave) return rgb ? 5 : 4;
+    if(rgb) return gpsTime ? 3 : 2;
+    return gpsTime ? 1 : 0;
+}
+
+unsigned int getLasExtraBytesType(const EnumLidarDataType type)
+{
+    switch(type)
+    {
+    case LidarDataType::uint8: return 1;
+    case LidarDataType::int8: return 2;
+    case LidarDataType::uint16: return 3;
+    case LidarDataType::int16: return 4;
+    case LidarDataType::uint32: return 5;
+    case LidarDataType::int32: return 6;
+    case LidarDataType::uint64: return 7;
+    case LidarDataType::int64: return 8;
+    case LidarDataType::float32: return 9;
+    case LidarDataType::float64: return 10;
+    default: return 0;
+    }
+}
+
+bool getLasExtraBytesAttributeType(const unsigned int extraBytesType, EnumLidarDataType& type)
+{
+    static const LidarDataType::Value types[] = {LidarDataType::uint8, LidarDataType::int8, LidarDataType::uint16, LidarDataType::int16,
+                                                 LidarDataType::uint32, LidarDataType::int32, LidarDataType::uint64, LidarDataType::int64,
+                                                 LidarDataType::float32, LidarDataType::float64};
+    if(extraBytesType < 1 || extraBytesType > 10)
+        return false;
+    type = types[extraBytesType - 1];
+    return true;
+}
+
+LasHeader::LasHeader():
+    fileSourceId(0), globalEncoding(0), versionMajor(1), versionMinor(2),
+    systemIdentifier("LidarFormat"), generatingSoftware("LidarFormat"), creationDay(0), creationYear(0),
+    offsetToPointData(0), nbVariableLengthRecords(0), pointFormat(0), pointRecordLength(20), nbPoints(0),
+    waveformDataStart(0), extendedVariableLengthRecordsStart(0), nbExtendedVariableLengthRecords(0)
+{
+    std::fill(nbPointsByReturn, nbPointsByReturn + 15, 0);
+    for(int i = 0; i < 3; ++i)
+    {
+        scale[i] = 0.001;
+        offset[i] = min[i] = max[i] = 0.;
+    }
+}
+
+unsigned int LasHeader::headerSize(const unsigned int versionMinor)
+{
+    return versionMinor >= 4 ? 375 : versionMinor == 3 ? 235 : 227;
+}
+
+unsigned int LasHeader::pointFormatVersionMinor(const int pointFormat)
+{
+    return pointFormat >= 6 ? 4 : pointFormat >= 4 ? 3 : 2;
+}
+
+void LasHeader::write(char* buffer) const
+{
+    const unsigned int size = headerSize(versionMinor);
+    std::memset(buffer, 0, size);
+    std::memcpy(buffer, "LASF", 4);
+    putValue<boost::uint16_t>(buffer, 4, fileSourceId);
+    putValue<boost::uint16_t>(buffer, 6, globalEncoding);
+    putValue<boost::uint8_t>(buffer, 24, versionMajor);
+    putValue<boost::uint8_t>(buffer, 25, versionMinor);
+    putString(buffer, 26, systemIdentifier, 32);
+    putString(buffer, 58, generatingSoftware, 32);
+    putValue<boost::uint16_t>(buffer, 90, creationDay);
+    putValue<boost::uint16_t>(buffer, 92, creationYear);
+    putValue<boost::uint16_t>(buffer, 94, size);
+    putValue<boost::uint32_t>(buffer, 96, offsetToPointData);
+    putValue<boost::uint32_t>(buffer, 100, nbVariableLengthRecords);
+    putValue<boost::uint8_t>(buffer, 104, pointFormat);
+    putValue<boost::uint16_t>(buffer, 105, pointRecordLength);
+
+    // legacy counts: 0 for the formats 6 to 10 and when they overflow
+    const bool legacy = pointFormat < 6 && nbPoints <= 0xFFFFFFFFu;
+    putValue<boost::uint32_t>(buffer, 107, legacy ? boost::uint32_t(nbPoints) : 0);
+    for(int i = 0; i < 5; ++i)
+        putValue<boost::uint32_t>(buffer, 111 + 4*i, legacy ? boost::uint32_t(nbPointsByReturn[i]) : 0);
+
+    for(int i = 0; i < 3; ++i)
+    {
+        putValue<double>(buffer, 131 + 8*i, scale[i]);
+        putValue<double>(buffer, 155 + 8*i, offset[i]);
+        putValue<double>(buffer, 179 + 16*i, max[i]);
+        putValue<double>(buffer, 187 + 16*i, min[i]);
+    }
+
+    if(versionMinor >= 3)
+        putValue<boost::uint64_t>(buffer, 227, waveformDataStart);
+    if(versionMinor >= 4)
+    {
+        putValue<boost::uint64_t>(buffer, 235, extendedVariableLengthRecordsStart);
+        putValue<boost::uint32_t>(buffer, 243, nbExtendedVariableLengthRecords);
+        putValue<boost::uint64_t>(buffer, 247, nbPoints);
+        for(int i = 0; i < 15; ++i)
+            putValue<boost::uint64_t>(buffer, 255 + 8*i, nbPointsByReturn[i]);
+    }
+}
+
+void LasHeader::read(const char* buffer, const std::size_t size)
+{
+    if(size < 227 || std::memcmp(buffer, "LASF", 4) != 0)
+        throw std::logic_error("LAS: not a las file (wrong signature)\n");
+
+    fileSourceId = getValue<boost::uint16_t>(buffer, 4);
+    globalEncoding = getValue<boost::uint16_t>(buffer, 6);
+    versionMajor = getValue<boost::uint8_t>(buffer, 24);
+    versionMinor = getValue<boost::uint8_t>(buffer, 25);
+    systemIdentifier = getString(buffer, 26, 32);
+    generatingSoftware = getString(buffer, 58, 32);
+    creationDay = getValue<boost::uint16_t>(buffer, 90);
+    creationYear = getValue<boost::uint16_t>(buffer, 92);
+    const unsigned int fileHeaderSize = getValue<boost::uint16_t>(buffer, 94);
+    offsetToPointData = getValue<boost::uint32_t>(buffer, 96);
+    nbVariableLengthRecords = getValue<boost::uint32_t>(buffer, 100);
+    // bits 6 and 7 flag compressed (laz) records
+    if(getValue<boost::uint8_t>(buffer, 104) & 0xC0)
+        throw std::logic_error("LAS: compressed point data records are not handled\n");
+    pointFormat = getValue<boost::uint8_t>(buffer, 104);
+    pointRecordLength = getValue<boost::uint16_t>(buffer, 105);
+    if(pointFormat > 10 || pointRecordLength < getLasPointRecordLength(pointFormat))
+        throw std::logic_error("LAS: unknown point data record format\n");
+
+    nbPoints = getValue<boost::uint32_t>(buffer, 107);
+    std::fill(nbPointsByReturn, nbPointsByReturn + 15, 0);
+    for(int i = 0; i < 5; ++i)
+        nbPointsByReturn[i] = getValue<boost::uint32_t>(buffer, 111 + 4*i);
+
+    for(int i = 0; i < 3; ++i)
+    {
+        scale[i] = getValue<double>(buffer, 131 + 8*i);
+        offset[i] = getValue<double>(buffer, 155 + 8*i);
+        max[i] = getValue<double>(buffer, 179 + 16*i);
+        min[i] = getValue<double>(buffer, 187 + 16*i);
+    }
+
+    waveformDataStart = extendedVariableLengthRecordsStart = 0;
+    nbExtendedVariableLengthRecords = 0;
+    if(versionMinor >= 3 && fileHeaderSize >= 235 && size >= 235)
+        waveformDataStart = getValue<boost::uint64_t>(buffer, 227);
+    if(versionMinor >= 4 && fileHeaderSize >= 375 && size >= 375)
+    {
+        extendedVariableLengthRecordsStart = getValue<boost::uint64_t>(buffer, 235);
+        nbExtendedVariableLengthRecords = getValue<boost::uint32_t>(buffer, 243);
+        // the legacy counts may be 0 (formats 6 to 10, more than 2^32 points)
+        nbPoints = getValue<boost::uint64_t>(buffer, 247);
+        for(int i = 0; i < 15; ++i)
+            nbPointsByReturn[i] = getValue<boost::uint64_t>(buffer, 255 + 8*i);
+    }
+}
+
+void writeLasVariableLengthRecordHeader(char* buffer, const std::string& userId, const boost::uint16_t recordId,
+                                        const boost::uint16_t recordLength, const std::string& description)
+{
+    std::memset(buffer, 0, lasVariableLengthRecordHeaderSize);
+    putString(buffer, 2, userId, 16);
+    putValue<boost::uint16_t>(buffer, 18, recordId);
+    putValue<boost::uint16_t>(buffer, 20, recordLength);
+    putString(buffer, 22, description, 32);
+}
+
+void writeLasExtraBytesDescriptor(char* buffer, const std::string& name, const EnumLidarDataType type)
+{
+    std::memset(buffer, 0, lasExtraBytesDescriptorSize);
+    putValue<boost::uint8_t>(buffer, 2, getLasExtraBytesType(type));
+    putString(buffer, 4, name, 32);
+    putString(buffer, 160, "LidarFormat attribute", 32);
+}
+
+void readLasExtraBytesDescriptors(const char* buffer, const std::size_t size, unsigned int offset, std::vector<LasPointField>& fields)
+{
+    for(std::size_t descriptor = 0; descriptor + lasExtraBytesDescriptorSize <= size; descriptor += lasExtraBytesDescriptorSize)
+    {
+        const char* d = buffer + descriptor;
+        const unsigned int extraBytesType = getValue<boost::uint8_t>(d, 2);
+        const unsigned int options = getValue<boost::uint8_t>(d, 3);
+
+        EnumLidarDataType type;
+        if(!getLasExtraBytesAttributeType(extraBytesType, type))
+        {
+            // undocumented extra bytes (size in options), arrays of 2 or 3 values (deprecated)
+            static const unsigned int sizes[] = {1, 1, 2, 2, 4, 4, 8, 8, 4, 8};
+            if(extraBytesType == 0)
+                offset += options;
+            else if(extraBytesType <= 30)
+                offset += sizes[(extraBytesType - 11) % 10] * ((extraBytesType - 1) / 10 + 1);
+            else
+                throw std::logic_error("LAS: unknown extra bytes data type\n");
+            continue;
+        }
+
+        LasPointField field(getString(d, 4, 32), type, offset);
+        // options bit 3: scale, bit 4: offset
+        if(options & (1 << 3 | 1 << 4))
+        {
+            field.scale = options & (1 << 3) ? getValue<double>(d, 112) : 1.;
+            field.valueOffset = options & (1 << 4) ? getValue<double>(d, 136) : 0.;
+        }
+        fields.push_back(field);
+        offset += getRecordFieldTypeSize(type);
+    }
+}
+
+} //namespace Lidar
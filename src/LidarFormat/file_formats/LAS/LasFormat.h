@@ -0,0 +1,126 @@
+/***********************************************************************
+
+This file is part of the LidarFormat project source files.
+
+LidarFormat is an open source library for efficiently handling 3D point 
+clouds with a variable number of attributes at runtime. 
+
+
+Homepage: 
+
+    http://code.google.com/p/lidarformat
+
+Copyright:
+
+    Institut Geographique National & CEMAGREF (2009)
+
+Author: 
+
+    Adrien Chauve
+
+Contributors:
+
+    Nicolas David, Olivier Tournaire, Bruno Vallet
+
+
+
+    LidarFormat is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LidarFormat is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with LidarFormat.  If not, see <http://www.gnu.org/licenses/>.
+
+***********************************************************************/
+
+
+#ifndef LASFORMAT_H_
+#define LASFORMAT_H_
+
+/**
+ * \brief Layout of LAS 1.2 to 1.4 files (ASPRS LAS specification), without any dependency
+ *
+ * Point data record formats 0 to 10 are described by a list of fields with the name of the
+ * corresponding lidarformat attribute. x, y, z are stored as scaled int32 and read as float64.
+ * Attributes that are not part of the record format are stored as extra bytes (LAS 1.4).
+ *
+ */
+
+#include <string>
+#include <vector>
+
+#include <boost/cstdint.hpp>
+
+#include "LidarFormat/LidarDataFormatTypes.h"
+#include "LidarFormat/file_formats/RecordFields.h"
+
+namespace Lidar
+{
+
+/// a field of a point data record (x, y, z and extra bytes with a scale or an offset are scaled fields)
+typedef RecordField LasPointField;
+
+/// fields of point data record formats 0 to 10 (throws for other formats)
+const std::vector<LasPointField>& getLasPointFields(const int pointFormat);
+/// size of the standard fields of a record
+unsigned int getLasPointRecordLength(const int pointFormat);
+/// smallest point data record format having all the attributes in attributeNames that are las fields
+int chooseLasPointFormat(const std::vector<std::string>& attributeNames);
+
+/// extra bytes data types (LAS 1.4): 0 if the type has none
+unsigned int getLasExtraBytesType(const EnumLidarDataType type);
+/// type of an extra bytes data type, returns false for types not handled (arrays, deprecated)
+bool getLasExtraBytesAttributeType(const unsigned int extraBytesType, EnumLidarDataType& type);
+
+/// public header block
+struct LasHeader
+{
+    LasHeader();
+
+    /// header size of the version (227, 235 or 375 bytes)
+    static unsigned int headerSize(const unsigned int versionMinor);
+    /// las 1.2 for formats 0 to 3, 1.3 for 4 and 5, 1.4 for 6 to 10
+    static unsigned int pointFormatVersionMinor(const int pointFormat);
+
+    /// serialize to headerSize bytes (little endian)
+    void write(char* buffer) const;
+    /// deserialize from the first size bytes of a file, throws if it is not a las header
+    void read(const char* buffer, const std::size_t size);
+
+    boost::uint16_t fileSourceId, globalEncoding;
+    unsigned int versionMajor, versionMinor;
+    std::string systemIdentifier, generatingSoftware;
+    boost::uint16_t creationDay, creationYear;
+    boost::uint32_t offsetToPointData, nbVariableLengthRecords;
+    int pointFormat;
+    boost::uint16_t pointRecordLength;
+    boost::uint64_t nbPoints;
+    boost::uint64_t nbPointsByReturn[15];
+    double scale[3], offset[3], min[3], max[3];
+    boost::uint64_t waveformDataStart, extendedVariableLengthRecordsStart;
+    boost::uint32_t nbExtendedVariableLengthRecords;
+};
+
+/// variable length record header size
+static const unsigned int lasVariableLengthRecordHeaderSize = 54;
+/// extra bytes descriptor size
+static const unsigned int lasExtraBytesDescriptorSize = 192;
+
+/// write a variable length record header (54 bytes)
+void writeLasVariableLengthRecordHeader(char* buffer, const std::string& userId, const boost::uint16_t recordId,
+                                        const boost::uint16_t recordLength, const std::string& description);
+/// write an extra bytes descriptor (192 bytes)
+void writeLasExtraBytesDescriptor(char* buffer, const std::string& name, const EnumLidarDataType type);
+/// read the descriptors of an extra bytes record of size bytes and append the corresponding fields, starting at offset in the point records
+/// extra bytes that can not be read as an attribute (undocumented, arrays, deprecated types) are skipped
+void readLasExtraBytesDescriptors(const char* buffer, const std::size_t size, unsigned int offset, std::vector<LasPointField>& fields);
+
+} //namespace Lidar
+
+#endif /* LASFORMAT_H_ */
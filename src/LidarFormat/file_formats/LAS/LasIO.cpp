@@ -39,42 +39,38 @@ Contributors:
 
 ***********************************************************************/
 
-
-
-#include <liblas/point.hpp>
-#include <liblas/reader.hpp>
-
+#include <algorithm>
+#include <iostream>
 
 #include "LidarFormat/LidarIOFactory.h"
 #include "LidarFormat/LidarDataContainer.h"
 
 #include "LasIO.h"
+#include "LasReader.h"
+#include "LasWriter.h"
 
 namespace Lidar
 {
 
 boost::shared_ptr<cs::LidarDataType> LasMetaDataIO::load(const std::string& filename)
 {
-    std::ifstream las_ifs(filename.c_str(), std::ios::binary);
-    if(!las_ifs.good()) throw std::logic_error(std::string(__FUNCTION__) + ": Failed to open " + filename +"\n");
     std::cout << __FUNCTION__ << " " << filename << std::endl;
-    liblas::Reader reader(las_ifs);
+    const LasReader reader(filename);
 
-    liblas::Header const& header = reader.GetHeader();
-    std::cout << "Signature: " << header.GetFileSignature() << std::endl;
-    std::cout << "Points count: " << header.GetPointRecordsCount() << std::endl;
-
-    cs::LidarDataType::AttributesType attributes(header.GetPointRecordsCount(),cs::DataFormatType::las);
+    cs::LidarDataType::AttributesType attributes(reader.size(), cs::DataFormatType::las);
     attributes.dataFileName() = filename;
-    // attributes.centeringTransfo(cs::CenteringTransfoType(tx, ty)); // TODO: handle centering
-    // TODO: handle various las versions and user fields
-    attributes.attribute().push_back(cs::AttributeContainerType::AttributeType(LidarDataType::float64, "x"));
-    attributes.attribute().push_back(cs::AttributeContainerType::AttributeType(LidarDataType::float64, "y"));
-    attributes.attribute().push_back(cs::AttributeContainerType::AttributeType(LidarDataType::float64, "z"));
-    attributes.attribute().push_back(cs::AttributeContainerType::AttributeType(LidarDataType::int32, "intensity"));
-    attributes.attribute().push_back(cs::AttributeContainerType::AttributeType(LidarDataType::int32, "classification"));
-    attributes.attribute().push_back(cs::AttributeContainerType::AttributeType(LidarDataType::int32, "returnNumber"));
-    attributes.attribute().push_back(cs::AttributeContainerType::AttributeType(LidarDataType::int32, "numberOfReturns"));
+    // fields of the point data record format and extra bytes, with their types (x, y, z are scaled to float64)
+    for(std::vector<LasPointField>::const_iterator field = reader.fields().begin(); field != reader.fields().end(); ++field)
+    {
+        cs::AttributeContainerType::AttributeType attribute(getRecordFieldAttributeType(*field), field->name);
+        const std::size_t i = field - reader.fields().begin();
+        if(i < 3 && reader.size() > 0)
+        {
+            attribute.min(reader.header().min[i]);
+            attribute.max(reader.header().max[i]);
+        }
+        attributes.attribute().push_back(attribute);
+    }
 
     boost::shared_ptr<cs::LidarDataType> xmlStructure(new cs::LidarDataType(attributes));
     return xmlStructure;
@@ -97,10 +93,8 @@ bool LasMetaDataIO::m_isRegistered = LasMetaDataIO::Register();
 void LasIO::loadData(LidarDataContainer& lidarContainer, std::string filename)
 {
     getPaths(lidarContainer, filename);
-    std::ifstream las_ifs(m_data_path.c_str(), std::ios::binary);
-    if(!las_ifs.good()) throw std::logic_error(std::string(__FUNCTION__) + ": Failed to open " + m_data_path +"\n");
-    liblas::Reader reader(las_ifs);
-    boost::uint32_t n_points = reader.GetHeader().GetPointRecordsCount();
+    const LasReader reader(m_data_path);
+    const std::size_t n_points = reader.size();
     if(n_points != lidarContainer.size())
     {
         std::cout << __FILE__ << ":" << __LINE__ << ": WARNING: Number of points in header=" << n_points <<
@@ -109,34 +103,39 @@ void LasIO::loadData(LidarDataContainer& lidarContainer, std::string filename)
         lidarContainer.getXmlStructure()->attributes().dataSize(n_points);
     }
 
-    // fill the container
-    int decalage_x = lidarContainer.getDecalage("x");
-    int decalage_y = lidarContainer.getDecalage("y");
-    int decalage_z = lidarContainer.getDecalage("z");
-    int decalage_intensity = lidarContainer.getDecalage("intensity");
-    int decalage_echo = lidarContainer.getDecalage("returnNumber");
-    int decalage_classification = lidarContainer.getDecalage("classification");
-    int decalage_numberOfReturns = lidarContainer.getDecalage("numberOfReturns");
-
-    LidarIteratorEcho itEcho = lidarContainer.begin();
-    while (reader.ReadNextPoint() ) //&& itEcho!=lidarContainer.endEcho())
-    {
-        liblas::Point const& p = reader.GetPoint();
-        itEcho.value<double>(decalage_x) = p.GetX();
-        itEcho.value<double>(decalage_y) = p.GetY();
-        itEcho.value<double>(decalage_z) = p.GetZ();
-        itEcho.value<int32>(decalage_intensity) = p.GetIntensity();
-        itEcho.value<int32>(decalage_classification) = p.GetClassification().GetClass();
-        itEcho.value<int32>(decalage_echo) = p.GetReturnNumber();
-        itEcho.value<int32>(decalage_numberOfReturns) = p.GetNumberOfReturns();
-        ++itEcho;
-    }
+    reader.read(lidarContainer, 0);
+}
+
+void LasIO::openStream(const LidarDataContainer& lidarContainer, std::string filename)
+{
+    getPaths(lidarContainer, filename);
+    m_reader.reset(new LasReader(m_data_path));
+
+    m_streamSize = m_reader->size();
+    m_streamPosition = 0;
+}
+
+std::size_t LasIO::readChunk(LidarDataContainer& lidarContainer, const std::size_t nbEchos)
+{
+    const std::size_t n = std::min(nbEchos, m_streamSize - m_streamPosition);
+    lidarContainer.resize(n);
+    m_reader->read(lidarContainer, m_streamPosition);
+
+    m_streamPosition += n;
+    return n;
+}
+
+void LasIO::seekStream(LidarDataContainer& lidarContainer, const std::size_t position)
+{
+    m_streamPosition = std::min(position, m_streamSize);
 }
 
 void LasIO::save(const LidarDataContainer& lidarContainer, std::string filename)
 {
-    // TODO: use xml struture to write a real las file (not just a .bin)
-    throw std::logic_error("Not implemented yet\n");
+    getPaths(lidarContainer, filename);
+    LasWriter writer(m_data_path, lidarContainer);
+    writer.write(lidarContainer);
+    writer.close();
 }
 
 boost::shared_ptr<LasIO> createLasIO()
@@ -48,6 +48,9 @@ Contributors:
 
 namespace Lidar
 {
+
+class LasReader;
+
 class LasMetaDataIO : public MetaDataIO
 {
 public:
@@ -70,6 +73,9 @@ public:
     virtual ~LasIO();
 
     virtual void loadData(LidarDataContainer& lidarContainer, std::string filename);
+    virtual void openStream(const LidarDataContainer& lidarContainer, std::string filename);
+    virtual std::size_t readChunk(LidarDataContainer& lidarContainer, const std::size_t nbEchos);
+    virtual void seekStream(LidarDataContainer& lidarContainer, const std::size_t position);
     virtual void save(const LidarDataContainer& lidarContainer, std::string filename);
 
     static bool Register();
@@ -77,6 +83,9 @@ public:
 
 private:
     LasIO();
+
+    /// streaming reader
+    boost::shared_ptr<LasReader> m_reader;
 };
 
 } //namespace Lidar
@@ -0,0 +1,163 @@
+/***********************************************************************
+
+This file is part of the LidarFormat project source files.
+
+LidarFormat is an open source library for efficiently handling 3D point 
+clouds with a variable number of attributes at runtime. 
+
+
+Homepage: 
+
+    http://code.google.com/p/lidarformat
+
+Copyright:
+
+    Institut Geographique National & CEMAGREF (2009)
+
+Author: 
+
+    Adrien Chauve
+
+Contributors:
+
+    Nicolas David, Olivier Tournaire, Bruno Vallet
+
+
+
+    LidarFormat is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LidarFormat is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with LidarFormat.  If not, see <http://www.gnu.org/licenses/>.
+
+***********************************************************************/
+
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include "LidarFormat/LidarDataContainer.h"
+
+#include "LasReader.h"
+
+namespace Lidar
+{
+
+LasReader::LasReader(const std::string& filename):
+    m_filename(filename)
+{
+    std::ifstream ifs(filename.c_str(), std::ios::binary);
+    if(!ifs.good())
+        throw std::logic_error("LasReader: Failed to open " + filename + "\n");
+    ifs.seekg(0, std::ios::end);
+    const boost::uint64_t fileSize = ifs.tellg();
+    ifs.seekg(0);
+
+    char buffer[375];
+    ifs.read(buffer, sizeof(buffer));
+    m_header.read(buffer, ifs.gcount());
+    boost::uint16_t headerSize;
+    std::memcpy(&headerSize, buffer + 94, sizeof(headerSize));
+
+    m_fields = getLasPointFields(m_header.pointFormat);
+    for(int i = 0; i < 3; ++i)
+    {
+        m_fields[i].scale = m_header.scale[i];
+        m_fields[i].valueOffset = m_header.offset[i];
+    }
+
+    // extra bytes descriptions, in a variable length record or in an extended one (LAS 1.4)
+    ifs.clear();
+    ifs.seekg(headerSize);
+    for(boost::uint32_t i = 0; i < m_header.nbVariableLengthRecords && ifs.good(); ++i)
+    {
+        char vlr[lasVariableLengthRecordHeaderSize];
+        ifs.read(vlr, sizeof(vlr));
+        boost::uint16_t recordId, recordLength;
+        std::memcpy(&recordId, vlr + 18, sizeof(recordId));
+        std::memcpy(&recordLength, vlr + 20, sizeof(recordLength));
+        if(std::strncmp(vlr + 2, "LASF_Spec", 16) == 0 && recordId == 4)
+            readExtraBytes(ifs, recordLength, fileSize);
+        else
+            ifs.seekg(recordLength, std::ios::cur);
+    }
+
+    ifs.clear();
+    ifs.seekg(m_header.extendedVariableLengthRecordsStart);
+    for(boost::uint32_t i = 0; i < m_header.nbExtendedVariableLengthRecords && ifs.good(); ++i)
+    {
+        char evlr[60];
+        ifs.read(evlr, sizeof(evlr));
+        boost::uint16_t recordId;
+        boost::uint64_t recordLength;
+        std::memcpy(&recordId, evlr + 18, sizeof(recordId));
+        std::memcpy(&recordLength, evlr + 20, sizeof(recordLength));
+        if(std::strncmp(evlr + 2, "LASF_Spec", 16) == 0 && recordId == 4)
+            readExtraBytes(ifs, recordLength, fileSize);
+        else
+            ifs.seekg(recordLength, std::ios::cur);
+    }
+
+    if(ifs.bad())
+        throw std::logic_error("LasReader: Failed to read the header of " + filename + "\n");
+
+    // truncated files: only the complete records are read
+    const boost::uint64_t nbRecords = fileSize > m_header.offsetToPointData ? (fileSize - m_header.offsetToPointData) / m_header.pointRecordLength : 0;
+    if(nbRecords < m_header.nbPoints)
+    {
+        std::cout << "LasReader: WARNING: " << filename << " has " << nbRecords << " point records instead of " << m_header.nbPoints << std::endl;
+        m_header.nbPoints = nbRecords;
+    }
+}
+
+void LasReader::readExtraBytes(std::istream& is, const boost::uint64_t size, const boost::uint64_t fileSize)
+{
+    if(size == 0)
+        return;
+    // the length is checked before the allocation: a corrupted one would allocate up to 2^64 bytes
+    const std::streamoff position = is.tellg();
+    if(position < 0 || static_cast<boost::uint64_t>(position) > fileSize || size > fileSize - position || size % lasExtraBytesDescriptorSize != 0)
+        throw std::logic_error("LasReader: invalid extra bytes record in " + m_filename + "\n");
+
+    std::vector<char> descriptors(size);
+    is.read(&descriptors[0], size);
+    if(!is.good())
+        return;
+
+    std::vector<LasPointField> extraBytes;
+    readLasExtraBytesDescriptors(&descriptors[0], size, getLasPointRecordLength(m_header.pointFormat), extraBytes);
+    for(std::vector<LasPointField>::const_iterator field = extraBytes.begin(); field != extraBytes.end(); ++field)
+        if(field->offset + getRecordFieldTypeSize(field->type) <= m_header.pointRecordLength)
+            m_fields.push_back(*field);
+}
+
+void LasReader::read(LidarDataContainer& lidarContainer, const std::size_t first) const
+{
+    using namespace boost::interprocess;
+
+    const std::size_t count = lidarContainer.size();
+    if(count == 0)
+        return;
+    if(first + count > m_header.nbPoints)
+        throw std::logic_error("LasReader::read: out of the records of " + m_filename + "\n");
+
+    const unsigned int recordLength = m_header.pointRecordLength;
+    file_mapping file(m_filename.c_str(), read_only);
+    mapped_region region(file, read_only, m_header.offsetToPointData + boost::uint64_t(first)*recordLength, count*recordLength);
+    decodeRecords(static_cast<const char*>(region.get_address()), recordLength, m_fields, lidarContainer);
+}
+
+} //namespace Lidar
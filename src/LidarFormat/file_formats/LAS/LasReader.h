@@ -0,0 +1,90 @@
+/***********************************************************************
+
+This file is part of the LidarFormat project source files.
+
+LidarFormat is an open source library for efficiently handling 3D point 
+clouds with a variable number of attributes at runtime. 
+
+
+Homepage: 
+
+    http://code.google.com/p/lidarformat
+
+Copyright:
+
+    Institut Geographique National & CEMAGREF (2009)
+
+Author: 
+
+    Adrien Chauve
+
+Contributors:
+
+    Nicolas David, Olivier Tournaire, Bruno Vallet
+
+
+
+    LidarFormat is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LidarFormat is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with LidarFormat.  If not, see <http://www.gnu.org/licenses/>.
+
+***********************************************************************/
+
+
+
+#ifndef LASREADER_H_
+#define LASREADER_H_
+
+#include <string>
+#include <vector>
+#include <iosfwd>
+
+#include "LasFormat.h"
+
+namespace Lidar
+{
+
+class LidarDataContainer;
+
+/**
+* @brief Reads LAS files (1.0 to 1.4, point data record formats 0 to 10) without any dependency
+*
+* The fields of the records (point data record format and extra bytes described in the variable length records)
+* are decoded in the attributes of the same name, by blocks of records of a memory mapping of the file, in parallel.
+*
+*/
+class LasReader
+{
+public:
+    /// reads the header of filename and the description of its records, throws on error
+    explicit LasReader(const std::string& filename);
+
+    const LasHeader& header() const { return m_header; }
+    /// fields of the records (x, y, z are scaled fields)
+    const std::vector<LasPointField>& fields() const { return m_fields; }
+    boost::uint64_t size() const { return m_header.nbPoints; }
+
+    /// decode the records [first, first+lidarContainer.size()[ in the attributes of lidarContainer (a subset of the fields)
+    /// the centering transfo of the container is applied to x and y
+    void read(LidarDataContainer& lidarContainer, const std::size_t first) const;
+
+private:
+    void readExtraBytes(std::istream& is, const boost::uint64_t size, const boost::uint64_t fileSize);
+
+    std::string m_filename;
+    LasHeader m_header;
+    std::vector<LasPointField> m_fields;
+};
+
+} //namespace Lidar
+
+#endif /* LASREADER_H_ */
@@ -0,0 +1,240 @@
+/***********************************************************************
+
+This file is part of the LidarFormat project source files.
+
+LidarFormat is an open source library for efficiently handling 3D point 
+clouds with a variable number of attributes at runtime. 
+
+
+Homepage: 
+
+    http://code.google.com/p/lidarformat
+
+Copyright:
+
+    Institut Geographique National & CEMAGREF (2009)
+
+Author: 
+
+    Adrien Chauve
+
+Contributors:
+
+    Nicolas David, Olivier Tournaire, Bruno Vallet
+
+
+
+    LidarFormat is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LidarFormat is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with LidarFormat.  If not, see <http://www.gnu.org/licenses/>.
+
+***********************************************************************/
+
+
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+
+#include "LidarFormat/LidarDataContainer.h"
+
+#include "LasWriter.h"
+
+namespace Lidar
+{
+
+/// number of records encoded at once
+static const std::size_t lasRecordsBlockSize = 1 << 16;
+
+static const char* coordinateNames[] = {"x", "y", "z"};
+
+LasWriter::LasWriter(const std::string& filename, const LidarDataContainer& lidarContainer, const int pointFormat):
+    m_filename(filename), m_ofs(filename.c_str(), std::ios::binary), m_pointSize(lidarContainer.pointSize()), m_scaleOffsetSet(false)
+{
+    if(!m_ofs.good())
+        throw std::logic_error("LasWriter: Failed to open " + filename + "\n");
+
+    std::vector<std::string> attributeNames;
+    lidarContainer.getAttributeList(attributeNames);
+    m_header.pointFormat = pointFormat < 0 ? chooseLasPointFormat(attributeNames) : pointFormat;
+    m_header.versionMinor = LasHeader::pointFormatVersionMinor(m_header.pointFormat);
+    if(m_header.pointFormat >= 6)
+        m_header.globalEncoding |= 1 << 4; // WKT coordinate system (mandatory for formats 6 to 10)
+
+    const std::time_t now = std::time(0);
+    const std::tm* date = std::gmtime(&now);
+    m_header.creationDay = date->tm_yday + 1;
+    m_header.creationYear = date->tm_year + 1900;
+
+    // standard fields present in the container, and extra bytes for the other attributes
+    const std::vector<LasPointField>& fields = getLasPointFields(m_header.pointFormat);
+    unsigned int recordLength = getLasPointRecordLength(m_header.pointFormat);
+    std::vector<LasPointField> extraBytes;
+    for(AttributeMapType::const_iterator it = lidarContainer.getAttributeMap().begin(); it != lidarContainer.getAttributeMap().end(); ++it)
+    {
+        std::vector<LasPointField>::const_iterator field = fields.begin();
+        while(field != fields.end() && field->name != it->first)
+            ++field;
+        if(field != fields.end())
+            m_fields.push_back(*field);
+        else
+        {
+            extraBytes.push_back(LasPointField(it->first, it->second.dataType(), recordLength));
+            recordLength += getRecordFieldTypeSize(it->second.dataType());
+        }
+    }
+    m_fields.insert(m_fields.end(), extraBytes.begin(), extraBytes.end());
+    m_header.pointRecordLength = recordLength;
+
+    double tx = 0., ty = 0.;
+    lidarContainer.getCenteringTransfo(tx, ty);
+    m_translation[0] = tx; m_translation[1] = ty; m_translation[2] = 0.;
+    for(int i = 0; i < 3; ++i)
+    {
+        m_min[i] = std::numeric_limits<double>::max();
+        m_max[i] = -std::numeric_limits<double>::max();
+    }
+
+    // header and extra bytes descriptors, the header is rewritten by close
+    const unsigned int headerSize = LasHeader::headerSize(m_header.versionMinor);
+    std::vector<char> buffer(headerSize);
+    if(!extraBytes.empty())
+    {
+        m_header.nbVariableLengthRecords = 1;
+        const unsigned int vlrSize = extraBytes.size()*lasExtraBytesDescriptorSize;
+        buffer.resize(headerSize + lasVariableLengthRecordHeaderSize + vlrSize);
+        writeLasVariableLengthRecordHeader(&buffer[headerSize], "LASF_Spec", 4, vlrSize, "Extra Bytes");
+        for(std::size_t i = 0; i < extraBytes.size(); ++i)
+        {
+            if(extraBytes[i].name.size() > 32)
+                throw std::logic_error("LasWriter: attribute name longer than 32 characters: " + extraBytes[i].name + "\n");
+            writeLasExtraBytesDescriptor(&buffer[headerSize + lasVariableLengthRecordHeaderSize + i*lasExtraBytesDescriptorSize],
+                                         extraBytes[i].name, extraBytes[i].type);
+        }
+    }
+    m_header.offsetToPointData = buffer.size();
+    m_header.write(&buffer[0]);
+    m_ofs.write(&buffer[0], buffer.size());
+}
+
+LasWriter::~LasWriter()
+{
+    try
+    {
+        close();
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << e.what();
+    }
+}
+
+void LasWriter::setBounds(const double min[3], const double max[3])
+{
+    // integer offsets, and a millimetric scale unless the bounds do not fit in 32 bits integers
+    for(int i = 0; i < 3; ++i)
+    {
+        const double absMin = min[i] + m_translation[i], absMax = max[i] + m_translation[i];
+        m_header.offset[i] = absMin <= absMax ? std::floor(absMin) : 0.;
+        m_header.scale[i] = 0.001;
+        while((absMax - m_header.offset[i]) / m_header.scale[i] > std::numeric_limits<boost::int32_t>::max())
+            m_header.scale[i] *= 10.;
+    }
+    for(std::vector<LasPointField>::iterator field = m_fields.begin(); field != m_fields.end(); ++field)
+        for(int i = 0; i < 3; ++i)
+            if(field->name == coordinateNames[i])
+            {
+                field->scale = m_header.scale[i];
+                field->valueOffset = m_header.offset[i];
+            }
+    m_scaleOffsetSet = true;
+}
+
+void LasWriter::write(const LidarDataContainer& lidarContainer)
+{
+    if(!m_ofs.is_open())
+        throw std::logic_error("LasWriter::write: " + m_filename + " is closed\n");
+    if(lidarContainer.pointSize() != m_pointSize)
+        throw std::logic_error("LasWriter::write: the container attributes do not match the las file\n");
+    if(lidarContainer.empty())
+        return;
+
+    if(!m_scaleOffsetSet)
+    {
+        double min[3], max[3];
+        for(int i = 0; i < 3; ++i)
+        {
+            min[i] = std::numeric_limits<double>::max();
+            max[i] = -std::numeric_limits<double>::max();
+            getAttributeMinMax(lidarContainer, coordinateNames[i], min[i], max[i]);
+        }
+        setBounds(min, max);
+    }
+
+    RecordsEncoder encoder(m_fields, lidarContainer);
+
+    const unsigned int recordLength = m_header.pointRecordLength;
+    const unsigned int returnBits = m_header.pointFormat < 6 ? 0x07 : 0x0F;
+    std::vector<char> records(std::min(lidarContainer.size(), lasRecordsBlockSize)*recordLength);
+    for(std::size_t first = 0; first < lidarContainer.size(); first += lasRecordsBlockSize)
+    {
+        const std::size_t count = std::min(lidarContainer.size() - first, lasRecordsBlockSize);
+        std::fill(records.begin(), records.begin() + count*recordLength, 0);
+        encoder.encode(&records[0], recordLength, first, count);
+
+        for(std::size_t i = 0; i < count; ++i)
+        {
+            const unsigned int returnNumber = records[i*recordLength + 14] & returnBits;
+            if(returnNumber > 0)
+                ++m_header.nbPointsByReturn[returnNumber - 1];
+        }
+
+        m_ofs.write(&records[0], count*recordLength);
+        if(!m_ofs.good())
+            throw std::logic_error("LasWriter::write: Failed to write " + m_filename + "\n");
+    }
+    m_header.nbPoints += lidarContainer.size();
+    for(int i = 0; i < 3; ++i)
+        encoder.getScaledBounds(coordinateNames[i], m_min[i], m_max[i]);
+}
+
+void LasWriter::close()
+{
+    if(!m_ofs.is_open())
+        return;
+
+    if(m_header.pointFormat < 6 && m_header.nbPoints > 0xFFFFFFFFu)
+        throw std::logic_error("LasWriter: more than 2^32 points need a point data record format >= 6\n");
+
+    for(int i = 0; i < 3; ++i)
+    {
+        if(m_min[i] > m_max[i])
+            m_header.min[i] = m_header.max[i] = 0.;
+        else
+        {
+            m_header.min[i] = m_min[i]*m_header.scale[i] + m_header.offset[i];
+            m_header.max[i] = m_max[i]*m_header.scale[i] + m_header.offset[i];
+        }
+    }
+
+    std::vector<char> buffer(LasHeader::headerSize(m_header.versionMinor));
+    m_header.write(&buffer[0]);
+    m_ofs.seekp(0);
+    m_ofs.write(&buffer[0], buffer.size());
+    m_ofs.close();
+    if(m_ofs.fail())
+        throw std::logic_error("LasWriter::close: Failed to write " + m_filename + "\n");
+}
+
+} //namespace Lidar
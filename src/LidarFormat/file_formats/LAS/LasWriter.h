@@ -0,0 +1,103 @@
+/***********************************************************************
+
+This file is part of the LidarFormat project source files.
+
+LidarFormat is an open source library for efficiently handling 3D point 
+clouds with a variable number of attributes at runtime. 
+
+
+Homepage: 
+
+    http://code.google.com/p/lidarformat
+
+Copyright:
+
+    Institut Geographique National & CEMAGREF (2009)
+
+Author: 
+
+    Adrien Chauve
+
+Contributors:
+
+    Nicolas David, Olivier Tournaire, Bruno Vallet
+
+
+
+    LidarFormat is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LidarFormat is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with LidarFormat.  If not, see <http://www.gnu.org/licenses/>.
+
+***********************************************************************/
+
+
+#ifndef LASWRITER_H_
+#define LASWRITER_H_
+
+#include <string>
+#include <fstream>
+#include <vector>
+
+#include "LasFormat.h"
+
+namespace Lidar
+{
+
+class LidarDataContainer;
+
+/**
+* @brief Writes echoes in a LAS file (1.2 to 1.4, point data record formats 0 to 10), possibly by consecutive chunks
+*
+* Attributes are written in the record fields of the same name (see LasFormat.h), the other ones as extra bytes.
+* The centering transfo is applied to x and y, which are stored as scaled integers.
+* The header (number of points, bounds, number of points by return) is completed by close().
+*
+*/
+class LasWriter
+{
+public:
+    /// creates filename for echoes with the attributes of lidarContainer (only its meta data is used)
+    /// pointFormat < 0: smallest point data record format having the las fields of the container
+    LasWriter(const std::string& filename, const LidarDataContainer& lidarContainer, const int pointFormat = -1);
+    ~LasWriter();
+
+    /// bounds of x, y, z of all the echoes to write (container coordinates), to choose the scale and offset of the coordinates
+    /// should be called before the first write, else the bounds of the first written echoes are used
+    void setBounds(const double min[3], const double max[3]);
+
+    /// append the echoes of lidarContainer (same attributes as the container given to the constructor)
+    void write(const LidarDataContainer& lidarContainer);
+
+    /// complete the header and close the file (also done by the destructor)
+    void close();
+
+    int pointFormat() const { return m_header.pointFormat; }
+    boost::uint64_t size() const { return m_header.nbPoints; }
+
+private:
+    std::string m_filename;
+    std::ofstream m_ofs;
+    LasHeader m_header;
+    unsigned int m_pointSize;
+
+    /// fields of the records to write (standard fields present in the container and extra bytes)
+    std::vector<LasPointField> m_fields;
+    /// centering transfo of x, y, z
+    double m_translation[3];
+    bool m_scaleOffsetSet;
+    /// bounds of the written coordinates (scaled)
+    double m_min[3], m_max[3];
+};
+
+} //namespace Lidar
+
+#endif /* LASWRITER_H_ */
@@ -55,6 +55,28 @@ void AsciiPLYArchiLidarFileIO::loadData(LidarDataContainer& lidarContainer, std:
     LoadPlyAsciiData(m_data_path, lidarContainer);
 }
 
+void AsciiPLYArchiLidarFileIO::openStream(const LidarDataContainer& lidarContainer, std::string filename)
+{
+    getPaths(lidarContainer,filename);
+    m_stream.reset(new std::ifstream(m_data_path.c_str()));
+    if(!m_stream->good()) throw std::logic_error(std::string(__FUNCTION__) + ": Failed to open " + m_data_path +"\n");
+    SkipPlyHeader(*m_stream);
+
+    m_streamSize = lidarContainer.getXmlStructure()->attributes().dataSize();
+    m_streamPosition = 0;
+}
+
+std::size_t AsciiPLYArchiLidarFileIO::readChunk(LidarDataContainer& lidarContainer, const std::size_t nbEchos)
+{
+    lidarContainer.resize(0);
+    const std::size_t n = ReadPlyAsciiEchoes(*m_stream, lidarContainer, std::min(nbEchos, m_streamSize - m_streamPosition));
+
+    m_streamPosition += n;
+    if(n < nbEchos)
+        m_streamSize = m_streamPosition;
+    return n;
+}
+
 void AsciiPLYArchiLidarFileIO::save(const LidarDataContainer& lidarContainer, std::string filename)
 {
     getPaths(lidarContainer, filename);
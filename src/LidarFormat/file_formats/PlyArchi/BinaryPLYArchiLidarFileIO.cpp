@@ -69,10 +69,34 @@ void BinaryPLYArchiLidarFileIO::loadData(LidarDataContainer& lidarContainer, std
     ply_ifs.seekg(-dataSize, std::ios::end);
     //std::cout << "Binary part starts at " << fileInBin.tellg() << std::endl;
     // lidarContainer.allocate(lidarMetaData.nbPoints_); // BV: do we need that ? works well without
-    ply_ifs.read(lidarContainer.rawData(), dataSize);
+    readRecords(ply_ifs, lidarContainer, 0, lidarContainer.size());
 }
 
 
+void BinaryPLYArchiLidarFileIO::openStream(const LidarDataContainer& lidarContainer, std::string filename)
+{
+    getPaths(lidarContainer, filename);
+    m_stream.reset(new std::ifstream(m_data_path.c_str(), std::ios::binary));
+    if(!m_stream->good()) throw std::logic_error(std::string(__FUNCTION__) + ": Failed to open " + m_data_path +"\n");
+
+    // same as loadData: the binary part is at the end of the file
+    m_streamSize = lidarContainer.getXmlStructure()->attributes().dataSize();
+    m_streamPosition = 0;
+    m_stream->seekg(-static_cast<std::streamoff>(m_streamSize*lidarContainer.pointSize()), std::ios::end);
+    if(!m_stream->good()) throw std::logic_error(std::string(__FUNCTION__) + ": " + m_data_path + " is smaller than what xml expects\n");
+    m_streamOffset = m_stream->tellg();
+}
+
+std::size_t BinaryPLYArchiLidarFileIO::readChunk(LidarDataContainer& lidarContainer, const std::size_t nbEchos)
+{
+    return readRecordsChunk(lidarContainer, nbEchos);
+}
+
+void BinaryPLYArchiLidarFileIO::seekStream(LidarDataContainer& lidarContainer, const std::size_t position)
+{
+    seekRecords(lidarContainer, position);
+}
+
 void BinaryPLYArchiLidarFileIO::save(const LidarDataContainer& lidarContainer, std::string filename)
 {
     getPaths(lidarContainer, filename);
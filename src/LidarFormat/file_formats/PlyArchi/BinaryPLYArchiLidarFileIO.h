@@ -51,6 +51,9 @@ class BinaryPLYArchiLidarFileIO : public LidarFileIO
 public:
     virtual ~BinaryPLYArchiLidarFileIO() {}
     virtual void loadData(LidarDataContainer& lidarContainer, std::string filename);
+    virtual void openStream(const LidarDataContainer& lidarContainer, std::string filename);
+    virtual std::size_t readChunk(LidarDataContainer& lidarContainer, const std::size_t nbEchos);
+    virtual void seekStream(LidarDataContainer& lidarContainer, const std::size_t position);
     virtual void save(const LidarDataContainer& lidarContainer, std::string filename);
 
     static bool Register();
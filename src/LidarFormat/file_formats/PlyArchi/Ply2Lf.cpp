@@ -6,6 +6,7 @@
 #include <sstream>
 #include <boost/filesystem.hpp>
 #include "LidarFormat/LidarFile.h"
+#include "LidarFormat/LidarDataBuilder.h"
 #include "Ply2Lf.h"
 
 using namespace std;
@@ -193,11 +194,30 @@ void LoadPlyAsciiData(const string& ply_filename,
     using namespace std;
     ifstream ply_ifs(ply_filename.c_str());
     if(!ply_ifs.good()) throw std::logic_error(std::string(__FUNCTION__) + ": Failed to open " + ply_filename +"\n");
-    string word="";
+    SkipPlyHeader(ply_ifs);
+    const std::size_t nbEchos = ldc.size();
+    ldc.resize(0);
+    ReadPlyAsciiEchoes(ply_ifs, ldc, nbEchos);
+}
+
+void SkipPlyHeader(std::istream& ply_ifs)
+{
+    std::string word="";
     while(!ply_ifs.eof() && word != "end_header") {ply_ifs >> word;}
+}
+
+std::size_t ReadPlyAsciiEchoes(std::istream& ply_ifs,
+                               Lidar::LidarDataContainer& ldc,
+                               const std::size_t nbEchos)
+{
+    using namespace std;
     AttributeMapType attrib_map = ldc.getAttributeMap();
-    for(LidarDataContainer::iterator it=ldc.begin(); it != ldc.end(); it++)
+    // values parsed directly in the container, resized once
+    LidarDataBuilder builder(ldc, nbEchos);
+    LidarAppendCursor it = builder.cursor();
+    while(!it.full() && ply_ifs.good())
     {
+        it.append();
         int old_decalage=-2, decalage=-1, ival=0;
         for(AttributeMapType::iterator it_att = attrib_map.begin(); it_att != attrib_map.end(); it_att++)
         {
@@ -219,7 +239,9 @@ void LoadPlyAsciiData(const string& ply_filename,
             default: cout << "Unknown data type " << it_att->second.dataType() << endl;
             }
         }
+        if(ply_ifs.fail()) it.pop_back();
     }
+    return builder.commit();
 }
 
 void SavePly(const LidarDataContainer& ldc,
@@ -250,34 +272,8 @@ void SavePly(const LidarDataContainer& ldc,
             fileOut << "comment IGN bounds " << min << " " << max << endl;
     }
     fileOut << "end_header" << endl;
-    if(binary) fileOut.write(ldc.rawData(), ldc.size() * ldc.pointSize());
-    else
-    {
-        AttributeMapType attrib_map = ldc.getAttributeMap();
-        for(LidarDataContainer::const_iterator it = ldc.begin(); it != ldc.end(); it++)
-        {
-            for(AttributeMapType::iterator it_att = attrib_map.begin(); it_att != attrib_map.end(); it_att++)
-            {
-                if(it_att != attrib_map.begin()) fileOut << " ";
-                int decalage = it_att->second.decalage;
-                switch(it_att->second.dataType())
-                {
-                case Lidar::LidarDataType::float32: ; fileOut.precision(9); fileOut << it.value<float32>(decalage); break;
-                case Lidar::LidarDataType::float64: fileOut.precision(15); fileOut << it.value<float64>(decalage); break;
-                case Lidar::LidarDataType::int8: fileOut << (int)it.value<int8>(decalage); break;
-                case Lidar::LidarDataType::int16: fileOut << (int)it.value<int16>(decalage); break;
-                case Lidar::LidarDataType::int32: fileOut << it.value<int32>(decalage); break;
-                case Lidar::LidarDataType::int64: fileOut << it.value<int64>(decalage); break;
-                case Lidar::LidarDataType::uint8: fileOut << (int)it.value<uint8>(decalage); break;
-                case Lidar::LidarDataType::uint16: fileOut << (int)it.value<uint16>(decalage); break;
-                case Lidar::LidarDataType::uint32: fileOut << it.value<uint32>(decalage); break;
-                case Lidar::LidarDataType::uint64: fileOut << it.value<uint64>(decalage); break;
-                default: cout << "Unknown data type " << it_att->second.dataType() << endl;
-                }
-            }
-            fileOut << endl;
-        }
-    }
+    if(binary) LidarFileIO::writeRecords(fileOut, ldc, 0, ldc.size());
+    else LidarFileIO::writeAsciiRecords(fileOut, ldc, ' ', false, 9, 15);
     fileOut.close();
 }
 
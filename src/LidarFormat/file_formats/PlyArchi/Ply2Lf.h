@@ -35,6 +35,14 @@ void ReadPly(const std::string& ply_filename,
 void LoadPlyAsciiData(const std::string& ply_filename,
                       Lidar::LidarDataContainer& ldc);
 
+/// skip the header of an opened ply file
+void SkipPlyHeader(std::istream& ply_ifs);
+
+/// append at most nbEchos echoes to the container from the current position of an ascii ply file, returns the number of echoes read
+std::size_t ReadPlyAsciiEchoes(std::istream& ply_ifs,
+                               Lidar::LidarDataContainer& ldc,
+                               const std::size_t nbEchos);
+
 /// save the container and centering as a ply file DEPRECATED
 void SavePly(const LidarDataContainer& container,
              const LidarCenteringTransfo& transfo,
@@ -0,0 +1,416 @@
+/***********************************************************************
+
+This file is part of the LidarFormat project source files.
+
+LidarFormat is an open source library for efficiently handling 3D point 
+clouds with a variable number of attributes at runtime. 
+
+
+Homepage: 
+
+    http://code.google.com/p/lidarformat
+
+Copyright:
+
+    Institut Geographique National & CEMAGREF (2009)
+
+Author: 
+
+    Adrien Chauve
+
+Contributors:
+
+    Nicolas David, Olivier Tournaire, Bruno Vallet
+
+
+
+    LidarFormat is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LidarFormat is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with LidarFormat.  If not, see <http://www.gnu.org/licenses/>.
+
+***********************************************************************/
+
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+#include <boost/bind.hpp>
+
+#include "LidarFormat/LidarDataContainer.h"
+#include "LidarFormat/apply.h"
+#include "LidarFormat/tools/AttributeBounds.h"
+#include "LidarFormat/tools/ParallelBlocks.h"
+#include "LidarFormat/tools/ValueConversion.h"
+
+#include "RecordFields.h"
+
+namespace Lidar
+{
+
+/// minimum number of records decoded by a thread
+static const std::size_t recordsBlockSize = 1 << 16;
+
+EnumLidarDataType getRecordFieldAttributeType(const RecordField& field)
+{
+    return field.scale != 0. ? LidarDataType::float64 : field.type;
+}
+
+unsigned int getRecordFieldTypeSize(const EnumLidarDataType type)
+{
+    switch(type)
+    {
+    case LidarDataType::int8:
+    case LidarDataType::uint8: return 1;
+    case LidarDataType::int16:
+    case LidarDataType::uint16: return 2;
+    case LidarDataType::int32:
+    case LidarDataType::uint32:
+    case LidarDataType::float32: return 4;
+    default: return 8;
+    }
+}
+
+/// centering transfo of the scaled fields x and y
+static double getFieldTranslation(const RecordField& field, const LidarDataContainer& lidarContainer)
+{
+    double x = 0., y = 0.;
+    if(field.scale == 0. || !lidarContainer.getCenteringTransfo(x, y))
+        return 0.;
+    return field.name == "x" ? x : field.name == "y" ? y : 0.;
+}
+
+
+/// decoder of a record field to an attribute of the container
+struct RecordFieldDecoder
+{
+    virtual ~RecordFieldDecoder() {}
+    /// decode the records [first, first+count[ of records to the echoes [first, first+count[
+    virtual void decode(const char* records, const unsigned int recordLength, const std::size_t first, const std::size_t count) const = 0;
+};
+
+typedef std::vector<boost::shared_ptr<RecordFieldDecoder> > RecordFieldDecoders;
+
+/// whole value of type L
+template<typename T, typename L>
+struct TRecordValueDecoder : public RecordFieldDecoder
+{
+    TRecordValueDecoder(const LidarIteratorAttribute<T>& begin, const unsigned int offset): m_begin(begin), m_offset(offset) {}
+
+    void decode(const char* records, const unsigned int recordLength, const std::size_t first, const std::size_t count) const
+    {
+        LidarIteratorAttribute<T> it = m_begin + first;
+        const char* field = records + first*recordLength + m_offset;
+        for(std::size_t i = 0; i < count; ++i, ++it, field += recordLength)
+        {
+            L value;
+            std::memcpy(&value, field, sizeof(L));
+            *it = static_cast<T>(value);
+        }
+    }
+
+    LidarIteratorAttribute<T> m_begin;
+    unsigned int m_offset;
+};
+
+/// value of type L, scaled: value*scale + offset
+template<typename T, typename L>
+struct TRecordScaledDecoder : public RecordFieldDecoder
+{
+    TRecordScaledDecoder(const LidarIteratorAttribute<T>& begin, const unsigned int offset, const double scale, const double valueOffset):
+        m_begin(begin), m_offset(offset), m_scale(scale), m_valueOffset(valueOffset) {}
+
+    void decode(const char* records, const unsigned int recordLength, const std::size_t first, const std::size_t count) const
+    {
+        LidarIteratorAttribute<T> it = m_begin + first;
+        const char* field = records + first*recordLength + m_offset;
+        for(std::size_t i = 0; i < count; ++i, ++it, field += recordLength)
+        {
+            L value;
+            std::memcpy(&value, field, sizeof(L));
+            *it = static_cast<T>(value*m_scale + m_valueOffset);
+        }
+    }
+
+    LidarIteratorAttribute<T> m_begin;
+    unsigned int m_offset;
+    double m_scale, m_valueOffset;
+};
+
+/// bit field of an unsigned value of type L
+template<typename T, typename L>
+struct TRecordBitsDecoder : public RecordFieldDecoder
+{
+    TRecordBitsDecoder(const LidarIteratorAttribute<T>& begin, const RecordField& field): m_begin(begin), m_field(field) {}
+
+    void decode(const char* records, const unsigned int recordLength, const std::size_t first, const std::size_t count) const
+    {
+        LidarIteratorAttribute<T> it = m_begin + first;
+        const char* field = records + first*recordLength + m_field.offset;
+        const L mask = static_cast<L>((1u << m_field.nbBits) - 1);
+        for(std::size_t i = 0; i < count; ++i, ++it, field += recordLength)
+        {
+            L value;
+            std::memcpy(&value, field, sizeof(L));
+            *it = static_cast<T>((value >> m_field.shift) & mask);
+        }
+    }
+
+    LidarIteratorAttribute<T> m_begin;
+    RecordField m_field;
+};
+
+template<typename T, typename L>
+static RecordFieldDecoder* createRecordValueDecoder(const LidarIteratorAttribute<T>& begin, const RecordField& field, const double translation)
+{
+    if(field.scale != 0.)
+        return new TRecordScaledDecoder<T, L>(begin, field.offset, field.scale, field.valueOffset - translation);
+    return new TRecordValueDecoder<T, L>(begin, field.offset);
+}
+
+template<EnumLidarDataType T>
+struct CreateRecordFieldDecoderFunctor
+{
+    typedef typename LidarEnumTypeTraits<T>::type AttributeType;
+
+    RecordFieldDecoder* operator()(LidarDataContainer& lidarContainer, const RecordField& field)
+    {
+        const LidarIteratorAttribute<AttributeType> begin = lidarContainer.beginAttribute<AttributeType>(field.name);
+        const double translation = getFieldTranslation(field, lidarContainer);
+        if(field.nbBits > 0)
+        {
+            if(field.type == LidarDataType::uint16)
+                return new TRecordBitsDecoder<AttributeType, uint16>(begin, field);
+            return new TRecordBitsDecoder<AttributeType, uint8>(begin, field);
+        }
+
+        switch(field.type)
+        {
+        case LidarDataType::int8: return createRecordValueDecoder<AttributeType, int8>(begin, field, translation);
+        case LidarDataType::uint8: return createRecordValueDecoder<AttributeType, uint8>(begin, field, translation);
+        case LidarDataType::int16: return createRecordValueDecoder<AttributeType, int16>(begin, field, translation);
+        case LidarDataType::uint16: return createRecordValueDecoder<AttributeType, uint16>(begin, field, translation);
+        case LidarDataType::int32: return createRecordValueDecoder<AttributeType, int32>(begin, field, translation);
+        case LidarDataType::uint32: return createRecordValueDecoder<AttributeType, uint32>(begin, field, translation);
+        case LidarDataType::int64: return createRecordValueDecoder<AttributeType, int64>(begin, field, translation);
+        case LidarDataType::uint64: return createRecordValueDecoder<AttributeType, uint64>(begin, field, translation);
+        case LidarDataType::float32: return createRecordValueDecoder<AttributeType, float32>(begin, field, translation);
+        case LidarDataType::float64: return createRecordValueDecoder<AttributeType, float64>(begin, field, translation);
+        }
+        throw std::logic_error("decodeRecords: unknown type for " + field.name + "\n");
+    }
+};
+
+/// records [first, first+count[ decoded by a thread
+static void decodeRecordsBlock(const RecordFieldDecoders& decoders, const char* records, const unsigned int recordLength,
+                               const std::size_t first, const std::size_t count)
+{
+    for(RecordFieldDecoders::const_iterator decoder = decoders.begin(); decoder != decoders.end(); ++decoder)
+        (*decoder)->decode(records, recordLength, first, count);
+}
+
+void decodeRecords(const char* records, const unsigned int recordLength, const std::vector<RecordField>& fields, LidarDataContainer& lidarContainer)
+{
+    RecordFieldDecoders decoders;
+    for(AttributeMapType::const_iterator it = lidarContainer.getAttributeMap().begin(); it != lidarContainer.getAttributeMap().end(); ++it)
+    {
+        std::vector<RecordField>::const_iterator field = fields.begin();
+        while(field != fields.end() && field->name != it->first)
+            ++field;
+        if(field == fields.end())
+            throw std::logic_error("decodeRecords: no field " + it->first + " in the records\n");
+
+        decoders.push_back(boost::shared_ptr<RecordFieldDecoder>(
+                               apply<CreateRecordFieldDecoderFunctor, RecordFieldDecoder*, LidarDataContainer&, const RecordField&>(
+                                   it->second.dataType(), lidarContainer, *field)));
+    }
+
+    parallelForBlocks(lidarContainer.size(), recordsBlockSize, boost::bind(&decodeRecordsBlock, boost::cref(decoders), records, recordLength, _2, _3));
+}
+
+
+/// encoder of a record field from an attribute of the container
+struct RecordFieldEncoder
+{
+    explicit RecordFieldEncoder(const std::string& name): m_name(name) {}
+    virtual ~RecordFieldEncoder() {}
+    /// encode the values of the echoes [first, first+count[ in consecutive records
+    virtual void encode(char* records, const unsigned int recordLength, const std::size_t first, const std::size_t count) = 0;
+    /// bounds of the encoded values (scaled fields)
+    virtual void getBounds(double& /*min*/, double& /*max*/) const {}
+
+    std::string m_name;
+};
+
+/// whole value of type L (values out of the range of L throw)
+template<typename T, typename L>
+struct TRecordValueEncoder : public RecordFieldEncoder
+{
+    TRecordValueEncoder(const LidarConstIteratorAttribute<T>& begin, const RecordField& field):
+        RecordFieldEncoder(field.name), m_begin(begin), m_offset(field.offset) {}
+
+    void encode(char* records, const unsigned int recordLength, const std::size_t first, const std::size_t count)
+    {
+        LidarConstIteratorAttribute<T> it = m_begin + first;
+        char* field = records + m_offset;
+        for(std::size_t i = 0; i < count; ++i, ++it, field += recordLength)
+        {
+            L value;
+            if(!convertValue(*it, value))
+                throw std::logic_error("RecordsEncoder: " + m_name + " out of the range of its field\n");
+            std::memcpy(field, &value, sizeof(L));
+        }
+    }
+
+    LidarConstIteratorAttribute<T> m_begin;
+    unsigned int m_offset;
+};
+
+/// bit field of an unsigned value of type L
+template<typename T, typename L>
+struct TRecordBitsEncoder : public RecordFieldEncoder
+{
+    TRecordBitsEncoder(const LidarConstIteratorAttribute<T>& begin, const RecordField& field):
+        RecordFieldEncoder(field.name), m_begin(begin), m_field(field) {}
+
+    void encode(char* records, const unsigned int recordLength, const std::size_t first, const std::size_t count)
+    {
+        LidarConstIteratorAttribute<T> it = m_begin + first;
+        char* field = records + m_field.offset;
+        for(std::size_t i = 0; i < count; ++i, ++it, field += recordLength)
+        {
+            const boost::uint64_t value = static_cast<boost::uint64_t>(*it);
+            if(value >> m_field.nbBits)
+                throw std::logic_error("RecordsEncoder: " + m_field.name + " does not fit in its field\n");
+            L bits;
+            std::memcpy(&bits, field, sizeof(L));
+            bits |= static_cast<L>(value << m_field.shift);
+            std::memcpy(field, &bits, sizeof(L));
+        }
+    }
+
+    LidarConstIteratorAttribute<T> m_begin;
+    RecordField m_field;
+};
+
+/// value of type L = (attribute + translation - valueOffset)/scale, with the bounds of the encoded values
+template<typename T, typename L>
+struct TRecordScaledEncoder : public RecordFieldEncoder
+{
+    TRecordScaledEncoder(const LidarConstIteratorAttribute<T>& begin, const RecordField& field, const double translation):
+        RecordFieldEncoder(field.name), m_begin(begin), m_offset(field.offset), m_scale(field.scale), m_valueOffset(field.valueOffset - translation),
+        m_min(std::numeric_limits<double>::max()), m_max(-std::numeric_limits<double>::max()) {}
+
+    void encode(char* records, const unsigned int recordLength, const std::size_t first, const std::size_t count)
+    {
+        LidarConstIteratorAttribute<T> it = m_begin + first;
+        char* field = records + m_offset;
+        for(std::size_t i = 0; i < count; ++i, ++it, field += recordLength)
+        {
+            const double value = std::floor((static_cast<double>(*it) - m_valueOffset) / m_scale + 0.5);
+            if(!(value >= std::numeric_limits<L>::min() && value <= std::numeric_limits<L>::max()))
+                throw std::logic_error("RecordsEncoder: " + m_name + " out of the range of its scale and offset\n");
+            if(value < m_min) m_min = value;
+            if(value > m_max) m_max = value;
+            const L scaled = static_cast<L>(value);
+            std::memcpy(field, &scaled, sizeof(L));
+        }
+    }
+
+    void getBounds(double& min, double& max) const
+    {
+        min = std::min(min, m_min);
+        max = std::max(max, m_max);
+    }
+
+    LidarConstIteratorAttribute<T> m_begin;
+    unsigned int m_offset;
+    double m_scale, m_valueOffset;
+    double m_min, m_max;
+};
+
+template<typename T, typename L>
+static RecordFieldEncoder* createRecordValueEncoder(const LidarConstIteratorAttribute<T>& begin, const RecordField& field, const double translation)
+{
+    if(field.scale != 0.)
+        return new TRecordScaledEncoder<T, L>(begin, field, translation);
+    return new TRecordValueEncoder<T, L>(begin, field);
+}
+
+template<EnumLidarDataType T>
+struct CreateRecordFieldEncoderFunctor
+{
+    typedef typename LidarEnumTypeTraits<T>::type AttributeType;
+
+    RecordFieldEncoder* operator()(const LidarDataContainer& lidarContainer, const RecordField& field)
+    {
+        const LidarConstIteratorAttribute<AttributeType> begin = lidarContainer.beginAttribute<AttributeType>(field.name);
+        const double translation = getFieldTranslation(field, lidarContainer);
+        if(field.nbBits > 0)
+        {
+            if(field.type == LidarDataType::uint16)
+                return new TRecordBitsEncoder<AttributeType, uint16>(begin, field);
+            return new TRecordBitsEncoder<AttributeType, uint8>(begin, field);
+        }
+
+        switch(field.type)
+        {
+        case LidarDataType::int8: return createRecordValueEncoder<AttributeType, int8>(begin, field, translation);
+        case LidarDataType::uint8: return createRecordValueEncoder<AttributeType, uint8>(begin, field, translation);
+        case LidarDataType::int16: return createRecordValueEncoder<AttributeType, int16>(begin, field, translation);
+        case LidarDataType::uint16: return createRecordValueEncoder<AttributeType, uint16>(begin, field, translation);
+        case LidarDataType::int32: return createRecordValueEncoder<AttributeType, int32>(begin, field, translation);
+        case LidarDataType::uint32: return createRecordValueEncoder<AttributeType, uint32>(begin, field, translation);
+        case LidarDataType::int64: return createRecordValueEncoder<AttributeType, int64>(begin, field, translation);
+        case LidarDataType::uint64: return createRecordValueEncoder<AttributeType, uint64>(begin, field, translation);
+        case LidarDataType::float32: return createRecordValueEncoder<AttributeType, float32>(begin, field, translation);
+        case LidarDataType::float64: return createRecordValueEncoder<AttributeType, float64>(begin, field, translation);
+        }
+        throw std::logic_error("RecordsEncoder: unknown type for " + field.name + "\n");
+    }
+};
+
+void getAttributeMinMax(const LidarDataContainer& lidarContainer, const std::string& name, double& min, double& max)
+{
+    if(lidarContainer.getAttributeMap().find(name) == lidarContainer.getAttributeMap().end() || lidarContainer.size() == 0)
+        return;
+    std::vector<AttributeBoundValues> bounds;
+    computeAttributeBounds(lidarContainer, std::vector<std::string>(1, name), bounds);
+    if(bounds[0].min < min) min = bounds[0].min;
+    if(bounds[0].max > max) max = bounds[0].max;
+}
+
+RecordsEncoder::RecordsEncoder(const std::vector<RecordField>& fields, const LidarDataContainer& lidarContainer)
+{
+    for(std::vector<RecordField>::const_iterator field = fields.begin(); field != fields.end(); ++field)
+        if(lidarContainer.getAttributeMap().find(field->name) != lidarContainer.getAttributeMap().end())
+            m_encoders.push_back(boost::shared_ptr<RecordFieldEncoder>(
+                                     apply<CreateRecordFieldEncoderFunctor, RecordFieldEncoder*, const LidarDataContainer&, const RecordField&>(
+                                         lidarContainer.getAttributeType(field->name), lidarContainer, *field)));
+}
+
+void RecordsEncoder::encode(char* records, const unsigned int recordLength, const std::size_t first, const std::size_t count)
+{
+    for(std::vector<boost::shared_ptr<RecordFieldEncoder> >::iterator encoder = m_encoders.begin(); encoder != m_encoders.end(); ++encoder)
+        (*encoder)->encode(records, recordLength, first, count);
+}
+
+void RecordsEncoder::getScaledBounds(const std::string& name, double& min, double& max) const
+{
+    for(std::vector<boost::shared_ptr<RecordFieldEncoder> >::const_iterator encoder = m_encoders.begin(); encoder != m_encoders.end(); ++encoder)
+        if((*encoder)->m_name == name)
+            (*encoder)->getBounds(min, max);
+}
+
+} //namespace Lidar
@@ -0,0 +1,117 @@
+/***********************************************************************
+
+This file is part of the LidarFormat project source files.
+
+LidarFormat is an open source library for efficiently handling 3D point 
+clouds with a variable number of attributes at runtime. 
+
+
+Homepage: 
+
+    http://code.google.com/p/lidarformat
+
+Copyright:
+
+    Institut Geographique National & CEMAGREF (2009)
+
+Author: 
+
+    Adrien Chauve
+
+Contributors:
+
+    Nicolas David, Olivier Tournaire, Bruno Vallet
+
+
+
+    LidarFormat is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LidarFormat is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with LidarFormat.  If not, see <http://www.gnu.org/licenses/>.
+
+***********************************************************************/
+
+
+
+#ifndef RECORDFIELDS_H_
+#define RECORDFIELDS_H_
+
+#include <string>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include "LidarFormat/LidarDataFormatTypes.h"
+
+namespace Lidar
+{
+
+class LidarDataContainer;
+
+/// a field of the fixed size binary records of a file format (las, terrabin), stored in the attribute of the same name
+struct RecordField
+{
+    RecordField(const std::string& name_, const EnumLidarDataType type_, const unsigned int offset_,
+                const unsigned int shift_ = 0, const unsigned int nbBits_ = 0):
+        name(name_), type(type_), offset(offset_), shift(shift_), nbBits(nbBits_), scale(0.), valueOffset(0.) {}
+
+    std::string name;
+    /// type of the value in the record (and of the attribute)
+    EnumLidarDataType type;
+    /// offset in the record
+    unsigned int offset;
+    /// bit fields: nbBits bits starting at bit shift of the (unsigned) value (nbBits == 0 for whole values)
+    unsigned int shift, nbBits;
+    /// scaled fields (coordinates stored as integers): attribute = value*scale + valueOffset, scale == 0 otherwise
+    double scale, valueOffset;
+};
+
+/// type of the attribute of a field: float64 for scaled fields, type of the value otherwise
+EnumLidarDataType getRecordFieldAttributeType(const RecordField& field);
+
+/// size in bytes of the values of a type
+unsigned int getRecordFieldTypeSize(const EnumLidarDataType type);
+
+/// decode count records in the attributes of lidarContainer (a subset of fields), to the echoes [0, count[ of the container
+/// blocks of records are decoded on several threads, the centering transfo of the container is applied to the scaled fields x and y
+void decodeRecords(const char* records, const unsigned int recordLength, const std::vector<RecordField>& fields, LidarDataContainer& lidarContainer);
+
+/// extends [min, max] to the values of an attribute of lidarContainer (unchanged if it has no attribute name)
+/// (to choose the scale and offset of the scaled fields, without modifying a const container)
+void getAttributeMinMax(const LidarDataContainer& lidarContainer, const std::string& name, double& min, double& max);
+
+struct RecordFieldEncoder;
+
+/**
+* @brief Encodes echoes of a container in records (fields of the records that are attributes of the container)
+*
+* The types are resolved once at construction, not for each value. Values that do not fit in their field throw.
+* The centering transfo of the container is applied to the scaled fields x and y.
+*
+*/
+class RecordsEncoder
+{
+public:
+    RecordsEncoder(const std::vector<RecordField>& fields, const LidarDataContainer& lidarContainer);
+
+    /// encode the echoes [first, first+count[ in consecutive records (bits fields are or'ed: records should be initialized to 0)
+    void encode(char* records, const unsigned int recordLength, const std::size_t first, const std::size_t count);
+
+    /// bounds of the encoded values of the scaled field named name (unchanged if none)
+    void getScaledBounds(const std::string& name, double& min, double& max) const;
+
+private:
+    std::vector<boost::shared_ptr<RecordFieldEncoder> > m_encoders;
+};
+
+} //namespace Lidar
+
+#endif /* RECORDFIELDS_H_ */
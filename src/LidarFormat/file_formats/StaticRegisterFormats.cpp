@@ -47,9 +47,7 @@ Contributors:
 #ifdef ENABLE_TERRABIN
 #include "LidarFormat/file_formats/TerraBin/TerraBINLidarFileIO.h"
 #endif // ENABLE_TERRABIN
-#ifdef ENABLE_LAS
 #include "LidarFormat/file_formats/LAS/LasIO.h"
-#endif // ENABLE_LAS
 
 void registerAllFileFormats()
 {
@@ -64,8 +62,6 @@ void registerAllFileFormats()
     TerraBINLidarFileIO::Register();
     TerraBINMetaDataIO::Register();
 #endif // ENABLE_TERRABIN
-#ifdef ENABLE_LAS
     LasIO::Register();
     LasMetaDataIO::Register();
-#endif // ENABLE_LAS
 }
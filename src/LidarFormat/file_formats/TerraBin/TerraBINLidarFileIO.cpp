@@ -43,6 +43,17 @@ Contributors:
  * \author Frederic Bretar
  */
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+#include <boost/filesystem.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
 #include "LidarFormat/extern/terrabin/TerraBin.h"
 
 #include "LidarFormat/LidarIOFactory.h"
@@ -54,41 +65,89 @@ using namespace std;
 namespace Lidar
 {
 
-boost::shared_ptr<cs::LidarDataType> TerraBINMetaDataIO::load(const string& filename)
+/// number of records encoded at once
+static const std::size_t terraBinRecordsBlockSize = 1 << 16;
+
+/// fields of the records of a TerraScan binary file, returns the record length
+/// x, y, z are scaled fields: (X - Org)/Units
+static unsigned int getTerraBinFields(const TerraScanHeader& header, std::vector<RecordField>& fields)
 {
-    //	ifstream fileIn(lidarMetaData.binaryDataFileName_.c_str());
+    if(header.Units <= 0)
+        throw logic_error("TerraBIN: invalid number of units per meter\n");
 
-    //	if(!fileIn.good())
-    //		throw logic_error("Erreur au chargement du fichier dans TerraBINFileReader::loadData : le fichier n'existe pas ou n'est pas accessible en lecture ! \n");
+    fields.clear();
+    unsigned int recordLength;
+    if(header.HdrVersion == 20020715) // TerraScanPnt
+    {
+        fields.push_back(RecordField("x", LidarDataType::int32, 0));
+        fields.push_back(RecordField("y", LidarDataType::int32, 4));
+        fields.push_back(RecordField("z", LidarDataType::int32, 8));
+        fields.push_back(RecordField("classification", LidarDataType::uint8, 12));
+        fields.push_back(RecordField("returnNumber", LidarDataType::uint8, 13));
+        fields.push_back(RecordField("flag", LidarDataType::uint8, 14));
+        fields.push_back(RecordField("mark", LidarDataType::uint8, 15));
+        fields.push_back(RecordField("line", LidarDataType::uint16, 16));
+        fields.push_back(RecordField("intensity", LidarDataType::uint16, 18));
+        recordLength = sizeof(TerraScanPnt);
+    }
+    else // TerraScanRow: intensity bits 0-13, echo bits 14-15
+    {
+        fields.push_back(RecordField("x", LidarDataType::int32, 4));
+        fields.push_back(RecordField("y", LidarDataType::int32, 8));
+        fields.push_back(RecordField("z", LidarDataType::int32, 12));
+        fields.push_back(RecordField("classification", LidarDataType::uint8, 0));
+        fields.push_back(RecordField("line", LidarDataType::uint8, 1));
+        fields.push_back(RecordField("intensity", LidarDataType::uint16, 2, 0, 14));
+        fields.push_back(RecordField("returnNumber", LidarDataType::uint16, 2, 14, 2));
+        recordLength = sizeof(TerraScanRow);
+    }
+
+    const double origin[3] = {header.OrgX, header.OrgY, header.OrgZ};
+    for(int i = 0; i < 3; ++i)
+    {
+        fields[i].scale = 1. / header.Units;
+        fields[i].valueOffset = -origin[i] / header.Units;
+    }
 
-    cout.precision(12);
+    // 32 bit time stamps and RGB colors (4 bytes) appended to the records
+    if(header.Time)
+    {
+        fields.push_back(RecordField("time", LidarDataType::uint32, recordLength));
+        recordLength += sizeof(UINT);
+    }
+    if(header.Color)
+    {
+        fields.push_back(RecordField("red", LidarDataType::uint8, recordLength));
+        fields.push_back(RecordField("green", LidarDataType::uint8, recordLength + 1));
+        fields.push_back(RecordField("blue", LidarDataType::uint8, recordLength + 2));
+        recordLength += 4;
+    }
+    return recordLength;
+}
 
-    //********
-    //lecture du Header
-    TerraScanHeader myheader;
-    ScanGetHeader(&myheader, filename.c_str());
+static TerraScanHeader readTerraBinHeader(const string& filename)
+{
+    TerraScanHeader header;
+    const int ok = ScanGetHeader(&header, filename.c_str());
+    if(ok == 0) throw logic_error("TerraBIN: Failed to open " + filename + "\n");
+    if(ok < 0) throw logic_error("TerraBIN: " + filename + " is not a TerraScan binary file\n");
+    return header;
+}
 
+boost::shared_ptr<cs::LidarDataType> TerraBINMetaDataIO::load(const string& filename)
+{
+    const TerraScanHeader header = readTerraBinHeader(filename);
     cout<< " Format TerraBIN "<<endl;
-    //	cout<< "   HdrSize="<<myheader.HdrSize<<endl;
-    cout<< "   HdrVersion="<<myheader.HdrVersion<<endl;
-    cout<< "   NbPoints="<<myheader.PntCnt<<endl;
-    //	cout<< "   OrgX="<<myheader.OrgX<<endl;
-    //	cout<< "   OrgY="<<myheader.OrgY<<endl;
-    //	cout<< "   OrgZ="<<myheader.OrgZ<<endl;
-    //	cout<< "   Units="<<myheader.Units<<endl;
+    cout<< "   HdrVersion="<<header.HdrVersion<<endl;
+    cout<< "   NbPoints="<<header.PntCnt<<endl;
 
-    cout << "Taille struct : " << sizeof(TerraRgbClr) << endl;
+    std::vector<RecordField> fields;
+    getTerraBinFields(header, fields);
 
-    cs::LidarDataType::AttributesType attributes(myheader.PntCnt, cs::DataFormatType::terrabin);
+    cs::LidarDataType::AttributesType attributes(header.PntCnt, cs::DataFormatType::terrabin);
     attributes.dataFileName() = filename;
-    // attributes.centeringTransfo(cs::CenteringTransfoType(tx, ty)); // TODO: handle centering
-    // TODO: handle various versions and user fields
-    attributes.attribute().push_back(cs::AttributeContainerType::AttributeType(LidarDataType::float64, "x"));
-    attributes.attribute().push_back(cs::AttributeContainerType::AttributeType(LidarDataType::float64, "y"));
-    attributes.attribute().push_back(cs::AttributeContainerType::AttributeType(LidarDataType::float64, "z"));
-    attributes.attribute().push_back(cs::AttributeContainerType::AttributeType(LidarDataType::int32, "intensity"));
-    attributes.attribute().push_back(cs::AttributeContainerType::AttributeType(LidarDataType::int32, "returnNumber"));
-    attributes.attribute().push_back(cs::AttributeContainerType::AttributeType(LidarDataType::int32, "line"));
+    for(std::vector<RecordField>::const_iterator field = fields.begin(); field != fields.end(); ++field)
+        attributes.attribute().push_back(cs::AttributeContainerType::AttributeType(getRecordFieldAttributeType(*field), field->name));
 
     boost::shared_ptr<cs::LidarDataType> xmlStructure(new cs::LidarDataType(attributes));
     return xmlStructure;
@@ -103,97 +162,133 @@ bool TerraBINMetaDataIO::Register()
 {
     // BV: I don't know what is the extention for TerraBIN
     MetaDataIOFactory::instance().Register(".TerraBIN", createTerraBINMetaDataReader);
+    // extention used by TerraBINLidarFileIO::save
+    MetaDataIOFactory::instance().Register(".terrabin", createTerraBINMetaDataReader);
     return true;
 }
 
 bool TerraBINMetaDataIO::m_isRegistered = TerraBINMetaDataIO::Register();
 
 
-TerraBINLidarFileIO::TerraBINLidarFileIO():LidarFileIO(".terrabin")
+TerraBINLidarFileIO::TerraBINLidarFileIO():LidarFileIO(".terrabin"), m_recordLength(0), m_dataOffset(0)
 {
-    // TODO Auto-generated constructor stub
-
 }
 
 TerraBINLidarFileIO::~TerraBINLidarFileIO()
 {
-    // TODO Auto-generated destructor stub
+}
+
+void TerraBINLidarFileIO::openStream(const LidarDataContainer& lidarContainer, std::string filename)
+{
+    getPaths(lidarContainer, filename);
+    const TerraScanHeader header = readTerraBinHeader(m_data_path);
+    m_recordLength = getTerraBinFields(header, m_fields);
+    m_dataOffset = header.HdrSize;
+
+    // only the complete records
+    const boost::uintmax_t fileSize = boost::filesystem::file_size(m_data_path);
+    const std::size_t nbRecords = fileSize > m_dataOffset ? (fileSize - m_dataOffset) / m_recordLength : 0;
+    m_streamSize = std::min<std::size_t>(std::max(header.PntCnt, 0), nbRecords);
+    m_streamPosition = 0;
+}
+
+std::size_t TerraBINLidarFileIO::readChunk(LidarDataContainer& lidarContainer, const std::size_t nbEchos)
+{
+    using namespace boost::interprocess;
+
+    const std::size_t n = std::min(nbEchos, m_streamSize - m_streamPosition);
+    lidarContainer.resize(n);
+    if(n == 0)
+        return 0;
+
+    file_mapping file(m_data_path.c_str(), read_only);
+    mapped_region region(file, read_only, m_dataOffset + boost::uint64_t(m_streamPosition)*m_recordLength, n*m_recordLength);
+    decodeRecords(static_cast<const char*>(region.get_address()), m_recordLength, m_fields, lidarContainer);
+
+    m_streamPosition += n;
+    return n;
+}
+
+void TerraBINLidarFileIO::seekStream(LidarDataContainer& lidarContainer, const std::size_t position)
+{
+    m_streamPosition = std::min(position, m_streamSize);
 }
 
 void TerraBINLidarFileIO::loadData(LidarDataContainer& lidarContainer, std::string filename)
 {
-    // read the header again (there is some specific info in it not handles by TerraBINMetaDataIO::load())
-
-    TerraScanHeader myheader;
-    ScanGetHeader(&myheader, filename.c_str());
-
-    //*******
-    //lexture du .bin
-    //	TerraScanPnt  * data = new TerraScanPnt[myheader.PntCnt*sizeof(TerraScanPnt)];
-    //	TerraRgbClr * Clr= new TerraRgbClr[myheader.PntCnt*sizeof(TerraScanPnt)];
-    //	unsigned int * sec= new unsigned int[myheader.PntCnt*sizeof(unsigned int)];
-    vector<TerraScanPnt> data(lidarContainer.size());
-    vector<TerraRgbClr> Clr(lidarContainer.size());
-    vector<unsigned int > sec(lidarContainer.size());
-    ScanReadBinary(&data[0], &sec[0], &Clr[0], lidarContainer.size(), filename.c_str());
-
-    // fill the container
-    int decalage_x = lidarContainer.getDecalage("x");
-    int decalage_y = lidarContainer.getDecalage("y");
-    int decalage_z = lidarContainer.getDecalage("z");
-    int decalage_intensity = lidarContainer.getDecalage("intensity");
-    int decalage_echo = lidarContainer.getDecalage("returnNumber");
-    int decalage_line = lidarContainer.getDecalage("line");
-
-    //parcours du data et recopie dans un lidarEcho.
-    LidarEcho echo = lidarContainer.createEcho();
-    const LidarIteratorEcho begin = lidarContainer.begin();
-    for (unsigned int i=0; i<(unsigned int)lidarContainer.size(); ++i)
+    openStream(lidarContainer, filename);
+    if(m_streamSize != lidarContainer.size())
     {
-        //lecture d'un record de TerraScanPnt
-        //	X = (Pnt.X - Hdr.OrgX) / (double) Hdr.Units ;
-        //	Y = (Pnt.Y - Hdr.OrgY) / (double) Hdr.Units ;
-        //	Z = (Pnt.Z - Hdr.OrgZ) / (double) Hdr.Units ;
-
-        if(decalage_x>-1)
-        {
-            double X = ((double)data[i].Pnt.x - myheader.OrgX) / (double) myheader.Units ;
-            echo.value<double>(decalage_x)=X;
-        }
-        if(decalage_y>-1)
-        {
-            double Y = ((double)data[i].Pnt.y - myheader.OrgY) / (double) myheader.Units ;
-            echo.value<double>(decalage_y)=Y;
-        }
-        if(decalage_z>-1)
-        {
-            double Z = ((double)data[i].Pnt.z - myheader.OrgZ) / (double) myheader.Units ;
-            echo.value<double>(decalage_z)=Z;
-        }
-
-        if(decalage_intensity>-1)
-            echo.value<short>(decalage_intensity)=data[i].Intensity;
-
-
-        //		0 Only echo
-        //		1 First of many echo
-        //		2 Intermediate echo
-        //		3 Last of many echo
-        if(decalage_echo>-1)
-            echo.value<short>(decalage_echo)=data[i].Echo;
-
-        if(decalage_line>-1)
-            echo.value<short>(decalage_line)=data[i].Line;
-
-        *(begin+i) = echo;
+        cout << __FILE__ << ":" << __LINE__ << ": WARNING: " << m_data_path << " has " << m_streamSize <<
+                " points instead of " << lidarContainer.size() << "->fixing container" << endl;
+        lidarContainer.getXmlStructure()->attributes().dataSize(m_streamSize);
     }
+    readChunk(lidarContainer, m_streamSize);
 }
 
-
 void TerraBINLidarFileIO::save(const LidarDataContainer& lidarContainer, std::string filename)
 {
-    // TODO: write a terra bin using container and xml structure
-    throw logic_error("Not Implemented ! \n");
+    getPaths(lidarContainer, filename);
+    if(lidarContainer.size() > std::size_t(std::numeric_limits<int>::max()))
+        throw logic_error("TerraBIN: too many points\n");
+
+    TerraScanHeader header;
+    std::memset(&header, 0, sizeof(header));
+    header.HdrSize = sizeof(header);
+    header.HdrVersion = 20020715;
+    header.Tunniste = 970401;
+    std::memcpy(header.Magic, "CXYZ", 4);
+    header.PntCnt = lidarContainer.size();
+    const AttributeMapType& attributes = lidarContainer.getAttributeMap();
+    header.Time = attributes.find("time") != attributes.end();
+    header.Color = attributes.find("red") != attributes.end() || attributes.find("green") != attributes.end() || attributes.find("blue") != attributes.end();
+
+    // integer coordinates with an integer origin in meters, millimetric unless the extent does not fit
+    static const char* coordinateNames[] = {"x", "y", "z"};
+    double translation[3] = {0., 0., 0.}, min[3], max[3];
+    lidarContainer.getCenteringTransfo(translation[0], translation[1]);
+    header.Units = 1000;
+    for(int i = 0; i < 3; ++i)
+    {
+        min[i] = std::numeric_limits<double>::max();
+        max[i] = -std::numeric_limits<double>::max();
+        getAttributeMinMax(lidarContainer, coordinateNames[i], min[i], max[i]);
+        if(min[i] > max[i])
+            min[i] = max[i] = 0.;
+        min[i] = std::floor(min[i] + translation[i]);
+        max[i] += translation[i];
+        while(header.Units > 1 && (max[i] - min[i]) * header.Units > std::numeric_limits<int>::max())
+            header.Units /= 10;
+    }
+    header.OrgX = -min[0] * header.Units;
+    header.OrgY = -min[1] * header.Units;
+    header.OrgZ = -min[2] * header.Units;
+
+    std::vector<RecordField> fields;
+    const unsigned int recordLength = getTerraBinFields(header, fields);
+    for(AttributeMapType::const_iterator it = attributes.begin(); it != attributes.end(); ++it)
+    {
+        std::vector<RecordField>::const_iterator field = fields.begin();
+        while(field != fields.end() && field->name != it->first)
+            ++field;
+        if(field == fields.end())
+            cout << "TerraBIN: WARNING: attribute " << it->first << " can not be saved in " << m_data_path << endl;
+    }
+
+    ofstream ofs(m_data_path.c_str(), ios::binary);
+    if(!ofs.good()) throw logic_error("TerraBIN: Failed to open " + m_data_path + "\n");
+    ofs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    RecordsEncoder encoder(fields, lidarContainer);
+    std::vector<char> records(std::min(lidarContainer.size(), terraBinRecordsBlockSize)*recordLength);
+    for(std::size_t first = 0; first < lidarContainer.size(); first += terraBinRecordsBlockSize)
+    {
+        const std::size_t count = std::min(lidarContainer.size() - first, terraBinRecordsBlockSize);
+        std::fill(records.begin(), records.begin() + count*recordLength, 0);
+        encoder.encode(&records[0], recordLength, first, count);
+        ofs.write(&records[0], count*recordLength);
+    }
+    if(!ofs.good()) throw logic_error("TerraBIN: Failed to write " + m_data_path + "\n");
 }
 
 
@@ -48,6 +48,7 @@ Contributors:
 #define TERRABINLIDARFILEIO_H_
 
 #include "LidarFormat/LidarFileIO.h"
+#include "LidarFormat/file_formats/RecordFields.h"
 
 namespace Lidar
 {
@@ -73,6 +74,9 @@ public:
 	virtual ~TerraBINLidarFileIO();
 
     virtual void loadData(LidarDataContainer& lidarContainer, std::string filename);
+    virtual void openStream(const LidarDataContainer& lidarContainer, std::string filename);
+    virtual std::size_t readChunk(LidarDataContainer& lidarContainer, const std::size_t nbEchos);
+    virtual void seekStream(LidarDataContainer& lidarContainer, const std::size_t position);
     virtual void save(const LidarDataContainer& lidarContainer, std::string filename);
 
 	static bool Register();
@@ -83,6 +87,11 @@ private:
 
 	static bool m_isRegistered;
 
+	/// fields of the records of the opened file, size of a record and offset of the first record
+	std::vector<RecordField> m_fields;
+	unsigned int m_recordLength;
+	std::size_t m_dataOffset;
+
 };
 } //namespace Lidar
 #endif /* TERRABINLIDARFILEIO_H_ */
@@ -43,9 +43,17 @@ Contributors:
 #include "LidarFormat/LidarIOFactory.h"
 #include "LidarFormat/LidarDataContainer.h"
 #include "LidarFormat/apply.h"
+#include "LidarFormat/tools/AsciiNumbers.h"
+#include "LidarFormat/tools/ParallelBlocks.h"
 
 #include "ASCIILidarFileIO.h"
 #include <boost/filesystem.hpp>
+#include <boost/bind.hpp>
+#include <boost/ref.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <sstream>
+#include <algorithm>
 
 namespace Lidar
 {
@@ -93,6 +101,8 @@ struct field_reader: std::ctype<char>
                 rc(table_size, std::ctype_base::mask());
 
         rc['\n'] = std::ctype_base::space;
+        rc['\r'] = std::ctype_base::space;
+        rc['\t'] = std::ctype_base::space; // written by save
         rc[' '] = std::ctype_base::space;
         rc[','] = std::ctype_base::space;
         rc[';'] = std::ctype_base::space;
@@ -101,20 +111,16 @@ struct field_reader: std::ctype<char>
     }
 };
 
-void ASCIILidarFileIO::loadData(LidarDataContainer& lidarContainer, std::string filename)
+/// read the echoes of the container from the current position of the stream, returns the number of echoes read
+static std::size_t readEchoes(std::istream& data_file, LidarDataContainer& lidarContainer)
 {
-    getPaths(lidarContainer, filename);
-    std::ifstream data_file(m_data_path.c_str());
-    if(!data_file.good()) throw std::logic_error(std::string(__FUNCTION__) + ": Failed to open " + m_data_path +"\n");
-    data_file.imbue(std::locale(std::locale(), new field_reader())); // use the redefined locale
-    std::cout.precision(12);
-
     LidarIteratorEcho itbEcho = lidarContainer.begin();
     const LidarIteratorEcho iteEcho = lidarContainer.end();
 
     AttributeMapType::const_iterator itMapBegin = lidarContainer.getAttributeMap().begin();
     const AttributeMapType::const_iterator ite = lidarContainer.getAttributeMap().end();
 
+    std::size_t nbRead = 0;
     for(; (itbEcho != iteEcho) && (data_file.good()); ++itbEcho)
     {
         AttributeMapType::const_iterator itb = itMapBegin;
@@ -123,7 +129,202 @@ void ASCIILidarFileIO::loadData(LidarDataContainer& lidarContainer, std::string
             apply<ReadValueFunctor, void, std::istream &, const LidarIteratorEcho&, const unsigned int>(
                         itb->second.dataType(), data_file, itbEcho, itb->second.decalage);
         }
+        if(!data_file.fail()) ++nbRead;
     }
+    return nbRead;
+}
+
+/// parser of the values of an attribute of the container: the type is resolved once per attribute, not for each value
+struct AsciiAttributeParser
+{
+    virtual ~AsciiAttributeParser() {}
+    /// parse the value of the attribute of the index-th echo
+    virtual bool parse(const char*& it, const char* end, const std::size_t index) const = 0;
+};
+
+template<typename T>
+struct TAsciiAttributeParser : public AsciiAttributeParser
+{
+    TAsciiAttributeParser(const LidarIteratorAttribute<T>& begin): m_begin(begin) {}
+
+    bool parse(const char*& it, const char* end, const std::size_t index) const
+    {
+        T value;
+        if(!parseAsciiValue(it, end, value))
+            return false;
+        m_begin[index] = value;
+        return true;
+    }
+
+    LidarIteratorAttribute<T> m_begin;
+};
+
+template<EnumLidarDataType T>
+struct CreateAsciiAttributeParserFunctor
+{
+    typedef typename LidarEnumTypeTraits<T>::type AttributeType;
+
+    AsciiAttributeParser* operator()(LidarDataContainer& lidarContainer, const std::string& name)
+    {
+        return new TAsciiAttributeParser<AttributeType>(lidarContainer.beginAttribute<AttributeType>(name));
+    }
+};
+
+typedef std::vector<boost::shared_ptr<AsciiAttributeParser> > AsciiAttributeParsers;
+
+/// part of the text parsed by a thread, starts at the beginning of a line
+struct AsciiChunk
+{
+    const char *begin, *end;
+    /// number of values in the chunk, index of its first value in the file
+    std::size_t nbValues, firstValue;
+    /// value that could not be parsed
+    const char *error;
+};
+
+static void countValues(std::vector<AsciiChunk>& chunks, const std::size_t i)
+{
+    AsciiChunk& chunk = chunks[i];
+    chunk.nbValues = 0;
+    const char* it = chunk.begin;
+    while((it = skipAsciiSeparators(it, chunk.end)) != chunk.end)
+    {
+        ++chunk.nbValues;
+        it = findAsciiSeparator(it, chunk.end);
+    }
+}
+
+/// the echo and attribute of each value follow from its index in the file (values are stored echo by echo)
+static void parseValues(std::vector<AsciiChunk>& chunks, const AsciiAttributeParsers& parsers, const std::size_t nbValues, const std::size_t i)
+{
+    AsciiChunk& chunk = chunks[i];
+    const std::size_t nbAttributes = parsers.size();
+    std::size_t value = chunk.firstValue;
+    std::size_t echo = value / nbAttributes, attribute = value % nbAttributes;
+    const char* it = chunk.begin;
+    while(value < nbValues && (it = skipAsciiSeparators(it, chunk.end)) != chunk.end)
+    {
+        if(!parsers[attribute]->parse(it, chunk.end, echo))
+        {
+            chunk.error = it;
+            return;
+        }
+        ++value;
+        if(++attribute == nbAttributes)
+        {
+            attribute = 0;
+            ++echo;
+        }
+    }
+}
+
+/// parse the echoes of the text [begin, end) in the container (allocated), returns the number of echoes of the text (at most the container size)
+/// the text is cut in chunks at line boundaries (one per block of text), the values of all the chunks are counted then parsed concurrently
+static std::size_t parseEchoes(const char* begin, const char* end, LidarDataContainer& lidarContainer, const std::string& filename)
+{
+    const AttributeMapType& attributeMap = lidarContainer.getAttributeMap();
+    if(attributeMap.empty())
+        return 0;
+
+    // at least 1 MB per thread
+    const std::size_t minChunkSize = 1 << 20;
+    const std::size_t textSize = end - begin;
+    const std::size_t nbChunks = nbParallelBlocks(textSize, minChunkSize);
+
+    std::vector<AsciiChunk> chunks(nbChunks);
+    for(std::size_t i = 0; i < nbChunks; ++i)
+    {
+        chunks[i].begin = i == 0 ? begin : chunks[i-1].end;
+        chunks[i].end = end;
+        if(i + 1 < nbChunks)
+        {
+            const char* cut = std::max(chunks[i].begin, begin + (i+1)*parallelBlockSize(textSize, minChunkSize));
+            cut = std::find(cut, end, '\n');
+            chunks[i].end = cut == end ? end : cut + 1;
+        }
+        chunks[i].error = 0;
+    }
+
+    parallelForBlocks(textSize, minChunkSize, boost::bind(&countValues, boost::ref(chunks), _1));
+
+    std::size_t nbValues = 0;
+    for(std::size_t i = 0; i < nbChunks; ++i)
+    {
+        chunks[i].firstValue = nbValues;
+        nbValues += chunks[i].nbValues;
+    }
+
+    const std::size_t nbAttributes = attributeMap.size();
+    const std::size_t nbEchos = std::min<std::size_t>(nbValues / nbAttributes, lidarContainer.size());
+
+    AsciiAttributeParsers parsers;
+    for(AttributeMapType::const_iterator it = attributeMap.begin(); it != attributeMap.end(); ++it)
+        parsers.push_back(boost::shared_ptr<AsciiAttributeParser>(
+                              apply<CreateAsciiAttributeParserFunctor, AsciiAttributeParser*, LidarDataContainer&, const std::string&>(
+                                  it->second.dataType(), lidarContainer, it->first)));
+
+    parallelForBlocks(textSize, minChunkSize, boost::bind(&parseValues, boost::ref(chunks), boost::cref(parsers), nbEchos*nbAttributes, _1));
+
+    for(std::size_t i = 0; i < nbChunks; ++i)
+    {
+        if(chunks[i].error)
+        {
+            std::ostringstream oss;
+            oss << "ASCIILidarFileIO: invalid value \"" << std::string(chunks[i].error, findAsciiSeparator(chunks[i].error, end))
+                << "\" at line " << std::count(begin, chunks[i].error, '\n') + 1 << " of " << filename << "\n";
+            throw std::logic_error(oss.str());
+        }
+    }
+    return nbEchos;
+}
+
+void ASCIILidarFileIO::loadData(LidarDataContainer& lidarContainer, std::string filename)
+{
+    using namespace boost::interprocess;
+
+    getPaths(lidarContainer, filename);
+    if(!std::ifstream(m_data_path.c_str()).good()) throw std::logic_error(std::string(__FUNCTION__) + ": Failed to open " + m_data_path +"\n");
+
+    std::size_t n = 0;
+    if(boost::filesystem::file_size(m_data_path) > 0)
+    {
+        file_mapping file(m_data_path.c_str(), read_only);
+        mapped_region region(file, read_only);
+        const char* text = static_cast<const char*>(region.get_address());
+        n = parseEchoes(text, text + region.get_size(), lidarContainer, m_data_path);
+    }
+
+    if(n < lidarContainer.size())
+    {
+        std::cout << __FILE__ << ":" << __LINE__ << ": WARNING: " << m_data_path << " has " << n <<
+                     " echoes instead of " << lidarContainer.size() << "->fixing container" << std::endl;
+        lidarContainer.resize(n);
+        lidarContainer.getXmlStructure()->attributes().dataSize(n);
+    }
+}
+
+void ASCIILidarFileIO::openStream(const LidarDataContainer& lidarContainer, std::string filename)
+{
+    getPaths(lidarContainer, filename);
+    m_stream.reset(new std::ifstream(m_data_path.c_str()));
+    if(!m_stream->good()) throw std::logic_error(std::string(__FUNCTION__) + ": Failed to open " + m_data_path +"\n");
+    m_stream->imbue(std::locale(std::locale(), new field_reader())); // use the redefined locale
+
+    m_streamSize = lidarContainer.getXmlStructure()->attributes().dataSize();
+    m_streamPosition = 0;
+}
+
+std::size_t ASCIILidarFileIO::readChunk(LidarDataContainer& lidarContainer, const std::size_t nbEchos)
+{
+    lidarContainer.resize(std::min(nbEchos, m_streamSize - m_streamPosition));
+    const std::size_t n = readEchoes(*m_stream, lidarContainer);
+    lidarContainer.resize(n);
+
+    // the file has less echoes than announced by the xml
+    m_streamPosition += n;
+    if(n < nbEchos)
+        m_streamSize = m_streamPosition;
+    return n;
 }
 
 
@@ -134,13 +335,8 @@ void ASCIILidarFileIO::save(const LidarDataContainer& lidarContainer, std::strin
     // save txt
     std::ofstream txt_ofs(m_data_path.c_str());
     if(!txt_ofs.good()) throw std::logic_error(std::string(__FUNCTION__) + ": Failed to open " + m_data_path +"\n");
-    txt_ofs.precision(12);
-    LidarConstIteratorEcho itb(lidarContainer.begin());
-    LidarConstIteratorEcho ite(lidarContainer.end());
-    for(; itb!=ite; ++itb)
-    {
-        txt_ofs << LidarEcho(*itb) << "\n";
-    }
+    // same output as LidarEcho::operator<< with a precision of 12
+    writeAsciiRecords(txt_ofs, lidarContainer, LidarEcho::m_separator, true, 12, 12);
 }
 
 
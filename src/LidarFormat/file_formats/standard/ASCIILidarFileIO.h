@@ -54,6 +54,8 @@ class ASCIILidarFileIO : public StandardLidarFileIO
 public:
     virtual ~ASCIILidarFileIO();
     virtual void loadData(LidarDataContainer& lidarContainer, std::string filename);
+    virtual void openStream(const LidarDataContainer& lidarContainer, std::string filename);
+    virtual std::size_t readChunk(LidarDataContainer& lidarContainer, const std::size_t nbEchos);
     virtual void save(const LidarDataContainer& lidarContainer, std::string filename);
 
     static bool Register();
@@ -75,10 +75,51 @@ void BinaryLidarFileIO::loadData(LidarDataContainer& lidarContainer, std::string
 
     std::ifstream data_file(m_data_path.c_str(), std::ios::binary);
     if(data_file.good())
-        data_file.read(lidarContainer.rawData(), lidarContainer.size() * lidarContainer.pointSize());
+        readRecords(data_file, lidarContainer, 0, lidarContainer.size());
     else throw std::logic_error("BinaryLidarFileIO::loadData: Failed to open " + m_data_path +"\n");
 }
 
+bool BinaryLidarFileIO::mapData(LidarDataContainer& lidarContainer, std::string filename, bool copyOnWrite)
+{
+    if(lidarContainer.layout() != LidarDataContainer::interleaved)
+        return false;
+
+    getPaths(lidarContainer, filename);
+    if(!boost::filesystem::exists(m_data_path)) throw std::logic_error("BinaryLidarFileIO::mapData: Failed to open " + m_data_path +"\n");
+    if(lidarContainer.pointSize() == 0) throw std::logic_error("BinaryLidarFileIO::mapData: no attributes in " + m_xml_path +"\n");
+
+    const std::size_t n_points = boost::filesystem::file_size(m_data_path)/lidarContainer.pointSize();
+    if(static_cast<std::size_t>(lidarContainer.getXmlStructure()->attributes().dataSize()) != n_points)
+    {
+        std::cout << "Warning : xml structure does not match binary file size->fixing container" << std::endl;
+        lidarContainer.getXmlStructure()->attributes().dataSize(n_points);
+    }
+
+    lidarContainer.mapRawData(m_data_path, 0, n_points, copyOnWrite);
+    return true;
+}
+
+void BinaryLidarFileIO::openStream(const LidarDataContainer& lidarContainer, std::string filename)
+{
+    getPaths(lidarContainer, filename);
+    m_stream.reset(new std::ifstream(m_data_path.c_str(), std::ios::binary));
+    if(!m_stream->good()) throw std::logic_error("BinaryLidarFileIO::openStream: Failed to open " + m_data_path +"\n");
+
+    m_streamSize = boost::filesystem::file_size(m_data_path)/lidarContainer.pointSize();
+    m_streamPosition = 0;
+    m_streamOffset = 0;
+}
+
+std::size_t BinaryLidarFileIO::readChunk(LidarDataContainer& lidarContainer, const std::size_t nbEchos)
+{
+    return readRecordsChunk(lidarContainer, nbEchos);
+}
+
+void BinaryLidarFileIO::seekStream(LidarDataContainer& lidarContainer, const std::size_t position)
+{
+    seekRecords(lidarContainer, position);
+}
+
 void BinaryLidarFileIO::save(const LidarDataContainer& lidarContainer, std::string filename)
 {
     saveXml(lidarContainer, filename);
@@ -86,7 +127,7 @@ void BinaryLidarFileIO::save(const LidarDataContainer& lidarContainer, std::stri
     // save bin
     std::ofstream bin_ofs(m_data_path.c_str(), std::ios::binary);
     if(bin_ofs.good())
-        bin_ofs.write(lidarContainer.rawData(), lidarContainer.size() * lidarContainer.pointSize());
+        writeRecords(bin_ofs, lidarContainer, 0, lidarContainer.size());
     else throw std::logic_error("BinaryLidarFileIO::loadData: Failed to open " + m_data_path +"\n");
 }
 
@@ -53,6 +53,10 @@ class BinaryLidarFileIO : public StandardLidarFileIO
 public:
     virtual ~BinaryLidarFileIO();
     virtual void loadData(LidarDataContainer& lidarContainer, std::string filename);
+    virtual bool mapData(LidarDataContainer& lidarContainer, std::string filename, bool copyOnWrite);
+    virtual void openStream(const LidarDataContainer& lidarContainer, std::string filename);
+    virtual std::size_t readChunk(LidarDataContainer& lidarContainer, const std::size_t nbEchos);
+    virtual void seekStream(LidarDataContainer& lidarContainer, const std::size_t position);
     virtual void save(const LidarDataContainer& lidarContainer, std::string filename);
 
     static bool Register();
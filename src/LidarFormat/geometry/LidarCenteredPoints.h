@@ -0,0 +1,93 @@
+/***********************************************************************
+
+This file is part of the LidarFormat project source files.
+
+LidarFormat is an open source library for efficiently handling 3D point 
+clouds with a variable number of attributes at runtime. 
+
+
+Homepage: 
+
+    http://code.google.com/p/lidarformat
+
+Copyright:
+
+    Institut Geographique National & CEMAGREF (2009)
+
+Author: 
+
+    Adrien Chauve
+
+Contributors:
+
+    Nicolas David, Olivier Tournaire, Bruno Vallet
+
+
+
+    LidarFormat is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LidarFormat is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with LidarFormat.  If not, see <http://www.gnu.org/licenses/>.
+
+***********************************************************************/
+
+
+#ifndef LIDARCENTEREDPOINTS_H_
+#define LIDARCENTEREDPOINTS_H_
+
+#include <vector>
+
+#include "LidarFormat/LidarDataContainer.h"
+#include "LidarFormat/apply.h"
+#include "LidarFormat/geometry/LidarCenteringTransfo.h"
+
+
+namespace Lidar
+{
+
+namespace detail
+{
+/// apply functor of copyCenteredPoints, TPoint has float coord[3] and unsigned int index
+template<typename TPoint>
+struct CopyCenteredPoints
+{
+	template<EnumLidarDataType TCoordinateType>
+	struct Functor
+	{
+		typedef typename LidarEnumTypeTraits<TCoordinateType>::type CoordinateType;
+
+		void operator()(const LidarDataContainer& lidarContainer, const LidarCenteringTransfo& transfo, std::vector<TPoint>& points)
+		{
+			LidarConstIteratorXYZ<CoordinateType> it = lidarContainer.beginXYZ<CoordinateType>();
+			for(std::size_t i = 0; i < points.size(); ++i, ++it)
+			{
+				points[i].coord[0] = static_cast<float>(it.x() - transfo.x());
+				points[i].coord[1] = static_cast<float>(it.y() - transfo.y());
+				points[i].coord[2] = static_cast<float>(it.z());
+				points[i].index = static_cast<unsigned int>(i);
+			}
+		}
+	};
+};
+
+/// copy of the coordinates of the echoes (x,y centered) and of their index in points (of the size of the container),
+/// dispatched on the type of the coordinates (points of the spatial indexes)
+template<typename TPoint>
+void copyCenteredPoints(const LidarDataContainer& lidarContainer, const LidarCenteringTransfo& transfo, std::vector<TPoint>& points)
+{
+	apply<CopyCenteredPoints<TPoint>::template Functor, void, const LidarDataContainer&, const LidarCenteringTransfo&, std::vector<TPoint>&>(
+				lidarContainer.getAttributeType("x"), lidarContainer, transfo, points);
+}
+}
+
+} //namespace Lidar
+
+#endif /* LIDARCENTEREDPOINTS_H_ */
@@ -40,11 +40,13 @@ Contributors:
 ***********************************************************************/
 
 
+#include <algorithm>
 #include <cmath>
 
 
 #include "LidarFormat/extern/matis/tpoint2d.h"
 #include "LidarFormat/LidarDataContainer.h"
+#include "LidarFormat/LidarDataBuilder.h"
 #include "LidarFormat/apply.h"
 #include "LidarFormat/tools/Orientation2D.h"
 
@@ -122,15 +124,22 @@ void LidarCenteringTransfo::applyTransfoInverseOrientation(Orientation2D& ori) c
 //};
 
 
-template<EnumLidarDataType T>
-struct ReadValueFunctor
+/// copy of an attribute column to the same attribute of another container (see LidarDataContainer::applyOnAttribute)
+struct CopyAttributeKernel
 {
-	typedef typename LidarEnumTypeTraits<T>::type AttributeType;
+	CopyAttributeKernel(LidarDataContainer& dest, const std::string& attributeName):
+		m_dest(dest), m_attributeName(attributeName)
+	{
+	}
 
-	void operator()(LidarEcho &echo, const unsigned int decalage, LidarEcho &echoInitial, const unsigned int decalageInitial)
+	template<typename T>
+	void operator()(const LidarConstIteratorAttribute<T> begin, const LidarConstIteratorAttribute<T> end)
 	{
-		echo.value<AttributeType>(decalage) = echoInitial.value<AttributeType>(decalageInitial);
+		std::copy(begin, end, m_dest.beginAttribute<T>(m_attributeName));
 	}
+
+	LidarDataContainer& m_dest;
+	const std::string& m_attributeName;
 };
 
 
@@ -141,8 +150,6 @@ struct FunctorCenter
 
 	void operator()(const LidarDataContainer& lidarContainer, shared_ptr<LidarDataContainer>& centeredContainer, LidarCenteringTransfo& transfo, const char* const x, const char* const y, const char* const z)
 	{
-		LidarEcho echo = centeredContainer->createEcho();
-
 		LidarConstIteratorEcho itb = lidarContainer.begin();
 		const LidarConstIteratorEcho ite = lidarContainer.end();
 
@@ -159,39 +166,36 @@ struct FunctorCenter
 		if(transfo.x()==0 && transfo.y()==0)
 		{
 			const float quotient = 1000.;
-			LidarEcho echoInitial(*itb);
+			const LidarConstEchoRef echoInitial = *itb;
 			double x = std::floor(echoInitial.value<AttributeType>(decalageX_initial)/quotient)*quotient;
 			double y = std::floor(echoInitial.value<AttributeType>(decalageY_initial)/quotient)*quotient;
 			transfo.setTransfo(x,y);
 		}
 
 
+		LidarDataBuilder builder(*centeredContainer, lidarContainer.size());
+		LidarAppendCursor cursor = builder.cursor();
+
 		for(;itb!=ite; ++itb)
 		{
-			LidarEcho echoInitial(*itb);
-
-			echo.value<float>(decalageX) = (float)( echoInitial.value<AttributeType>(decalageX_initial) - transfo.x() );
-			echo.value<float>(decalageY) = (float)( echoInitial.value<AttributeType>(decalageY_initial) - transfo.y() );
-			echo.value<float>(decalageZ) = (float)echoInitial.value<AttributeType>(decalageZ_initial);
-
-			AttributeMapType::const_iterator itbAttribute = centeredContainer->getAttributeMap().begin();
-			const AttributeMapType::const_iterator iteAttribute = centeredContainer->getAttributeMap().end();
+			const LidarConstEchoRef echoInitial = *itb;
+			cursor.append();
 
-			AttributeMapType::const_iterator itbAttributeInitial = lidarContainer.getAttributeMap().begin();
+			cursor.value<float>(decalageX) = (float)( echoInitial.value<AttributeType>(decalageX_initial) - transfo.x() );
+			cursor.value<float>(decalageY) = (float)( echoInitial.value<AttributeType>(decalageY_initial) - transfo.y() );
+			cursor.value<float>(decalageZ) = (float)echoInitial.value<AttributeType>(decalageZ_initial);
+		}
+		builder.commit();
 
-			for(; itbAttribute != iteAttribute; ++itbAttribute, ++itbAttributeInitial)
+		//the other attributes are copied column by column (a single dispatch on the type per attribute)
+		const AttributeMapType& attributeMap = lidarContainer.getAttributeMap();
+		for(AttributeMapType::const_iterator it = attributeMap.begin(); it != attributeMap.end(); ++it)
+		{
+			if(it->first!=x && it->first!=y && it->first!=z)
 			{
-				if(itbAttribute->first!=x && itbAttribute->first!=y && itbAttribute->first!=z)
-				{
-                    apply<ReadValueFunctor, void, LidarEcho&, const unsigned int, LidarEcho&,const unsigned int>(
-                                itbAttribute->second.dataType(),
-                                echo, itbAttribute->second.decalage,
-                                echoInitial, itbAttributeInitial->second.decalage);
-				}
+				CopyAttributeKernel kernel(*centeredContainer, it->first);
+				lidarContainer.applyOnAttribute(it->first, kernel);
 			}
-
-
-			centeredContainer->push_back(echo);
 		}
 
 	}
@@ -201,6 +205,19 @@ struct FunctorCenter
 
 
 
+/// value of an attribute of the first echo (for the automatic transfo)
+template<EnumLidarDataType TAttributeType>
+struct FunctorFirstValue
+{
+	typedef typename LidarEnumTypeTraits<TAttributeType>::type AttributeType;
+
+	double operator()(const LidarDataContainer& lidarContainer, const std::string& attributeName)
+	{
+		return lidarContainer.begin()->value<AttributeType>(lidarContainer.getDecalage(attributeName));
+	}
+};
+
+
 //void PointCloud::minmax(const std::string &attributeName, double& mini, double &maxi) const
 //{
 //	FunctorMinMaxParameters p(*m_lidarContainer, attributeName);
@@ -226,12 +243,31 @@ shared_ptr<LidarDataContainer> LidarCenteringTransfo::centerLidarDataContainer(c
 		centeredContainer->addAttribute(it->first, type);
 	}
 
-	centeredContainer->reserve(lidarContainer.size());
-
 	apply<FunctorCenter, void, const LidarDataContainer&, shared_ptr<LidarDataContainer>&, LidarCenteringTransfo&, const char* const, const char* const, const char* const>(lidarContainer.getAttributeType(x), lidarContainer, centeredContainer, *this, x, y, z);
 
 	return centeredContainer;
 }
 
+void LidarCenteringTransfo::centerLidarDataContainerInPlace(LidarDataContainer& lidarContainer, const char* const x, const char* const y, const char* const z)
+{
+	//si la transfo vaut 0, elle est calculée automatiquement
+	if(m_x==0 && m_y==0 && !lidarContainer.empty())
+	{
+		const double quotient = 1000.;
+		m_x = std::floor(apply<FunctorFirstValue, double, const LidarDataContainer&, const std::string&>(lidarContainer.getAttributeType(x), lidarContainer, x)/quotient)*quotient;
+		m_y = std::floor(apply<FunctorFirstValue, double, const LidarDataContainer&, const std::string&>(lidarContainer.getAttributeType(y), lidarContainer, y)/quotient)*quotient;
+	}
+
+	//subtract and narrow in a single pass over the echoes, the other attributes are moved as raw blocks
+	lidarContainer.changeAttributes(AttributeChanges()
+									.changeType(x, LidarDataType::float32, AttributeChanges::cast, m_x)
+									.changeType(y, LidarDataType::float32, AttributeChanges::cast, m_y)
+									.changeType(z, LidarDataType::float32, AttributeChanges::cast));
+
+	double containerX = 0, containerY = 0;
+	lidarContainer.getCenteringTransfo(containerX, containerY);
+	lidarContainer.setCenteringTransfo(containerX + m_x, containerY + m_y);
+}
+
 } //namespace Lidar
 
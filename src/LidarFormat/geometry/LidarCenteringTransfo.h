@@ -72,6 +72,10 @@ class LidarCenteringTransfo
 
         shared_ptr<LidarDataContainer> centerLidarDataContainer(const LidarDataContainer& lidarContainer,
                                                                 const char* const x="x", const char* const y="y", const char* const z="z");
+        /// same centering without a copy: x, y, z become float32 in place (see LidarDataContainer::changeAttributes)
+        /// the container centering transfo is updated, the transfo is computed from the first echo if it is 0
+        void centerLidarDataContainerInPlace(LidarDataContainer& lidarContainer,
+                                             const char* const x="x", const char* const y="y", const char* const z="z");
 
 		bool isSet() const { return m_x!=0 && m_y!=0; }
 
@@ -0,0 +1,297 @@
+/***********************************************************************
+
+This file is part of the LidarFormat project source files.
+
+LidarFormat is an open source library for efficiently handling 3D point 
+clouds with a variable number of attributes at runtime. 
+
+
+Homepage: 
+
+    http://code.google.com/p/lidarformat
+
+Copyright:
+
+    Institut Geographique National & CEMAGREF (2009)
+
+Author: 
+
+    Adrien Chauve
+
+Contributors:
+
+    Nicolas David, Olivier Tournaire, Bruno Vallet
+
+
+
+    LidarFormat is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LidarFormat is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with LidarFormat.  If not, see <http://www.gnu.org/licenses/>.
+
+***********************************************************************/
+
+
+
+#include <algorithm>
+#include <limits>
+
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+
+#include "LidarFormat/LidarDataContainer.h"
+#include "LidarFormat/geometry/LidarCenteredPoints.h"
+#include "LidarFormat/tools/ParallelBlocks.h"
+
+#include "LidarKdTree.h"
+
+namespace
+{
+using namespace Lidar;
+using detail::_LidarKdPoint;
+
+/// number of points under which a subtree is built by a single thread
+const std::size_t kdBuildBlockSize = 1 << 16;
+/// number of queries under which batched queries are made by a single thread
+const std::size_t kdQueryBlockSize = 1 << 10;
+
+/// order of the points along a dimension (for the median split)
+struct CompareKdPoints
+{
+	explicit CompareKdPoints(const unsigned int dim): m_dim(dim) {}
+	bool operator()(const _LidarKdPoint& lhs, const _LidarKdPoint& rhs) const { return lhs.coord[m_dim] < rhs.coord[m_dim]; }
+	unsigned int m_dim;
+};
+
+inline float sqrDistance(const float* lhs, const float* rhs)
+{
+	const float dx = lhs[0] - rhs[0], dy = lhs[1] - rhs[1], dz = lhs[2] - rhs[2];
+	return dx*dx + dy*dy + dz*dz;
+}
+
+/// number of nodes of the tree of count points (split in [count/2] and [count - count/2] points while there are more than leafSize points)
+std::size_t nbKdNodes(std::size_t count, const unsigned int leafSize)
+{
+	std::size_t nbNodes = 1;
+	for(std::size_t levelSize = 1; count > leafSize; count -= count/2)
+	{
+		levelSize *= 2;
+		nbNodes += levelSize;
+	}
+	return nbNodes;
+}
+}
+
+namespace Lidar
+{
+
+LidarKdTree::LidarKdTree(const LidarDataContainer& lidarContainer, const LidarCenteringTransfo& transfo, const unsigned int leafSize):
+	m_points(lidarContainer.size()), m_leafSize(std::max(1u, leafSize))
+{
+	detail::copyCenteredPoints(lidarContainer, transfo, m_points);
+
+	m_nodes.resize(nbKdNodes(m_points.size(), m_leafSize));
+
+	//the two subtrees of a node are built concurrently on the first levels (one subtree per thread at the end)
+	unsigned int parallelDepth = 0;
+	for(std::size_t nbSubtrees = 1; nbSubtrees < nbParallelBlocks(m_points.size(), kdBuildBlockSize); nbSubtrees *= 2)
+		++parallelDepth;
+	build(0, 0, m_points.size(), parallelDepth);
+}
+
+void LidarKdTree::build(const std::size_t node, const std::size_t begin, const std::size_t end, const unsigned int parallelDepth)
+{
+	if(end - begin <= m_leafSize)
+		return;
+
+	//split along the dimension of largest extent, at the median
+	float mins[3], maxs[3];
+	std::fill(mins, mins + 3, std::numeric_limits<float>::max());
+	std::fill(maxs, maxs + 3, -std::numeric_limits<float>::max());
+	for(std::size_t i = begin; i < end; ++i)
+		for(unsigned int d = 0; d < 3; ++d)
+		{
+			mins[d] = std::min(mins[d], m_points[i].coord[d]);
+			maxs[d] = std::max(maxs[d], m_points[i].coord[d]);
+		}
+	unsigned int dim = 0;
+	for(unsigned int d = 1; d < 3; ++d)
+		if(maxs[d] - mins[d] > maxs[dim] - mins[dim])
+			dim = d;
+
+	const std::size_t middle = begin + (end - begin)/2;
+	std::nth_element(m_points.begin() + begin, m_points.begin() + middle, m_points.begin() + end, CompareKdPoints(dim));
+	m_nodes[node].split = m_points[middle].coord[dim];
+	m_nodes[node].dim = dim;
+
+	if(parallelDepth > 0)
+	{
+		boost::thread left(boost::bind(&LidarKdTree::build, this, 2*node + 1, begin, middle, parallelDepth - 1));
+		build(2*node + 2, middle, end, parallelDepth - 1);
+		left.join();
+	}
+	else
+	{
+		build(2*node + 1, begin, middle, 0);
+		build(2*node + 2, middle, end, 0);
+	}
+}
+
+void LidarKdTree::searchKnn(const std::size_t node, const std::size_t begin, const std::size_t end, const float* point, const unsigned int k,
+                            std::vector<NeighborType>& neighbors) const
+{
+	if(end - begin <= m_leafSize)
+	{
+		//neighbors is a max heap of the k best candidates
+		for(std::size_t i = begin; i < end; ++i)
+		{
+			const NeighborType neighbor(sqrDistance(point, m_points[i].coord), m_points[i].index);
+			if(neighbors.size() < k)
+			{
+				neighbors.push_back(neighbor);
+				std::push_heap(neighbors.begin(), neighbors.end());
+			}
+			else if(neighbor < neighbors.front())
+			{
+				std::pop_heap(neighbors.begin(), neighbors.end());
+				neighbors.back() = neighbor;
+				std::push_heap(neighbors.begin(), neighbors.end());
+			}
+		}
+		return;
+	}
+
+	//nearest child first, the other one only if it can contain a better candidate
+	const std::size_t middle = begin + (end - begin)/2;
+	const float diff = point[m_nodes[node].dim] - m_nodes[node].split;
+	if(diff < 0)
+		searchKnn(2*node + 1, begin, middle, point, k, neighbors);
+	else
+		searchKnn(2*node + 2, middle, end, point, k, neighbors);
+
+	if(neighbors.size() < k || diff*diff <= neighbors.front().first)
+	{
+		if(diff < 0)
+			searchKnn(2*node + 2, middle, end, point, k, neighbors);
+		else
+			searchKnn(2*node + 1, begin, middle, point, k, neighbors);
+	}
+}
+
+void LidarKdTree::searchRadius(const std::size_t node, const std::size_t begin, const std::size_t end, const float* point, const float sqrRadius,
+                               std::vector<NeighborType>& neighbors) const
+{
+	if(end - begin <= m_leafSize)
+	{
+		for(std::size_t i = begin; i < end; ++i)
+		{
+			const float distance = sqrDistance(point, m_points[i].coord);
+			if(distance <= sqrRadius)
+				neighbors.push_back(NeighborType(distance, m_points[i].index));
+		}
+		return;
+	}
+
+	const std::size_t middle = begin + (end - begin)/2;
+	const float diff = point[m_nodes[node].dim] - m_nodes[node].split;
+	if(diff < 0 || diff*diff <= sqrRadius)
+		searchRadius(2*node + 1, begin, middle, point, sqrRadius, neighbors);
+	if(diff >= 0 || diff*diff <= sqrRadius)
+		searchRadius(2*node + 2, middle, end, point, sqrRadius, neighbors);
+}
+
+void LidarKdTree::knn(const TPoint3D<float>& point, const unsigned int k, NeighborhoodListeType& indices, std::vector<float>& sqrDistances) const
+{
+	const float coord[3] = {point.x, point.y, point.z};
+	std::vector<NeighborType> neighbors;
+	neighbors.reserve(k);
+	if(k > 0)
+		searchKnn(0, 0, m_points.size(), coord, k, neighbors);
+	std::sort_heap(neighbors.begin(), neighbors.end());
+
+	indices.resize(neighbors.size());
+	sqrDistances.resize(neighbors.size());
+	for(std::size_t i = 0; i < neighbors.size(); ++i)
+	{
+		sqrDistances[i] = neighbors[i].first;
+		indices[i] = neighbors[i].second;
+	}
+}
+
+void LidarKdTree::radiusSearch(const TPoint3D<float>& point, const float radius, NeighborhoodListeType& indices, std::vector<float>& sqrDistances) const
+{
+	const float coord[3] = {point.x, point.y, point.z};
+	std::vector<NeighborType> neighbors;
+	searchRadius(0, 0, m_points.size(), coord, radius*radius, neighbors);
+	std::sort(neighbors.begin(), neighbors.end());
+
+	indices.resize(neighbors.size());
+	sqrDistances.resize(neighbors.size());
+	for(std::size_t i = 0; i < neighbors.size(); ++i)
+	{
+		sqrDistances[i] = neighbors[i].first;
+		indices[i] = neighbors[i].second;
+	}
+}
+
+void LidarKdTree::knnBlock(const std::vector<detail::_LidarKdPoint>& queries, const std::size_t first, const std::size_t count, const unsigned int k,
+                           NeighborhoodListeType& indices, std::vector<float>& sqrDistances) const
+{
+	std::vector<NeighborType> neighbors;
+	neighbors.reserve(k);
+	for(std::size_t q = first; q < first + count; ++q)
+	{
+		neighbors.clear();
+		searchKnn(0, 0, m_points.size(), queries[q].coord, k, neighbors);
+		std::sort_heap(neighbors.begin(), neighbors.end());
+
+		const std::size_t slot = std::size_t(queries[q].index) * k;
+		for(std::size_t i = 0; i < neighbors.size(); ++i)
+		{
+			sqrDistances[slot + i] = neighbors[i].first;
+			indices[slot + i] = neighbors[i].second;
+		}
+	}
+}
+
+void LidarKdTree::knnBatch(const std::vector<detail::_LidarKdPoint>& queries, const unsigned int k, NeighborhoodListeType& indices, std::vector<float>& sqrDistances) const
+{
+	const std::size_t count = queries.size();
+	const unsigned int nbNeighbors = static_cast<unsigned int>(std::min<std::size_t>(k, m_points.size()));
+	indices.resize(count*nbNeighbors);
+	sqrDistances.resize(count*nbNeighbors);
+	if(nbNeighbors == 0)
+		return;
+
+	parallelForBlocks(count, kdQueryBlockSize, boost::bind(&LidarKdTree::knnBlock, this, boost::cref(queries), _2, _3, nbNeighbors,
+	                                                       boost::ref(indices), boost::ref(sqrDistances)));
+}
+
+void LidarKdTree::knn(const std::vector<TPoint3D<float> >& points, const unsigned int k, NeighborhoodListeType& indices, std::vector<float>& sqrDistances) const
+{
+	std::vector<detail::_LidarKdPoint> queries(points.size());
+	for(std::size_t q = 0; q < points.size(); ++q)
+	{
+		queries[q].coord[0] = points[q].x;
+		queries[q].coord[1] = points[q].y;
+		queries[q].coord[2] = points[q].z;
+		queries[q].index = static_cast<unsigned int>(q);
+	}
+	knnBatch(queries, k, indices, sqrDistances);
+}
+
+void LidarKdTree::knnAll(const unsigned int k, NeighborhoodListeType& indices, std::vector<float>& sqrDistances) const
+{
+	//queries in the order of the tree (neighbouring queries visit the same leaves), results in the order of the echoes
+	knnBatch(m_points, k, indices, sqrDistances);
+}
+
+} //namespace Lidar
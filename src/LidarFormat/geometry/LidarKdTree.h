@@ -0,0 +1,124 @@
+/***********************************************************************
+
+This file is part of the LidarFormat project source files.
+
+LidarFormat is an open source library for efficiently handling 3D point 
+clouds with a variable number of attributes at runtime. 
+
+
+Homepage: 
+
+    http://code.google.com/p/lidarformat
+
+Copyright:
+
+    Institut Geographique National & CEMAGREF (2009)
+
+Author: 
+
+    Adrien Chauve
+
+Contributors:
+
+    Nicolas David, Olivier Tournaire, Bruno Vallet
+
+
+
+    LidarFormat is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LidarFormat is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with LidarFormat.  If not, see <http://www.gnu.org/licenses/>.
+
+***********************************************************************/
+
+
+
+#ifndef LIDARKDTREE_H_
+#define LIDARKDTREE_H_
+
+#include <vector>
+#include <utility>
+
+#include "LidarFormat/extern/matis/tpoint3d.h"
+#include "LidarFormat/geometry/LidarCenteringTransfo.h"
+
+namespace Lidar
+{
+
+class LidarDataContainer;
+
+namespace detail
+{
+	/// point of the k-d tree: float coordinates (in the frame of the tree) and index of the echo, 16 bytes
+	struct _LidarKdPoint
+	{
+		float coord[3];
+		unsigned int index;
+	};
+
+	/// inner node of the k-d tree: the points of its left child have coord[dim] <= split, those of its right child coord[dim] >= split
+	struct _LidarKdNode
+	{
+		float split;
+		unsigned int dim;
+	};
+}
+
+/**
+* @brief 3D k-d tree on the echoes of a container, for k nearest neighbours and radius queries
+*
+* Implicit storage: the points are copied (x,y,z as float, 16 bytes per point) and sorted in the order of the tree,
+* a node covers a range of these points, split at its middle, and its children are found by their position (2i+1, 2i+2).
+* Leaves (ranges of at most leafSize points) are contiguous in memory. The first levels are built by several threads.
+* As in LidarSpatialIndexation2D, any type of coordinates is indexed and x,y are centered on the fly by the transfo,
+* the query points are in this centered frame. Distances are squared distances.
+*
+*/
+class LidarKdTree
+{
+public:
+    typedef std::vector<unsigned int> NeighborhoodListeType;
+
+    explicit LidarKdTree(const LidarDataContainer& lidarContainer, const LidarCenteringTransfo& transfo = LidarCenteringTransfo(), const unsigned int leafSize = 16);
+
+    std::size_t size() const { return m_points.size(); }
+
+    /// the k nearest echoes of point (less if the tree has less points), sorted by increasing distance
+    void knn(const TPoint3D<float>& point, const unsigned int k, NeighborhoodListeType& indices, std::vector<float>& sqrDistances) const;
+    /// the echoes at a distance of at most radius of point, sorted by increasing distance
+    void radiusSearch(const TPoint3D<float>& point, const float radius, NeighborhoodListeType& indices, std::vector<float>& sqrDistances) const;
+
+    /// batched queries (several threads): the min(k, size()) nearest echoes of points[i] are at [i*min(k, size()), (i+1)*min(k, size())[
+    void knn(const std::vector<TPoint3D<float> >& points, const unsigned int k, NeighborhoodListeType& indices, std::vector<float>& sqrDistances) const;
+    /// batched queries of all the echoes of the container (same layout as above, echoes in the order of the container, each is its own first neighbour)
+    void knnAll(const unsigned int k, NeighborhoodListeType& indices, std::vector<float>& sqrDistances) const;
+
+private:
+    typedef std::pair<float, unsigned int> NeighborType;
+
+    void build(const std::size_t node, const std::size_t begin, const std::size_t end, const unsigned int parallelDepth);
+    void searchKnn(const std::size_t node, const std::size_t begin, const std::size_t end, const float* point, const unsigned int k,
+                   std::vector<NeighborType>& neighbors) const;
+    void searchRadius(const std::size_t node, const std::size_t begin, const std::size_t end, const float* point, const float sqrRadius,
+                      std::vector<NeighborType>& neighbors) const;
+    /// batched knn of queries[first, first+count[, the results of a query go to the slot of its index
+    void knnBlock(const std::vector<detail::_LidarKdPoint>& queries, const std::size_t first, const std::size_t count, const unsigned int k,
+                  NeighborhoodListeType& indices, std::vector<float>& sqrDistances) const;
+    void knnBatch(const std::vector<detail::_LidarKdPoint>& queries, const unsigned int k, NeighborhoodListeType& indices, std::vector<float>& sqrDistances) const;
+
+    std::vector<detail::_LidarKdPoint> m_points;
+    std::vector<detail::_LidarKdNode> m_nodes;
+    unsigned int m_leafSize;
+};
+
+} //namespace Lidar
+
+#endif /* LIDARKDTREE_H_ */
@@ -0,0 +1,364 @@
+/***********************************************************************
+
+This file is part of the LidarFormat project source files.
+
+LidarFormat is an open source library for efficiently handling 3D point 
+clouds with a variable number of attributes at runtime. 
+
+
+Homepage: 
+
+    http://code.google.com/p/lidarformat
+
+Copyright:
+
+    Institut Geographique National & CEMAGREF (2009)
+
+Author: 
+
+    Adrien Chauve
+
+Contributors:
+
+    Nicolas David, Olivier Tournaire, Bruno Vallet
+
+
+
+    LidarFormat is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LidarFormat is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with LidarFormat.  If not, see <http://www.gnu.org/licenses/>.
+
+***********************************************************************/
+
+
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+#include <boost/bind.hpp>
+
+#include "LidarFormat/LidarDataContainer.h"
+#include "LidarFormat/geometry/LidarCenteredPoints.h"
+#include "LidarFormat/tools/ParallelBlocks.h"
+
+#include "LidarOctree.h"
+
+namespace
+{
+using namespace Lidar;
+using detail::_LidarOctreePoint;
+using detail::_LidarOctreeNode;
+
+/// number of points under which the Morton codes are computed and sorted by a single thread
+const std::size_t octreeBlockSize = 1 << 16;
+
+typedef std::pair<uint64, unsigned int> CodeType;
+
+/// the 21 bits of value spread every 3 bits
+inline uint64 spreadBits(uint64 value)
+{
+	value &= 0x1fffff;
+	value = (value | value << 32) & 0x1f00000000ffffULL;
+	value = (value | value << 16) & 0x1f0000ff0000ffULL;
+	value = (value | value << 8) & 0x100f00f00f00f00fULL;
+	value = (value | value << 4) & 0x10c30c30c30c30c3ULL;
+	value = (value | value << 2) & 0x1249249249249249ULL;
+	return value;
+}
+
+/// Morton codes of the points [first, first+count[ in the cube (origin, size): x on bit 0 of each octant, y on bit 1, z on bit 2
+/// the block is then sorted by (code, index)
+void codesBlock(const std::vector<_LidarOctreePoint>& points, const double* origin, const double scale, const std::size_t first, const std::size_t count,
+                std::vector<CodeType>& codes)
+{
+	const double maxCell = double((1 << LidarOctree::maxLevel) - 1);
+	for(std::size_t i = first; i < first + count; ++i)
+	{
+		uint64 code = 0;
+		for(unsigned int d = 0; d < 3; ++d)
+		{
+			const double cell = std::min(maxCell, std::max(0., (points[i].coord[d] - origin[d]) * scale));
+			code |= spreadBits(static_cast<uint64>(cell)) << d;
+		}
+		codes[i] = CodeType(code, points[i].index);
+	}
+	std::sort(codes.begin() + first, codes.begin() + first + count);
+}
+
+enum CubePosition { outside, crossing, inside };
+
+/// box query
+struct BoxTest
+{
+	BoxTest(const TPoint3D<float>& min, const TPoint3D<float>& max)
+	{
+		m_min[0] = min.x; m_min[1] = min.y; m_min[2] = min.z;
+		m_max[0] = max.x; m_max[1] = max.y; m_max[2] = max.z;
+	}
+
+	CubePosition cube(const _LidarOctreeNode& node) const
+	{
+		bool isInside = true;
+		for(unsigned int d = 0; d < 3; ++d)
+		{
+			if(node.max[d] < m_min[d] || node.min[d] > m_max[d])
+				return outside;
+			isInside = isInside && node.min[d] >= m_min[d] && node.max[d] <= m_max[d];
+		}
+		return isInside ? inside : crossing;
+	}
+
+	bool point(const float* coord) const
+	{
+		for(unsigned int d = 0; d < 3; ++d)
+			if(coord[d] < m_min[d] || coord[d] > m_max[d])
+				return false;
+		return true;
+	}
+
+	float m_min[3], m_max[3];
+};
+
+/// sphere query
+struct SphereTest
+{
+	SphereTest(const TPoint3D<float>& centre, const float radius): m_sqrRadius(radius*radius)
+	{
+		m_centre[0] = centre.x; m_centre[1] = centre.y; m_centre[2] = centre.z;
+	}
+
+	CubePosition cube(const _LidarOctreeNode& node) const
+	{
+		//distance to the nearest and to the farthest point of the box
+		float nearest = 0, farthest = 0;
+		for(unsigned int d = 0; d < 3; ++d)
+		{
+			const float toMin = m_centre[d] - node.min[d], toMax = node.max[d] - m_centre[d];
+			if(toMin < 0)
+				nearest += toMin*toMin;
+			else if(toMax < 0)
+				nearest += toMax*toMax;
+			const float far = std::max(std::abs(toMin), std::abs(toMax));
+			farthest += far*far;
+		}
+		if(nearest > m_sqrRadius)
+			return outside;
+		return farthest <= m_sqrRadius ? inside : crossing;
+	}
+
+	bool point(const float* coord) const
+	{
+		const float dx = coord[0] - m_centre[0], dy = coord[1] - m_centre[1], dz = coord[2] - m_centre[2];
+		return dx*dx + dy*dy + dz*dz <= m_sqrRadius;
+	}
+
+	float m_centre[3];
+	float m_sqrRadius;
+};
+
+/// frustum (intersection of half spaces) query
+struct FrustumTest
+{
+	explicit FrustumTest(const std::vector<LidarOctree::Plane>& planes): m_planes(planes) {}
+
+	CubePosition cube(const _LidarOctreeNode& node) const
+	{
+		//for each plane, the corner of the box the most inside (positive vertex) and the most outside (negative vertex)
+		bool isInside = true;
+		for(std::vector<LidarOctree::Plane>::const_iterator it = m_planes.begin(); it != m_planes.end(); ++it)
+		{
+			const float normal[3] = {it->normal.x, it->normal.y, it->normal.z};
+			float positive = it->d, negative = it->d;
+			for(unsigned int d = 0; d < 3; ++d)
+			{
+				positive += normal[d] * (normal[d] >= 0 ? node.max[d] : node.min[d]);
+				negative += normal[d] * (normal[d] >= 0 ? node.min[d] : node.max[d]);
+			}
+			if(positive < 0)
+				return outside;
+			isInside = isInside && negative >= 0;
+		}
+		return isInside ? inside : crossing;
+	}
+
+	bool point(const float* coord) const
+	{
+		//same order of the sums as for the corners of the boxes (consistent roundings)
+		for(std::vector<LidarOctree::Plane>::const_iterator it = m_planes.begin(); it != m_planes.end(); ++it)
+			if(it->d + it->normal.x*coord[0] + it->normal.y*coord[1] + it->normal.z*coord[2] < 0)
+				return false;
+		return true;
+	}
+
+	const std::vector<LidarOctree::Plane>& m_planes;
+};
+}
+
+namespace Lidar
+{
+
+const unsigned int LidarOctree::maxLevel;
+
+LidarOctree::LidarOctree(const LidarDataContainer& lidarContainer, const LidarCenteringTransfo& transfo, const unsigned int maxLeafSize):
+	m_maxLeafSize(std::max(1u, maxLeafSize)), m_depth(0)
+{
+	std::vector<detail::_LidarOctreePoint> points(lidarContainer.size());
+	detail::copyCenteredPoints(lidarContainer, transfo, points);
+
+	//bounding cube of the cloud
+	double origin[3], extent = 0;
+	for(unsigned int d = 0; d < 3; ++d)
+	{
+		float min = std::numeric_limits<float>::max(), max = -std::numeric_limits<float>::max();
+		for(std::size_t i = 0; i < points.size(); ++i)
+		{
+			min = std::min(min, points[i].coord[d]);
+			max = std::max(max, points[i].coord[d]);
+		}
+		origin[d] = min;
+		extent = std::max(extent, double(max) - min);
+	}
+	const double scale = extent > 0 ? (1 << maxLevel) / extent : 0.;
+
+	//Morton codes, sorted by blocks (one per thread) then merged
+	const std::size_t count = points.size();
+	const std::size_t threadSize = parallelBlockSize(count, octreeBlockSize);
+	std::vector<CodeType> sortedCodes(count);
+	parallelForBlocks(count, octreeBlockSize, boost::bind(&codesBlock, boost::cref(points), origin, scale, _2, _3, boost::ref(sortedCodes)));
+	for(std::size_t middle = threadSize; middle < count; middle += threadSize)
+		std::inplace_merge(sortedCodes.begin(), sortedCodes.begin() + middle, sortedCodes.begin() + std::min(count, middle + threadSize));
+
+	m_points.resize(count);
+	std::vector<uint64> codes(count);
+	for(std::size_t i = 0; i < count; ++i)
+	{
+		codes[i] = sortedCodes[i].first;
+		m_points[i] = points[sortedCodes[i].second];
+	}
+
+	detail::_LidarOctreeNode root;
+	root.begin = 0;
+	root.end = static_cast<unsigned int>(count);
+	m_nodes.push_back(root);
+	build(0, codes, 0);
+}
+
+void LidarOctree::build(const std::size_t node, const std::vector<uint64>& codes, const unsigned int level)
+{
+	const unsigned int begin = m_nodes[node].begin, end = m_nodes[node].end;
+	m_nodes[node].firstChild = m_nodes[node].nbChildren = 0;
+
+	if(end - begin > m_maxLeafSize && level < maxLevel)
+	{
+		//the points of an octant have the same 3 bits of level in their codes: consecutive ranges in the Morton order
+		const unsigned int shift = 3*(maxLevel - level - 1);
+		const unsigned int firstChild = static_cast<unsigned int>(m_nodes.size());
+		unsigned int childBegin = begin;
+		while(childBegin < end)
+		{
+			const uint64 octantEnd = ((codes[childBegin] >> shift) + 1) << shift;
+			const unsigned int childEnd = static_cast<unsigned int>(std::lower_bound(codes.begin() + childBegin, codes.begin() + end, octantEnd) - codes.begin());
+			detail::_LidarOctreeNode child;
+			child.begin = childBegin;
+			child.end = childEnd;
+			m_nodes.push_back(child);
+			childBegin = childEnd;
+		}
+
+		//a single octant: the cube is split again (no node for it)
+		if(m_nodes.size() - firstChild == 1)
+		{
+			m_nodes.pop_back();
+			build(node, codes, level + 1);
+			return;
+		}
+
+		m_nodes[node].firstChild = firstChild;
+		m_nodes[node].nbChildren = static_cast<unsigned int>(m_nodes.size() - firstChild);
+		for(unsigned int child = firstChild; child < firstChild + m_nodes[node].nbChildren; ++child)
+			build(child, codes, level + 1);
+	}
+	else
+		m_depth = std::max(m_depth, level);
+
+	//bounding box of the points: of the points of a leaf, of the boxes of the children
+	detail::_LidarOctreeNode& current = m_nodes[node];
+	std::fill(current.min, current.min + 3, std::numeric_limits<float>::max());
+	std::fill(current.max, current.max + 3, -std::numeric_limits<float>::max());
+	for(unsigned int d = 0; d < 3; ++d)
+	{
+		if(current.nbChildren == 0)
+			for(unsigned int i = begin; i < end; ++i)
+			{
+				current.min[d] = std::min(current.min[d], m_points[i].coord[d]);
+				current.max[d] = std::max(current.max[d], m_points[i].coord[d]);
+			}
+		else
+			for(unsigned int child = current.firstChild; child < current.firstChild + current.nbChildren; ++child)
+			{
+				current.min[d] = std::min(current.min[d], m_nodes[child].min[d]);
+				current.max[d] = std::max(current.max[d], m_nodes[child].max[d]);
+			}
+	}
+}
+
+void LidarOctree::appendRange(NeighborhoodListeType& list, const std::size_t begin, const std::size_t end) const
+{
+	for(std::size_t i = begin; i < end; ++i)
+		list.push_back(m_points[i].index);
+}
+
+template<class TTest>
+void LidarOctree::query(const std::size_t node, const TTest& test, NeighborhoodListeType& list) const
+{
+	const detail::_LidarOctreeNode& current = m_nodes[node];
+	switch(test.cube(current))
+	{
+	case outside:
+		return;
+	case inside:
+		appendRange(list, current.begin, current.end);
+		return;
+	case crossing:
+		if(current.nbChildren == 0)
+		{
+			for(unsigned int i = current.begin; i < current.end; ++i)
+				if(test.point(m_points[i].coord))
+					list.push_back(m_points[i].index);
+		}
+		else
+			for(unsigned int child = current.firstChild; child < current.firstChild + current.nbChildren; ++child)
+				query(child, test, list);
+	}
+}
+
+void LidarOctree::boxQuery(NeighborhoodListeType& list, const TPoint3D<float>& min, const TPoint3D<float>& max) const
+{
+	if(!m_points.empty())
+		query(0, BoxTest(min, max), list);
+}
+
+void LidarOctree::sphereQuery(NeighborhoodListeType& list, const TPoint3D<float>& centre, const float radius) const
+{
+	if(!m_points.empty())
+		query(0, SphereTest(centre, radius), list);
+}
+
+void LidarOctree::frustumQuery(NeighborhoodListeType& list, const std::vector<Plane>& planes) const
+{
+	if(!m_points.empty())
+		query(0, FrustumTest(planes), list);
+}
+
+} //namespace Lidar
@@ -0,0 +1,132 @@
+/***********************************************************************
+
+This file is part of the LidarFormat project source files.
+
+LidarFormat is an open source library for efficiently handling 3D point 
+clouds with a variable number of attributes at runtime. 
+
+
+Homepage: 
+
+    http://code.google.com/p/lidarformat
+
+Copyright:
+
+    Institut Geographique National & CEMAGREF (2009)
+
+Author: 
+
+    Adrien Chauve
+
+Contributors:
+
+    Nicolas David, Olivier Tournaire, Bruno Vallet
+
+
+
+    LidarFormat is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LidarFormat is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with LidarFormat.  If not, see <http://www.gnu.org/licenses/>.
+
+***********************************************************************/
+
+
+
+#ifndef LIDAROCTREE_H_
+#define LIDAROCTREE_H_
+
+#include <vector>
+
+#include "LidarFormat/LidarDataFormatTypes.h"
+#include "LidarFormat/extern/matis/tpoint3d.h"
+#include "LidarFormat/geometry/LidarCenteringTransfo.h"
+
+namespace Lidar
+{
+
+class LidarDataContainer;
+
+namespace detail
+{
+	/// point of the octree: float coordinates (in the frame of the octree) and index of the echo
+	struct _LidarOctreePoint
+	{
+		float coord[3];
+		unsigned int index;
+	};
+
+	/// cube of the octree, covers the points [begin, end[ (in Morton order), its children are the nodes [firstChild, firstChild+nbChildren[ (none for a leaf)
+	/// min, max: bounding box of its points (exact, tighter than the cube)
+	struct _LidarOctreeNode
+	{
+		float min[3], max[3];
+		unsigned int begin, end;
+		unsigned int firstChild, nbChildren;
+	};
+}
+
+/**
+* @brief Adaptive octree on the echoes of a container, for box, sphere and frustum queries
+*
+* The points are sorted by the Morton code of their position (21 bits per axis in the bounding cube of the cloud),
+* so that each cube of the octree covers a contiguous range of points. A cube is split in its (non empty) octants
+* while it has more than maxLeafSize points: the depth follows the density, which varies a lot in terrestrial scans.
+* As in LidarKdTree, any type of coordinates is indexed and x,y are centered on the fly by the transfo.
+* The queries return the indices of the echoes in the Morton order (cubes inside the query are taken without a test per point).
+*
+*/
+class LidarOctree
+{
+public:
+    typedef std::vector<unsigned int> NeighborhoodListeType;
+
+    /// half space of the points p with normal.p + d >= 0
+    struct Plane
+    {
+        Plane(const TPoint3D<float>& normal_, const float d_): normal(normal_), d(d_) {}
+        TPoint3D<float> normal;
+        float d;
+    };
+
+    explicit LidarOctree(const LidarDataContainer& lidarContainer, const LidarCenteringTransfo& transfo = LidarCenteringTransfo(), const unsigned int maxLeafSize = 32);
+
+    std::size_t size() const { return m_points.size(); }
+    std::size_t nbNodes() const { return m_nodes.size(); }
+    /// level of the deepest leaf (0: the root is a leaf)
+    unsigned int depth() const { return m_depth; }
+
+    /// queries: the indices of the echoes are appended to list (not cleared, several queries can be gathered)
+    /// echoes in the box [min, max]
+    void boxQuery(NeighborhoodListeType& list, const TPoint3D<float>& min, const TPoint3D<float>& max) const;
+    /// echoes at a distance of at most radius of centre
+    void sphereQuery(NeighborhoodListeType& list, const TPoint3D<float>& centre, const float radius) const;
+    /// echoes in the intersection of the half spaces (the 6 planes of a view frustum, or any convex polyhedron)
+    void frustumQuery(NeighborhoodListeType& list, const std::vector<Plane>& planes) const;
+
+    /// maximum level of the octree (bits of the Morton codes per axis)
+    static const unsigned int maxLevel = 21;
+
+private:
+    void build(const std::size_t node, const std::vector<uint64>& codes, const unsigned int level);
+    void appendRange(NeighborhoodListeType& list, const std::size_t begin, const std::size_t end) const;
+    /// queries: TTest tells if a cube is outside of the query, inside it or crosses it, and if a point is inside
+    template<class TTest>
+    void query(const std::size_t node, const TTest& test, NeighborhoodListeType& list) const;
+
+    std::vector<detail::_LidarOctreePoint> m_points;
+    std::vector<detail::_LidarOctreeNode> m_nodes;
+    unsigned int m_maxLeafSize, m_depth;
+};
+
+} //namespace Lidar
+
+#endif /* LIDAROCTREE_H_ */
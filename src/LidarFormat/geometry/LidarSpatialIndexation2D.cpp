@@ -43,9 +43,118 @@ Contributors:
 #include <boost/bind.hpp>
 
 #include "LidarFormat/LidarDataContainer.h"
+#include "LidarFormat/apply.h"
+#include "LidarFormat/tools/ParallelBlocks.h"
 
 #include "LidarSpatialIndexation2D.h"
 
+namespace
+{
+using namespace Lidar;
+
+/// number of points under which the bbox and the cells are computed by a single thread
+const std::size_t indexBlockSize = 1 << 16;
+
+/// coordinate in the frame of the index (centered on the fly, exact for float coordinates without offset)
+template<typename T>
+inline float centered(const T value, const double offset)
+{
+	return static_cast<float>(value - offset);
+}
+
+/// bbox of the points [first, first+count[ in bboxMins[block], bboxMaxs[block]
+template<typename T>
+void bboxBlock(const LidarDataContainer& lidarContainer, const TPoint2D<double>& offset, std::vector<TPoint2D<float> >& bboxMins, std::vector<TPoint2D<float> >& bboxMaxs,
+               const std::size_t block, const std::size_t first, const std::size_t count)
+{
+	TPoint2D<float>& bboxMin = bboxMins[block];
+	TPoint2D<float>& bboxMax = bboxMaxs[block];
+	bboxMin.x = bboxMin.y = std::numeric_limits<float>::max();
+	bboxMax.x = bboxMax.y = -std::numeric_limits<float>::max();
+
+	LidarConstIteratorXYZ<T> itb = lidarContainer.beginXYZ<T>() + first;
+	const LidarConstIteratorXYZ<T> ite = itb + count;
+	for (; itb != ite; ++itb)
+	{
+		const float x = centered(itb.x(), offset.x);
+		const float y = centered(itb.y(), offset.y);
+		bboxMin.x = std::min(bboxMin.x, x);
+		bboxMin.y = std::min(bboxMin.y, y);
+		bboxMax.x = std::max(bboxMax.x, x);
+		bboxMax.y = std::max(bboxMax.y, y);
+	}
+}
+
+/// cells of the points [first, first+count[ in a grid of size taille (cells of a column are consecutive), points out of the grid are left unchanged
+template<typename T>
+void cellsBlock(const LidarDataContainer& lidarContainer, const TPoint2D<double>& offset, const Orientation2D& ori, const TPoint2D<int>& taille,
+                const std::size_t first, const std::size_t count, std::vector<unsigned int>& cells)
+{
+	int col, ligne;
+
+	LidarConstIteratorXYZ<T> itb = lidarContainer.beginXYZ<T>() + first;
+	const LidarConstIteratorXYZ<T> ite = itb + count;
+	std::vector<unsigned int>::iterator itCell = cells.begin() + first;
+
+	for (; itb != ite; ++itb, ++itCell)
+	{
+		ori.MapToImage( centered(itb.x(), offset.x), centered(itb.y(), offset.y), col, ligne );
+
+		//dans le cas où la bbox n'a pas été calculée mais fournie dan le constructeur, il faut tester si on sort de la grille
+		if(col>=0 && ligne>=0 && col<taille.x && ligne<taille.y)
+			*itCell = col * taille.y + ligne;
+	}
+}
+
+/// bbox of each block of points (one block per thread), dispatched on the type of the coordinates
+template<EnumLidarDataType TCoordinateType>
+struct FunctorBBox
+{
+	typedef typename LidarEnumTypeTraits<TCoordinateType>::type CoordinateType;
+
+	void operator()(const LidarDataContainer& lidarContainer, const TPoint2D<double>& offset, std::vector<TPoint2D<float> >& bboxMins, std::vector<TPoint2D<float> >& bboxMaxs)
+	{
+		parallelForBlocks(lidarContainer.size(), indexBlockSize, boost::bind(&bboxBlock<CoordinateType>, boost::cref(lidarContainer), boost::cref(offset),
+		                                                                     boost::ref(bboxMins), boost::ref(bboxMaxs), _1, _2, _3));
+	}
+};
+
+/// cells of all the points (one block per thread), dispatched on the type of the coordinates
+template<EnumLidarDataType TCoordinateType>
+struct FunctorCells
+{
+	typedef typename LidarEnumTypeTraits<TCoordinateType>::type CoordinateType;
+
+	void operator()(const LidarDataContainer& lidarContainer, const TPoint2D<double>& offset, const Orientation2D& ori, const TPoint2D<int>& taille,
+	                std::vector<unsigned int>& cells)
+	{
+		parallelForBlocks(lidarContainer.size(), indexBlockSize, boost::bind(&cellsBlock<CoordinateType>, boost::cref(lidarContainer), boost::cref(offset),
+		                                                                     boost::cref(ori), boost::cref(taille), _2, _3, boost::ref(cells)));
+	}
+};
+
+/// keeps the points of list[first, end[ for which isInside is true (coordinates in the frame of the index), dispatched on the type of the coordinates
+template<EnumLidarDataType TCoordinateType>
+struct FunctorFilter
+{
+	typedef typename LidarEnumTypeTraits<TCoordinateType>::type CoordinateType;
+
+	void operator()(const LidarDataContainer& lidarContainer, const TPoint2D<double>& offset, RasterSpatialIndexation::NeighborhoodListeType& list,
+	                const std::size_t first, const RasterSpatialIndexation::NeighborhoodFunctionType& isInside)
+	{
+		const LidarConstIteratorXYZ<CoordinateType> beginXYZ = lidarContainer.beginXYZ<CoordinateType>();
+		RasterSpatialIndexation::NeighborhoodListeType::iterator itOut = list.begin() + first;
+		for (RasterSpatialIndexation::NeighborhoodListeType::const_iterator it = list.begin() + first; it != list.end(); ++it)
+		{
+			const LidarConstIteratorXYZ<CoordinateType> itXYZ(beginXYZ + *it);
+			if (isInside(centered(itXYZ.x(), offset.x), centered(itXYZ.y(), offset.y), static_cast<float>(itXYZ.z())))
+				*itOut++ = *it;
+		}
+		list.erase(itOut, list.end());
+	}
+};
+}
+
 namespace Lidar
 {
 
@@ -61,51 +170,36 @@ void LidarSpatialIndexation2D::GetCenteredNeighborhood(NeighborhoodListeType &li
 	const int tailleVoisinage = static_cast<int> ( std::ceil( approxNeighborhoodSize / m_resolution ) );
 
 	const int colMin = std::max( 0, colonne - tailleVoisinage );
-	const int colMax = std::min( m_griddedData.GetTaille().x - 1, colonne + tailleVoisinage );
+	const int colMax = std::min( m_taille.x - 1, colonne + tailleVoisinage );
 	const int ligMin = std::max( 0, ligne - tailleVoisinage );
-	const int ligMax = std::min( m_griddedData.GetTaille().y - 1, ligne + tailleVoisinage );
-
-	const unsigned int evalNbPoints = (unsigned int)( (colMax-colMin+1)*(ligMax-ligMin+1)*m_resolution*m_nbPointsParM2 );
-	list.reserve(evalNbPoints);
+	const int ligMax = std::min( m_taille.y - 1, ligne + tailleVoisinage );
 
-	const LidarConstIteratorXYZ<float> beginXYZ = m_lidarContainer.beginXYZ<float>();
-
-	for (int col = colMin; col <= colMax; ++col)
-	{
-		for (int lig = ligMin; lig <= ligMax; ++lig)
-		{
-			std::vector<unsigned int>::const_iterator itb = m_griddedData(col, lig).begin();
-			const std::vector<unsigned int>::const_iterator ite = m_griddedData(col, lig).end();
-			for (; itb != ite; ++itb)
-			{
-				const LidarConstIteratorXYZ<float> itXYZ(beginXYZ + *itb);
-				if (isInside(itXYZ.x(), itXYZ.y(), itXYZ.z()))
-					list.push_back(*itb);
-			}
+	if(colMax < colMin || ligMax < ligMin)
+		return;
 
-		}
-	}
+	//les cellules [ligMin,ligMax] d'une colonne sont contiguës dans la grille CSR, puis filtrage des points ajoutés selon le type des coordonnées
+	const std::size_t first = list.size();
+	appendCells(list, colMin, colMax, ligMin, ligMax);
+	apply<FunctorFilter, void, const LidarDataContainer&, const TPoint2D<double>&, NeighborhoodListeType&, const std::size_t, const NeighborhoodFunctionType&>(
+				m_lidarContainer.getAttributeType("x"), m_lidarContainer, m_offset, list, first, isInside);
 }
 
 void LidarSpatialIndexation2D::findBBox()
 {
-
-	m_bboxMin.x = std::numeric_limits<float>::max();
-	m_bboxMin.y = std::numeric_limits<float>::max();
-	m_bboxMax.x = -std::numeric_limits<float>::max();
-	m_bboxMax.y = -std::numeric_limits<float>::max();
-
-
-	LidarConstIteratorXYZ<float> itb = m_lidarContainer.beginXYZ<float>();
-	const LidarConstIteratorXYZ<float> ite = m_lidarContainer.endXYZ<float>();
-
-
-	for (; itb != ite; ++itb)
+	//réduction parallèle : bbox de chaque bloc de points, puis min/max des bbox (exacte)
+	const std::size_t nbThreads = nbParallelBlocks(m_lidarContainer.size(), indexBlockSize);
+	std::vector<TPoint2D<float> > bboxMins(nbThreads, TPoint2D<float>(0,0)), bboxMaxs(nbThreads, TPoint2D<float>(0,0));
+	apply<FunctorBBox, void, const LidarDataContainer&, const TPoint2D<double>&, std::vector<TPoint2D<float> >&, std::vector<TPoint2D<float> >&>(
+				m_lidarContainer.getAttributeType("x"), m_lidarContainer, m_offset, bboxMins, bboxMaxs);
+
+	m_bboxMin = bboxMins[0];
+	m_bboxMax = bboxMaxs[0];
+	for(std::size_t t = 1; t < nbThreads; ++t)
 	{
-		m_bboxMin.x = std::min(m_bboxMin.x, itb.x());
-		m_bboxMin.y = std::min(m_bboxMin.y, itb.y());
-		m_bboxMax.x = std::max(m_bboxMax.x, itb.x());
-		m_bboxMax.y = std::max(m_bboxMax.y, itb.y());
+		m_bboxMin.x = std::min(m_bboxMin.x, bboxMins[t].x);
+		m_bboxMin.y = std::min(m_bboxMin.y, bboxMins[t].y);
+		m_bboxMax.x = std::max(m_bboxMax.x, bboxMaxs[t].x);
+		m_bboxMax.y = std::max(m_bboxMax.y, bboxMaxs[t].y);
 	}
 
 	std::cout << "LidarSpatialIndexation2D  bbox = " << m_bboxMin << " ; " << m_bboxMax << std::endl;
@@ -115,31 +209,17 @@ void LidarSpatialIndexation2D::findBBox()
 
 void LidarSpatialIndexation2D::fillData()
 {
-	int col, ligne;
-
-	LidarConstIteratorXYZ<float> itb = m_lidarContainer.beginXYZ<float>();
-	const LidarConstIteratorXYZ<float> ite = m_lidarContainer.endXYZ<float>();
-
-	const LidarConstIteratorXYZ<float> itbegin = m_lidarContainer.beginXYZ<float>();
-
-	for (; itb != ite; ++itb)
-	{
-		m_ori.MapToImage( itb.x(), itb.y(), col, ligne );
-
-//		std::cout << itb.x() << "\t" << itb.y() << "\t" << col << "\t" << ligne << std::endl;
-		//dans le cas où la bbox n'a pas été calculée mais fournie dan le constructeur, il faut tester si on sort de la grille
-		if(col>=0 && ligne>=0 && col<m_griddedData.GetTaille().x && ligne<m_griddedData.GetTaille().y)
-		{
-			m_griddedData(col, ligne).push_back(itb - itbegin);
-//			std::cout << "filled en : " << col << "," << ligne << std::endl;
-		}
-	}
+	//cellule de chaque point (par blocs en parallèle), puis remplissage de la grille CSR
+	std::vector<unsigned int> cells(m_lidarContainer.size(), nbCells());
+	apply<FunctorCells, void, const LidarDataContainer&, const TPoint2D<double>&, const Orientation2D&, const TPoint2D<int>&, std::vector<unsigned int>&>(
+				m_lidarContainer.getAttributeType("x"), m_lidarContainer, m_offset, m_ori, m_taille, cells);
 
+	fillCells(cells);
 }
 
-LidarSpatialIndexation2D::LidarSpatialIndexation2D(const LidarDataContainer& lidarContainer):
+LidarSpatialIndexation2D::LidarSpatialIndexation2D(const LidarDataContainer& lidarContainer, const LidarCenteringTransfo& transfo):
 	RasterSpatialIndexation(),
-	m_lidarContainer(lidarContainer)
+	m_lidarContainer(lidarContainer), m_offset(transfo.x(), transfo.y())
 {
 
 }
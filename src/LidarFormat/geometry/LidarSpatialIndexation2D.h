@@ -46,6 +46,7 @@ Contributors:
 
 
 #include "LidarFormat/geometry/RasterSpatialIndexation.h"
+#include "LidarFormat/geometry/LidarCenteringTransfo.h"
 
 namespace Lidar
 {
@@ -54,13 +55,15 @@ class LidarDataContainer;
 template<class T> class LidarIteratorXYZ;
 
 /**
- * ATTENTION : implémentée que pour des float !
+ * Indexation de x,y quel que soit leur type (choisi à l'exécution selon le type de x ; y et z doivent avoir le même).
+ * Les coordonnées de l'index sont des float, centrées à la volée par la transfo : un nuage en float64 est indexé sans copie.
+ * Les centres des voisinages et les arguments de NeighborhoodFunctionType sont dans ce repère centré (z n'est pas centré).
  */
 
 class LidarSpatialIndexation2D : public RasterSpatialIndexation
 {
 	public:
-		LidarSpatialIndexation2D(const LidarDataContainer& lidarContainer);
+		LidarSpatialIndexation2D(const LidarDataContainer& lidarContainer, const LidarCenteringTransfo& transfo = LidarCenteringTransfo());
 		virtual ~LidarSpatialIndexation2D();
 
 		virtual void GetCenteredNeighborhood(NeighborhoodListeType &list, const TPoint2D<float> &centre, const float approxNeighborhoodSize, const NeighborhoodFunctionType IsInside = defaultIsInside) const;
@@ -71,6 +74,8 @@ class LidarSpatialIndexation2D : public RasterSpatialIndexation
 
 		//reference data
 		const LidarDataContainer& m_lidarContainer;
+		//centering transfo subtracted from x,y
+		const TPoint2D<double> m_offset;
 
 
 };
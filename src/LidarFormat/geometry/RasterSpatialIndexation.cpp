@@ -43,8 +43,40 @@ Contributors:
 #include <iostream>
 #include <stdexcept>
 #include <iterator>
+#include <algorithm>
+
+#include <boost/bind.hpp>
+
+#include "LidarFormat/tools/ParallelBlocks.h"
+
 #include "RasterSpatialIndexation.h"
 
+namespace
+{
+/// number of points under which the grid is filled by a single thread
+const std::size_t fillBlockSize = 1 << 16;
+
+/// histogram counts[block] of the cells of the points [first, first+count[ (outside: points out of the grid)
+void countCells(const std::vector<unsigned int>& cells, const unsigned int outside, std::vector<std::vector<unsigned int> >& counts,
+                const std::size_t block, const std::size_t first, const std::size_t count)
+{
+	counts[block].assign(outside, 0);
+	for (std::size_t i = first; i < first + count; ++i)
+		if(cells[i] != outside)
+			++counts[block][cells[i]];
+}
+
+/// scatter of the indices of the points [first, first+count[, positions[block]: where the next index of each cell is written
+void scatterCells(const std::vector<unsigned int>& cells, const unsigned int outside, std::vector<std::vector<unsigned int> >& blockPositions,
+                  std::vector<unsigned int>& indices, const std::size_t block, const std::size_t first, const std::size_t count)
+{
+	std::vector<unsigned int>& positions = blockPositions[block];
+	for (std::size_t i = first; i < first + count; ++i)
+		if(cells[i] != outside)
+			indices[positions[cells[i]]++] = static_cast<unsigned int>(i);
+}
+}
+
 namespace Lidar
 {
 
@@ -61,23 +93,28 @@ void RasterSpatialIndexation::getApproximateRectangularNeighborhood( Neighborhoo
 
 
 	const int colMin = std::max( 0, std::min(colonne1, colonne2) );
-	const int colMax = std::min( m_griddedData.GetTaille().x - 1, std::max(colonne1, colonne2) );
+	const int colMax = std::min( m_taille.x - 1, std::max(colonne1, colonne2) );
 	const int ligMin = std::max( 0, std::min(ligne1, ligne2) );
-	const int ligMax = std::min( m_griddedData.GetTaille().y - 1, std::max(ligne1, ligne2) );
+	const int ligMax = std::min( m_taille.y - 1, std::max(ligne1, ligne2) );
 
 	if(colMax < colMin || ligMax < ligMin)
 		return;
 
-	const unsigned int evalNbPoints = (unsigned int)( (colMax-colMin+1)*(ligMax-ligMin+1)*m_resolution*m_nbPointsParM2 );
-	list.reserve(evalNbPoints);
+	appendCells(list, colMin, colMax, ligMin, ligMax);
+}
+
+void RasterSpatialIndexation::appendCells(NeighborhoodListeType &list, const int colMin, const int colMax, const int ligMin, const int ligMax) const
+{
+	//nombre exact de points : les cellules d'une colonne sont contiguës
+	std::size_t nbPoints = 0;
+	for (int col = colMin; col <= colMax; ++col)
+		nbPoints += cellEnd(col, ligMax) - cellBegin(col, ligMin);
+	list.reserve(list.size() + nbPoints);
 
 	for (int col = colMin; col <= colMax; ++col)
 	{
-		for (int lig = ligMin; lig <= ligMax; ++lig)
-		{
-			assert(col>=0 && lig>=0 && col<m_griddedData.GetTaille().x && lig<m_griddedData.GetTaille().y);
-			std::copy( m_griddedData( col,lig).begin(), m_griddedData( col,lig ).end(), std::back_inserter(list));
-		}
+		assert(col>=0 && ligMin>=0 && col<m_taille.x && ligMax<m_taille.y);
+		list.insert(list.end(), cellBegin(col, ligMin), cellEnd(col, ligMax));
 	}
 }
 
@@ -115,14 +152,50 @@ void RasterSpatialIndexation::allocateData()
 	int tailleX = static_cast< int > ( (x0max - x0min) / m_resolution + 1);
 	int tailleY = static_cast< int > ( (y0max - y0min) / m_resolution + 1);
 
-	//allocation du tableau :
-	m_griddedData = GriddedDataType( tailleX, tailleY );
+	//grille vide (remplie par fillCells) :
+	if(tailleX <= 0 || tailleY <= 0)
+		tailleX = tailleY = 0;
+	m_taille = TPoint2D<int>( tailleX, tailleY );
+	m_cellStarts.assign(nbCells() + 1, 0);
+	m_indices.clear();
 
 	//Ori de la géométrie :
 //	std::cout << "x0min=" << x0min << " , y0max=" << y0max << " , tailleX=" << tailleX << " , tailleY=" << tailleY << std::endl;
 	m_ori = Orientation2D( x0min, y0max, m_resolution, 0, tailleX, tailleY );
 }
 
+void RasterSpatialIndexation::fillCells(const std::vector<unsigned int>& cells)
+{
+	const unsigned int outside = nbCells();
+	const std::size_t count = cells.size();
+	//chaque thread a au moins autant de points que de cellules : les histogrammes (nbThreads x nbCells) coûtent moins que les points
+	const std::size_t blockSize = std::max<std::size_t>(fillBlockSize, outside);
+	const std::size_t nbThreads = nbParallelBlocks(count, blockSize);
+
+	//un histogramme des cellules par bloc de points
+	std::vector<std::vector<unsigned int> > counts(nbThreads);
+	parallelForBlocks(count, blockSize, boost::bind(&countCells, boost::cref(cells), outside, boost::ref(counts), _1, _2, _3));
+
+	//fusion : somme des préfixes sur les cellules, et dans chaque cellule sur les blocs (les histogrammes deviennent les positions d'écriture des blocs)
+	m_cellStarts.resize(outside + 1);
+	m_cellStarts[0] = 0;
+	for (unsigned int cell = 0; cell < outside; ++cell)
+	{
+		unsigned int start = m_cellStarts[cell];
+		for(std::size_t t = 0; t < nbThreads; ++t)
+		{
+			const unsigned int nbPoints = counts[t][cell];
+			counts[t][cell] = start;
+			start += nbPoints;
+		}
+		m_cellStarts[cell + 1] = start;
+	}
+
+	//dispersion : les blocs sont dans l'ordre des points, les indices restent croissants dans chaque cellule (comme en séquentiel)
+	m_indices.resize(m_cellStarts[outside]);
+	parallelForBlocks(count, blockSize, boost::bind(&scatterCells, boost::cref(cells), outside, boost::ref(counts), boost::ref(m_indices), _1, _2, _3));
+}
+
 void RasterSpatialIndexation::setResolution(const float resolution)
 {
 	m_resolution = resolution;
@@ -136,7 +209,7 @@ void RasterSpatialIndexation::setBBox(const TPoint2D<float> &bboxMin, const TPoi
 
 
 RasterSpatialIndexation::RasterSpatialIndexation(): //const XYZFunctionType& funcX, const XYZFunctionType& funcY, const XYZFunctionType& funcZ):
-	m_resolution(0), m_bboxMin(0,0), m_bboxMax(0,0)
+	m_taille(0,0), m_cellStarts(1, 0), m_resolution(0), m_bboxMin(0,0), m_bboxMax(0,0)
 //	m_funcX(funcX), m_funcY(funcY), m_funcZ(funcZ)
 {
 
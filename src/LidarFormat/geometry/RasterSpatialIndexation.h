@@ -77,7 +77,8 @@ class RasterSpatialIndexation
 {
 	public:
 		typedef std::vector<unsigned int> NeighborhoodListeType;
-		typedef TTableau2D<std::vector<unsigned int> > GriddedDataType;
+		///indices des points d'une cellule de la grille (contigus dans la grille CSR)
+		typedef std::vector<unsigned int>::const_iterator CellIterator;
 
 
 		typedef boost::function<bool(const float, const float, const float)> NeighborhoodFunctionType;
@@ -108,7 +109,10 @@ class RasterSpatialIndexation
 
 
 
-		const GriddedDataType& getSpatialIndexation() const { return m_griddedData; }
+		///Grille compressée (CSR) : les indices des points de la cellule (col,lig) sont [cellBegin, cellEnd[
+		const TPoint2D<int>& getTaille() const { return m_taille; }
+		CellIterator cellBegin(const int col, const int lig) const { return m_indices.begin() + m_cellStarts[cellIndex(col, lig)]; }
+		CellIterator cellEnd(const int col, const int lig) const { return m_indices.begin() + m_cellStarts[cellIndex(col, lig) + 1]; }
 		const Orientation2D getOri() const { return m_ori; }
 
 		const TPoint2D<float> getBBoxMin() const { return m_bboxMin; }
@@ -118,7 +122,7 @@ class RasterSpatialIndexation
 		/// Fonction qui lance l'indexation spatiale
 		void indexData();
 
-		static unsigned int m_nbPointsParM2; //maxi 10 points/m2 en aeroporté, à tuner en terrestre...
+		static unsigned int m_nbPointsParM2; //maxi 10 points/m2 en aeroporté, à tuner en terrestre... (densités très variables : voir LidarOctree)
 
 	protected:
 		///Fonctions propres à dériver
@@ -127,12 +131,26 @@ class RasterSpatialIndexation
 
 
 		///Fonctions propres
-		void allocateData(); //alloue la mémoire pour la grille d'indexation
+		void allocateData(); //calcule la géométrie de la grille d'indexation
+
+		///Remplissage de la grille à partir de la cellule de chaque point (cells[i] = cellIndex(col,lig), ou nbCells() si le point est hors de la grille) :
+		///histogrammes des cellules par bloc de points (en parallèle), fusion par somme des préfixes puis dispersion des indices dans un seul tableau
+		///le résultat ne dépend pas du nombre de threads
+		void fillCells(const std::vector<unsigned int>& cells);
+
+		unsigned int nbCells() const { return m_taille.x * m_taille.y; }
+		///les cellules d'une colonne sont consécutives, comme dans TTableau2D
+		unsigned int cellIndex(const int col, const int lig) const { return col * m_taille.y + lig; }
+
+		///Copie à la fin de list des indices des cellules [colMin,colMax]x[ligMin,ligMax] (un bloc contigu par colonne)
+		void appendCells(NeighborhoodListeType &list, const int colMin, const int colMax, const int ligMin, const int ligMax) const;
 
 
 		///Data
-		//grille d'indexation
-		GriddedDataType m_griddedData;
+		//grille d'indexation : taille, début des cellules dans m_indices (nbCells()+1 valeurs), indices des points par cellule
+		TPoint2D<int> m_taille;
+		std::vector<unsigned int> m_cellStarts;
+		std::vector<unsigned int> m_indices;
 
 		float m_resolution;
 
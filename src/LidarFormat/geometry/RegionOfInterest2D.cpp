@@ -40,13 +40,39 @@ Contributors:
 ***********************************************************************/
 
 
+#include <algorithm>
+#include <vector>
+
+#include <boost/bind.hpp>
+
 #include "LidarFormat/LidarDataContainer.h"
+#include "LidarFormat/LidarDataBuilder.h"
 #include "LidarFormat/geometry/LidarSpatialIndexation2D.h"
+#include "LidarFormat/tools/ParallelBlocks.h"
 
 #include "RegionOfInterest2D.h"
 
 using namespace Lidar;
 
+namespace
+{
+/// number of echoes under which the crop is copied by a single thread
+const std::size_t cropBlockSize = 1 << 16;
+
+/// copy of the echoes indices[first, first+count[ of lidarContainer with the cursor of the block in the cropped container
+void cropBlock(const LidarDataContainer& lidarContainer, const LidarSpatialIndexation2D::NeighborhoodListeType& indices,
+               std::vector<LidarAppendCursor>& cursors, const std::size_t block, const std::size_t first, const std::size_t count)
+{
+	LidarAppendCursor& cursor = cursors[block];
+	std::vector<char> record(lidarContainer.pointSize());
+	for(std::size_t i = first; i < first + count; ++i)
+	{
+		lidarContainer.exportRecords(&record[0], indices[i], 1);
+		cursor.append(&record[0]);
+	}
+}
+}
+
 
 shared_ptr<LidarDataContainer> RegionOfInterest2D::cropLidarData(const LidarDataContainer& lidarContainer, const LidarSpatialIndexation2D& spatialIndexation, const LidarCenteringTransfo& transfo) const
 {
@@ -68,11 +94,15 @@ shared_ptr<LidarDataContainer> RegionOfInterest2D::cropLidarData(const LidarData
 
 //	std::cout << "\tRécupération de la région d'intérêt OK..." << std::endl;
 
-	//Recopie des points d'interet dans le nouveau container
-	for(RasterSpatialIndexation::NeighborhoodListeType::iterator it = listeIndices.begin(); it != listeIndices.end(); ++it)
-	{
-		resultContainer->push_back(lidarContainer.rawData(*it));
-	}
+	//Recopie des points d'interet dans le nouveau container (un curseur par thread)
+	const std::size_t count = listeIndices.size();
+	const std::size_t threadSize = parallelBlockSize(count, cropBlockSize);
+	LidarDataBuilder builder(*resultContainer, count);
+	std::vector<LidarAppendCursor> cursors;
+	for(std::size_t first = 0; first < count || cursors.empty(); first += threadSize)
+		cursors.push_back(builder.cursor(first, std::min(threadSize, count - first)));
+	parallelForBlocks(count, cropBlockSize, boost::bind(&cropBlock, boost::cref(lidarContainer), boost::cref(listeIndices), boost::ref(cursors), _1, _2, _3));
+	builder.commit();
 
 //	std::cout << "\tNouveau container rempli taille=" << resultContainer->size() << "  OK..." << std::endl;
 
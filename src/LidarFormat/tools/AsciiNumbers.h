@@ -0,0 +1,415 @@
+/***********************************************************************
+
+This file is part of the LidarFormat project source files.
+
+LidarFormat is an open source library for efficiently handling 3D point 
+clouds with a variable number of attributes at runtime. 
+
+
+Homepage: 
+
+    http://code.google.com/p/lidarformat
+
+Copyright:
+
+    Institut Geographique National & CEMAGREF (2009)
+
+Author: 
+
+    Adrien Chauve
+
+Contributors:
+
+    Nicolas David, Olivier Tournaire, Bruno Vallet
+
+
+
+    LidarFormat is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LidarFormat is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with LidarFormat.  If not, see <http://www.gnu.org/licenses/>.
+
+***********************************************************************/
+
+
+#ifndef ASCIINUMBERS_H_
+#define ASCIINUMBERS_H_
+
+/**
+ * \brief Locale independent and allocation free conversion of numbers from and to text (ascii formats)
+ *
+ * The values are parsed from a range [it, end) of characters, it is moved after the value on success.
+ * Decimals of at most 19 significant digits with a small exponent (the usual lidar coordinates)
+ * are converted exactly without strtod, the others fall back to strtod in the "C" locale (whatever the global locale).
+ *
+ * The values are formatted at out (with enough room), which returns the end of the written value.
+ * Floating point values are written as printf("%.*g") (as ostream with a precision), the rare values
+ * whose rounding cannot be decided with a long double fall back to sprintf in the "C" locale.
+ *
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+#include <cmath>
+#include <limits>
+#include <string>
+#include <locale.h>
+#ifdef __APPLE__
+#include <xlocale.h>
+#endif
+
+#include <boost/cstdint.hpp>
+
+namespace Lidar
+{
+
+/// separators of the ascii formats: blanks, end of lines and , ; :
+inline bool isAsciiSeparator(const char c)
+{
+    return c == ' ' || c == '\n' || c == ',' || c == ';' || c == ':' || c == '\t' || c == '\r';
+}
+
+inline const char* skipAsciiSeparators(const char* it, const char* end)
+{
+    while(it != end && isAsciiSeparator(*it)) ++it;
+    return it;
+}
+
+inline const char* findAsciiSeparator(const char* it, const char* end)
+{
+    while(it != end && !isAsciiSeparator(*it)) ++it;
+    return it;
+}
+
+namespace detail
+{
+
+/// "C" locale of the conversions which fall back to the C library: the decimal point is '.' even if the global locale has a comma
+#ifdef _WIN32
+inline _locale_t cNumericLocale()
+{
+    static const _locale_t locale = _create_locale(LC_ALL, "C");
+    return locale;
+}
+#else
+inline locale_t cNumericLocale()
+{
+    static const locale_t locale = newlocale(LC_ALL_MASK, "C", static_cast<locale_t>(0));
+    return locale;
+}
+#endif
+
+/// strtod in the "C" locale
+inline double strtodC(const char* str, char** strEnd)
+{
+#ifdef _WIN32
+    return _strtod_l(str, strEnd, cNumericLocale());
+#else
+    return strtod_l(str, strEnd, cNumericLocale());
+#endif
+}
+
+/// sprintf(out, "%.*g", precision, value) in the "C" locale, returns the number of characters written
+inline int sprintfGeneralC(char* out, const int precision, const double value)
+{
+#ifdef _WIN32
+    return _sprintf_l(out, "%.*g", cNumericLocale(), precision, value);
+#else
+    // the locale of the calling thread only
+    const locale_t previous = uselocale(cNumericLocale());
+    const int n = std::sprintf(out, "%.*g", precision, value);
+    uselocale(previous);
+    return n;
+#endif
+}
+
+/// absolute value and sign of an integer, returns false if the absolute value does not fit in an uint64
+inline bool parseIntegerValue(const char*& it, const char* end, boost::uint64_t& value, bool& negative)
+{
+    const char* p = it;
+    negative = false;
+    if(p != end && (*p == '-' || *p == '+'))
+        negative = (*p++ == '-');
+    if(p == end || *p < '0' || *p > '9')
+        return false;
+
+    const boost::uint64_t maxValue = std::numeric_limits<boost::uint64_t>::max();
+    boost::uint64_t v = 0;
+    for(; p != end && *p >= '0' && *p <= '9'; ++p)
+    {
+        const unsigned int digit = *p - '0';
+        if(v > (maxValue - digit) / 10)
+            return false;
+        v = 10*v + digit;
+    }
+    if(p != end && !isAsciiSeparator(*p))
+        return false;
+
+    value = v;
+    it = p;
+    return true;
+}
+
+/// strtod in the "C" locale on a null terminated copy of the value (on the stack for the usual lengths)
+inline bool parseDoubleFallback(const char*& it, const char* end, double& value)
+{
+    const char* valueEnd = findAsciiSeparator(it, end);
+    const std::size_t length = valueEnd - it;
+    char buffer[64];
+    std::string longValue;
+    char* str = buffer;
+    if(length < sizeof(buffer))
+    {
+        std::memcpy(buffer, it, length);
+        buffer[length] = '\0';
+    }
+    else
+    {
+        longValue.assign(it, valueEnd);
+        str = &longValue[0];
+    }
+
+    char* strEnd = 0;
+    value = strtodC(str, &strEnd);
+    if(length == 0 || strEnd != str + length)
+        return false;
+    it = valueEnd;
+    return true;
+}
+
+} //namespace detail
+
+/// integer values (int8 and uint8 are read as numbers, not as characters), returns false if the value is out of the range of T
+template<typename T>
+inline bool parseAsciiValue(const char*& it, const char* end, T& value)
+{
+    const char* p = it;
+    boost::uint64_t v;
+    bool negative;
+    if(!detail::parseIntegerValue(p, end, v, negative))
+        return false;
+
+    if(!negative || v == 0)
+    {
+        if(v > static_cast<boost::uint64_t>(std::numeric_limits<T>::max()))
+            return false;
+        value = static_cast<T>(v);
+    }
+    else
+    {
+        // -(max+1) is the min of the signed types
+        if(!std::numeric_limits<T>::is_signed || v - 1 > static_cast<boost::uint64_t>(std::numeric_limits<T>::max()))
+            return false;
+        value = static_cast<T>(-static_cast<boost::int64_t>(v - 1) - 1);
+    }
+    it = p;
+    return true;
+}
+
+template<>
+inline bool parseAsciiValue<double>(const char*& it, const char* end, double& value)
+{
+    // exact powers of ten in a double
+    static const double powersOf10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+    const char* p = it;
+    bool negative = false;
+    if(p != end && (*p == '-' || *p == '+'))
+        negative = (*p++ == '-');
+
+    // mantissa (at most 19 significant digits) and decimal exponent
+    boost::uint64_t mantissa = 0;
+    int exponent = 0, nbDigits = 0;
+    bool hasDigits = false, truncated = false;
+    for(; p != end && *p >= '0' && *p <= '9'; ++p, hasDigits = true)
+    {
+        if(nbDigits < 19) { mantissa = 10*mantissa + (*p - '0'); if(mantissa) ++nbDigits; }
+        else { ++exponent; truncated = truncated || *p != '0'; }
+    }
+    if(p != end && *p == '.')
+    {
+        for(++p; p != end && *p >= '0' && *p <= '9'; ++p, hasDigits = true)
+        {
+            if(nbDigits < 19) { mantissa = 10*mantissa + (*p - '0'); if(mantissa) ++nbDigits; --exponent; }
+            else truncated = truncated || *p != '0';
+        }
+    }
+    if(hasDigits && p != end && (*p == 'e' || *p == 'E'))
+    {
+        ++p;
+        bool negativeExponent = false;
+        if(p != end && (*p == '-' || *p == '+'))
+            negativeExponent = (*p++ == '-');
+        if(p == end || *p < '0' || *p > '9')
+            return false;
+        int e = 0;
+        for(; p != end && *p >= '0' && *p <= '9'; ++p)
+            if(e < 100000) e = 10*e + (*p - '0');
+        exponent += negativeExponent ? -e : e;
+    }
+
+    // nan, inf, hexadecimal, garbage... or not exactly representable with a single operation
+    if(!hasDigits || (p != end && !isAsciiSeparator(*p)) || truncated ||
+       mantissa > (boost::uint64_t(1) << 53) || exponent < -22 || exponent > 22)
+        return detail::parseDoubleFallback(it, end, value);
+
+    // both operands are exact: the result is correctly rounded
+    value = static_cast<double>(mantissa);
+    value = exponent < 0 ? value / powersOf10[-exponent] : value * powersOf10[exponent];
+    if(negative) value = -value;
+    it = p;
+    return true;
+}
+
+template<>
+inline bool parseAsciiValue<float>(const char*& it, const char* end, float& value)
+{
+    double v;
+    if(!parseAsciiValue<double>(it, end, v))
+        return false;
+    value = static_cast<float>(v);
+    return true;
+}
+
+namespace detail
+{
+
+inline char* formatUnsignedValue(char* out, boost::uint64_t value)
+{
+    char digits[20];
+    int n = 0;
+    do { digits[n++] = char('0' + value % 10); value /= 10; } while(value);
+    while(n) *out++ = digits[--n];
+    return out;
+}
+
+inline char* formatSignedValue(char* out, const boost::int64_t value)
+{
+    if(value >= 0)
+        return formatUnsignedValue(out, value);
+    *out++ = '-';
+    return formatUnsignedValue(out, boost::uint64_t(0) - static_cast<boost::uint64_t>(value));
+}
+
+} //namespace detail
+
+/// integer values (int8 and uint8 are written as numbers, not as characters), the precision is ignored
+template<typename T>
+inline char* formatAsciiValue(char* out, const T value, const int /*precision*/)
+{
+    return std::numeric_limits<T>::is_signed ? detail::formatSignedValue(out, static_cast<boost::int64_t>(value))
+                                             : detail::formatUnsignedValue(out, static_cast<boost::uint64_t>(value));
+}
+
+/// same output as printf("%.*g", precision, value)
+template<>
+inline char* formatAsciiValue<double>(char* out, const double value, const int precision)
+{
+    static const long double powersOf10[] = {1e0L, 1e1L, 1e2L, 1e3L, 1e4L, 1e5L, 1e6L, 1e7L, 1e8L, 1e9L, 1e10L, 1e11L,
+                                             1e12L, 1e13L, 1e14L, 1e15L, 1e16L, 1e17L, 1e18L, 1e19L, 1e20L, 1e21L, 1e22L};
+
+    if(value == 0)
+    {
+        if(1/value < 0) *out++ = '-';
+        *out++ = '0';
+        return out;
+    }
+
+    // value = digits * 10^(exponent-precision+1), with precision digits, rounded to nearest
+    // the scaling has a single rounding, the value falls back to sprintf if it is too close to a half
+    const double absValue = std::fabs(value);
+    bool exact = precision >= 1 && precision <= 17 && absValue <= std::numeric_limits<double>::max();
+    int exponent = exact ? static_cast<int>(std::floor(std::log10(absValue))) : 0;
+    boost::uint64_t digits = 0;
+    for(int attempt = 0; exact && attempt < 2; ++attempt)
+    {
+        const int scale = precision - 1 - exponent;
+        if(scale < -22 || scale > 22)
+        {
+            exact = false;
+            break;
+        }
+        const long double scaled = scale >= 0 ? absValue * powersOf10[scale] : absValue / powersOf10[-scale];
+        if(scaled < powersOf10[precision-1]) { --exponent; continue; }
+        if(scaled >= powersOf10[precision]) { ++exponent; continue; }
+
+        const long double integerPart = std::floor(scaled);
+        const long double fraction = scaled - integerPart;
+        const long double margin = 2 * powersOf10[precision] * std::numeric_limits<long double>::epsilon();
+        if(std::fabs(fraction - 0.5L) <= margin)
+        {
+            exact = false;
+            break;
+        }
+        digits = static_cast<boost::uint64_t>(integerPart) + (fraction > 0.5L ? 1 : 0);
+        if(digits == static_cast<boost::uint64_t>(powersOf10[precision]))
+        {
+            digits /= 10;
+            ++exponent;
+        }
+        break;
+    }
+    if(!exact || digits == 0)
+        return out + detail::sprintfGeneralC(out, precision, value);
+
+    char buffer[20];
+    detail::formatUnsignedValue(buffer, digits);
+    int nbDigits = precision;
+    while(nbDigits > 1 && buffer[nbDigits-1] == '0')
+        --nbDigits;
+
+    if(value < 0) *out++ = '-';
+    if(exponent >= -4 && exponent < precision)
+    {
+        if(exponent < 0)
+        {
+            *out++ = '0';
+            *out++ = '.';
+            for(int i = -1; i > exponent; --i) *out++ = '0';
+            std::memcpy(out, buffer, nbDigits);
+            return out + nbDigits;
+        }
+        std::memcpy(out, buffer, exponent + 1);
+        out += exponent + 1;
+        if(nbDigits > exponent + 1)
+        {
+            *out++ = '.';
+            std::memcpy(out, buffer + exponent + 1, nbDigits - exponent - 1);
+            out += nbDigits - exponent - 1;
+        }
+        return out;
+    }
+
+    *out++ = buffer[0];
+    if(nbDigits > 1)
+    {
+        *out++ = '.';
+        std::memcpy(out, buffer + 1, nbDigits - 1);
+        out += nbDigits - 1;
+    }
+    *out++ = 'e';
+    *out++ = exponent < 0 ? '-' : '+';
+    const int absExponent = exponent < 0 ? -exponent : exponent;
+    if(absExponent < 10) *out++ = '0';
+    return detail::formatUnsignedValue(out, absExponent);
+}
+
+template<>
+inline char* formatAsciiValue<float>(char* out, const float value, const int precision)
+{
+    return formatAsciiValue<double>(out, value, precision);
+}
+
+} //namespace Lidar
+
+#endif /* ASCIINUMBERS_H_ */
@@ -39,7 +39,13 @@ Contributors:
 
 ***********************************************************************/
 
+#include <algorithm>
+
+#include <boost/bind.hpp>
+
+#include "LidarFormat/LidarDataContainer.h"
 #include "LidarFormat/tools/AttributeBounds.h"
+#include "LidarFormat/tools/ParallelBlocks.h"
 
 namespace Lidar
 {
@@ -71,7 +77,7 @@ void FonctorMultiAbstractBound::AddAttribute(const std::string & attrib_name, co
     }
 }
 
-void FonctorMultiAbstractBound::operator()(const Lidar::LidarEcho& echo)
+void FonctorMultiAbstractBound::operator()(const Lidar::LidarConstEchoRef& echo)
 {
     for(std::vector<AbstractBound*>::iterator it=mvp_attrib.begin(); it!=mvp_attrib.end(); it++)
         (*it)->Add(echo);
@@ -84,5 +90,107 @@ void FonctorMultiAbstractBound::Print()
         (*it)->Print();
 }
 
+/// blocks of echoes processed by a thread
+static const std::size_t boundsBlockSize = 1 << 16;
+
+/// bounds of contiguous values: 4 independent lanes, without branches, that the compiler can map on simd registers
+template<typename T>
+static void contiguousBounds(const T* values, const std::size_t count, T& min, T& max, double& sum)
+{
+    T laneMin[4], laneMax[4];
+    double laneSum[4];
+    for(int l = 0; l < 4; ++l)
+    {
+        laneMin[l] = min; laneMax[l] = max; laneSum[l] = 0.;
+    }
+
+    std::size_t i = 0;
+    for(; i + 4 <= count; i += 4)
+        for(int l = 0; l < 4; ++l)
+        {
+            const T value = values[i + l];
+            laneMin[l] = value < laneMin[l] ? value : laneMin[l];
+            laneMax[l] = laneMax[l] < value ? value : laneMax[l];
+            laneSum[l] += value;
+        }
+    for(; i < count; ++i)
+    {
+        const T value = values[i];
+        laneMin[0] = value < laneMin[0] ? value : laneMin[0];
+        laneMax[0] = laneMax[0] < value ? value : laneMax[0];
+        laneSum[0] += value;
+    }
+
+    for(int l = 0; l < 4; ++l)
+    {
+        if(laneMin[l] < min) min = laneMin[l];
+        if(laneMax[l] > max) max = laneMax[l];
+        sum += laneSum[l];
+    }
+}
+
+/// bounds of the echoes [first, first+count[ of an attribute (see LidarDataContainer::applyOnAttribute)
+struct BoundsKernel
+{
+    BoundsKernel(const std::size_t first, const std::size_t count, const bool contiguous, AttributeBoundValues& bounds):
+        m_first(first), m_count(count), m_contiguous(contiguous), m_bounds(bounds)
+    {
+    }
+
+    template<typename T>
+    void operator()(const LidarConstIteratorAttribute<T> begin, const LidarConstIteratorAttribute<T>)
+    {
+        // same initial values as TBound
+        T min = std::numeric_limits<T>::max();
+        T max = std::numeric_limits<T>::is_integer ? std::numeric_limits<T>::min() : -std::numeric_limits<T>::max();
+        double sum = 0.;
+        if(m_contiguous && m_count)
+            contiguousBounds(&begin[m_first], m_count, min, max, sum);
+        else
+            for(LidarConstIteratorAttribute<T> it = begin + m_first; it != begin + (m_first + m_count); ++it)
+            {
+                if(*it < min) min = *it;
+                if(*it > max) max = *it;
+                sum += *it;
+            }
+
+        AttributeBoundValues bounds;
+        bounds.min = min; bounds.max = max; bounds.sum = sum; bounds.count = m_count;
+        m_bounds.merge(bounds);
+    }
+
+    std::size_t m_first, m_count;
+    bool m_contiguous;
+    AttributeBoundValues& m_bounds;
+};
+
+/// bounds of the echoes [first, first+count[ in blockBounds[block]
+static void computeBoundsBlock(const LidarDataContainer& lidarContainer, const std::vector<std::string>& attributeNames,
+                               std::vector<std::vector<AttributeBoundValues> >& blockBounds, const std::size_t block, const std::size_t first, const std::size_t count)
+{
+    std::vector<AttributeBoundValues>& bounds = blockBounds[block];
+    const bool contiguous = lidarContainer.layout() == LidarDataContainer::columnar;
+    bounds.assign(attributeNames.size(), AttributeBoundValues());
+    for(std::size_t i = 0; i < attributeNames.size(); ++i)
+    {
+        BoundsKernel kernel(first, count, contiguous, bounds[i]);
+        lidarContainer.applyOnAttribute(attributeNames[i], kernel);
+    }
+}
+
+void computeAttributeBounds(const LidarDataContainer& lidarContainer, const std::vector<std::string>& attributeNames, std::vector<AttributeBoundValues>& bounds)
+{
+    // partial bounds of each block, merged in bounds
+    const std::size_t count = lidarContainer.size();
+    std::vector<std::vector<AttributeBoundValues> > partialBounds(nbParallelBlocks(count, boundsBlockSize));
+    parallelForBlocks(count, boundsBlockSize, boost::bind(&computeBoundsBlock, boost::cref(lidarContainer), boost::cref(attributeNames),
+                                                          boost::ref(partialBounds), _1, _2, _3));
+
+    bounds.swap(partialBounds[0]);
+    for(std::size_t t = 1; t < partialBounds.size(); ++t)
+        for(std::size_t i = 0; i < attributeNames.size(); ++i)
+            bounds[i].merge(partialBounds[t][i]);
+}
+
 } //namespace Lidar
 
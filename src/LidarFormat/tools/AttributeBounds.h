@@ -49,7 +49,10 @@ Contributors:
  */
 
 #include <iostream>
-#include "LidarFormat/LidarEcho.h"
+#include <limits>
+#include <string>
+#include <vector>
+#include "LidarFormat/LidarEchoRef.h"
 
 namespace Lidar
 {
@@ -58,7 +61,7 @@ class AbstractBound
 {
 public:
     AbstractBound(const EnumLidarDataType type);
-    virtual void Add(const Lidar::LidarEcho& echo) = 0;
+    virtual void Add(const Lidar::LidarConstEchoRef& echo) = 0;
     virtual void Print() = 0;
     virtual void Get(double & min, double & max) = 0;
 
@@ -79,7 +82,7 @@ public:
         if(!std::numeric_limits<T>::is_integer) m_max=-m_min;
     }
 
-    void Add(const Lidar::LidarEcho& echo)
+    void Add(const Lidar::LidarConstEchoRef& echo)
     {
         T val = echo.value<T>(m_decalage);
         if(val < m_min) m_min = val;
@@ -113,11 +116,38 @@ struct FonctorMultiAbstractBound
 {
     FonctorMultiAbstractBound();
     void AddAttribute(const std::string & attrib_name, const unsigned int decalage, const EnumLidarDataType type);
-    void operator()(const Lidar::LidarEcho& echo);
+    void operator()(const Lidar::LidarConstEchoRef& echo);
     void Print();
     std::vector<AbstractBound*> mvp_attrib;
 };
 
+class LidarDataContainer;
+
+/// min, max, sum and number of the values of an attribute (the results of blocks of echoes are merged)
+struct AttributeBoundValues
+{
+    AttributeBoundValues():
+        min(std::numeric_limits<double>::max()), max(-std::numeric_limits<double>::max()), sum(0.), count(0)
+    {
+    }
+
+    void merge(const AttributeBoundValues& rhs)
+    {
+        if(rhs.min < min) min = rhs.min;
+        if(rhs.max > max) max = rhs.max;
+        sum += rhs.sum;
+        count += rhs.count;
+    }
+
+    double min, max, sum;
+    std::size_t count;
+};
+
+/// bounds of the attributes of the container, one typed kernel per attribute (same results as TBound)
+/// blocks of echoes are processed on several threads; only the columns of the columnar layout are read by vectorizable loops,
+/// the interleaved records are read value by value with the stride of a record
+void computeAttributeBounds(const LidarDataContainer& lidarContainer, const std::vector<std::string>& attributeNames, std::vector<AttributeBoundValues>& bounds);
+
 } //namespace Lidar
 
 #endif /*ATTRIBUTEBOUNDS_H_*/
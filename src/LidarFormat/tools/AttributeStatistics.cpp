@@ -0,0 +1,254 @@
+/***********************************************************************
+
+This file is part of the LidarFormat project source files.
+
+LidarFormat is an open source library for efficiently handling 3D point 
+clouds with a variable number of attributes at runtime. 
+
+
+Homepage: 
+
+    http://code.google.com/p/lidarformat
+
+Copyright:
+
+    Institut Geographique National & CEMAGREF (2009)
+
+Author: 
+
+    Adrien Chauve
+
+Contributors:
+
+    Nicolas David, Olivier Tournaire, Bruno Vallet
+
+
+
+    LidarFormat is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LidarFormat is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with LidarFormat.  If not, see <http://www.gnu.org/licenses/>.
+
+***********************************************************************/
+
+
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <boost/bind.hpp>
+
+#include "LidarFormat/LidarDataContainer.h"
+#include "LidarFormat/tools/AttributeBounds.h"
+#include "LidarFormat/tools/AttributeStatistics.h"
+#include "LidarFormat/tools/ParallelBlocks.h"
+
+namespace Lidar
+{
+
+AttributeStatistics::AttributeStatistics():
+    count(0), nbNonFinite(0), min(0.), max(0.), shift(0.), sum(0.), sumSquares(0.), histogramMin(0.), binWidth(1.), exactBins(false)
+{
+}
+
+AttributeStatistics::AttributeStatistics(const double minValue, const double maxValue, const bool integer, const std::size_t nbBins):
+    count(0), nbNonFinite(0), min(minValue), max(maxValue), shift(0.5 * (minValue + maxValue)), sum(0.), sumSquares(0.), histogramMin(minValue), binWidth(1.),
+    exactBins(integer && maxValue - minValue < maxExactBins)
+{
+    if(max < min)
+        return; // no values
+    if(exactBins)
+        histogram.assign(static_cast<std::size_t>(max - min) + 1, 0);
+    else
+    {
+        histogram.assign(std::max<std::size_t>(1, nbBins), 0);
+        binWidth = max > min ? (max - min) / histogram.size() : 1.;
+    }
+}
+
+void AttributeStatistics::merge(const AttributeStatistics& rhs)
+{
+    // same bounds and histogram: accumulators of the same attribute
+    count += rhs.count;
+    nbNonFinite += rhs.nbNonFinite;
+    sum += rhs.sum;
+    sumSquares += rhs.sumSquares;
+    for(std::size_t i = 0; i < histogram.size(); ++i)
+        histogram[i] += rhs.histogram[i];
+}
+
+double AttributeStatistics::mean() const
+{
+    return count ? shift + sum / count : 0.;
+}
+
+double AttributeStatistics::variance() const
+{
+    if(!count)
+        return 0.;
+    const double meanShifted = sum / count;
+    return std::max(0., sumSquares / count - meanShifted * meanShifted);
+}
+
+double AttributeStatistics::stddev() const
+{
+    return std::sqrt(variance());
+}
+
+double AttributeStatistics::quantile(const double q) const
+{
+    if(!count)
+        return 0.;
+    const double rank = std::min(1., std::max(0., q)) * count;
+    double cumulated = 0.;
+    for(std::size_t i = 0; i < histogram.size(); ++i)
+    {
+        if(histogram[i] == 0 || cumulated + histogram[i] < rank)
+        {
+            cumulated += histogram[i];
+            continue;
+        }
+        if(exactBins)
+            return binMin(i);
+        return std::min(max, binMin(i) + (rank - cumulated) / histogram[i] * binWidth);
+    }
+    return max;
+}
+
+
+/// blocks of echoes processed by a thread
+static const std::size_t statisticsBlockSize = 1 << 16;
+
+/// accumulates the values of the echoes [first, first+count[ of an attribute (see LidarDataContainer::applyOnAttribute)
+struct StatisticsKernel
+{
+    StatisticsKernel(const std::size_t first, const std::size_t count, AttributeStatistics& statistics):
+        m_first(first), m_count(count), m_statistics(statistics)
+    {
+    }
+
+    template<typename T>
+    void operator()(const LidarConstIteratorAttribute<T> begin, const LidarConstIteratorAttribute<T>)
+    {
+        if(m_statistics.histogram.empty())
+            return;
+        const double shift = m_statistics.shift, histogramMin = m_statistics.histogramMin, inverseWidth = 1. / m_statistics.binWidth;
+        const std::size_t lastBin = m_statistics.histogram.size() - 1;
+        std::size_t* const histogram = &m_statistics.histogram[0];
+
+        std::size_t count = 0, nbNonFinite = 0;
+        double sum = 0., sumSquares = 0.;
+        const LidarConstIteratorAttribute<T> end = begin + (m_first + m_count);
+        for(LidarConstIteratorAttribute<T> it = begin + m_first; it != end; ++it)
+        {
+            const double value = *it;
+            if(!(std::fabs(value) <= std::numeric_limits<double>::max()))
+            {
+                ++nbNonFinite; // NaN or infinite
+                continue;
+            }
+            ++count;
+            const double shifted = value - shift;
+            sum += shifted;
+            sumSquares += shifted * shifted;
+            const double bin = (value - histogramMin) * inverseWidth;
+            // a range wider than the largest double gives an infinite width and a NaN bin
+            ++histogram[!(bin > 0.) ? 0 : bin >= lastBin ? lastBin : static_cast<std::size_t>(bin)];
+        }
+        m_statistics.count += count;
+        m_statistics.nbNonFinite += nbNonFinite;
+        m_statistics.sum += sum;
+        m_statistics.sumSquares += sumSquares;
+    }
+
+    std::size_t m_first, m_count;
+    AttributeStatistics& m_statistics;
+};
+
+/// statistics of the echoes [first, first+count[ accumulated in blockStatistics[block]
+static void computeStatisticsBlock(const LidarDataContainer& lidarContainer, std::vector<std::vector<AttributeStatistics> >& blockStatistics,
+                                   const std::size_t block, const std::size_t first, const std::size_t count)
+{
+    std::vector<AttributeStatistics>& statistics = blockStatistics[block];
+    for(std::size_t i = 0; i < statistics.size(); ++i)
+    {
+        StatisticsKernel kernel(first, count, statistics[i]);
+        lidarContainer.applyOnAttribute(statistics[i].name, kernel);
+    }
+}
+
+/// bounds of the finite values of an attribute, when computeAttributeBounds found an infinite one
+struct FiniteBoundsKernel
+{
+    FiniteBoundsKernel(AttributeBoundValues& bounds): m_bounds(bounds)
+    {
+    }
+
+    template<typename T>
+    void operator()(const LidarConstIteratorAttribute<T> begin, const LidarConstIteratorAttribute<T> end)
+    {
+        m_bounds = AttributeBoundValues();
+        for(LidarConstIteratorAttribute<T> it = begin; it != end; ++it)
+        {
+            const double value = *it;
+            if(!(std::fabs(value) <= std::numeric_limits<double>::max()))
+                continue;
+            if(value < m_bounds.min) m_bounds.min = value;
+            if(value > m_bounds.max) m_bounds.max = value;
+        }
+    }
+
+    AttributeBoundValues& m_bounds;
+};
+
+template<EnumLidarDataType T>
+struct IsIntegerFunctor
+{
+    bool operator()()
+    {
+        return std::numeric_limits<typename LidarEnumTypeTraits<T>::type>::is_integer;
+    }
+};
+
+void computeAttributeStatistics(const LidarDataContainer& lidarContainer, const std::vector<std::string>& attributeNames,
+                                std::vector<AttributeStatistics>& statistics, const std::size_t nbBins)
+{
+    // the bounds give the ranges of the histograms
+    std::vector<AttributeBoundValues> bounds;
+    computeAttributeBounds(lidarContainer, attributeNames, bounds);
+    for(std::size_t i = 0; i < attributeNames.size(); ++i)
+        if(std::fabs(bounds[i].min) == std::numeric_limits<double>::infinity() || std::fabs(bounds[i].max) == std::numeric_limits<double>::infinity())
+        {
+            FiniteBoundsKernel kernel(bounds[i]);
+            lidarContainer.applyOnAttribute(attributeNames[i], kernel);
+        }
+
+    statistics.clear();
+    for(std::size_t i = 0; i < attributeNames.size(); ++i)
+    {
+        const bool integer = apply<IsIntegerFunctor, bool>(lidarContainer.getAttributeType(attributeNames[i]));
+        statistics.push_back(AttributeStatistics(bounds[i].min, bounds[i].max, integer, nbBins));
+        statistics.back().name = attributeNames[i];
+    }
+
+    // empty accumulators for each block, merged in statistics
+    const std::size_t count = lidarContainer.size();
+    std::vector<std::vector<AttributeStatistics> > threadStatistics(nbParallelBlocks(count, statisticsBlockSize), statistics);
+    parallelForBlocks(count, statisticsBlockSize, boost::bind(&computeStatisticsBlock, boost::cref(lidarContainer), boost::ref(threadStatistics), _1, _2, _3));
+
+    statistics.swap(threadStatistics[0]);
+    for(std::size_t t = 1; t < threadStatistics.size(); ++t)
+        for(std::size_t i = 0; i < statistics.size(); ++i)
+            statistics[i].merge(threadStatistics[t][i]);
+}
+
+} //namespace Lidar
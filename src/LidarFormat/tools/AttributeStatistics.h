@@ -0,0 +1,107 @@
+/***********************************************************************
+
+This file is part of the LidarFormat project source files.
+
+LidarFormat is an open source library for efficiently handling 3D point 
+clouds with a variable number of attributes at runtime. 
+
+
+Homepage: 
+
+    http://code.google.com/p/lidarformat
+
+Copyright:
+
+    Institut Geographique National & CEMAGREF (2009)
+
+Author: 
+
+    Adrien Chauve
+
+Contributors:
+
+    Nicolas David, Olivier Tournaire, Bruno Vallet
+
+
+
+    LidarFormat is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LidarFormat is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with LidarFormat.  If not, see <http://www.gnu.org/licenses/>.
+
+***********************************************************************/
+
+
+
+#ifndef ATTRIBUTESTATISTICS_H_
+#define ATTRIBUTESTATISTICS_H_
+
+#include <string>
+#include <vector>
+
+namespace Lidar
+{
+
+class LidarDataContainer;
+
+/**
+* @brief Statistics of the values of an attribute: count, bounds, mean, variance, histogram and approximate quantiles
+*
+* Accumulated by blocks of echoes (one accumulator per thread) and merged, see computeAttributeStatistics.
+* The histogram has nbBins equal bins between min and max, or one bin per value for integer attributes
+* with at most maxExactBins different values (exact quantiles).
+* NaN and infinite values are not counted in the statistics nor in the bounds of the histogram (see nbNonFinite).
+*
+*/
+struct AttributeStatistics
+{
+    /// bins of the histograms of integer attributes with one bin per value
+    static const std::size_t maxExactBins = 1 << 16;
+
+    AttributeStatistics();
+    /// empty accumulator with a histogram of the values in [min, max]
+    AttributeStatistics(const double minValue, const double maxValue, const bool integer, const std::size_t nbBins);
+
+    void merge(const AttributeStatistics& rhs);
+
+    double mean() const;
+    double variance() const;
+    double stddev() const;
+
+    /// value below which a fraction q of the values are (interpolated in the bin for real attributes)
+    double quantile(const double q) const;
+
+    /// lower bound of the values of a bin
+    double binMin(const std::size_t bin) const { return histogramMin + bin * binWidth; }
+
+    std::string name;
+    std::size_t count;
+    /// NaN and infinite values
+    std::size_t nbNonFinite;
+    double min, max;
+    /// sums of (value-shift) and (value-shift)^2, shift in the middle of the bounds for precision
+    double shift, sum, sumSquares;
+
+    std::vector<std::size_t> histogram;
+    double histogramMin, binWidth;
+    /// one bin per integer value
+    bool exactBins;
+};
+
+/// statistics of the attributes of the container, with histograms of nbBins bins (one bin per value for small integer ranges)
+/// the bounds (histogram ranges) are computed first with computeAttributeBounds, then all the other statistics of all the
+/// attributes are accumulated in a single pass, on several threads
+void computeAttributeStatistics(const LidarDataContainer& lidarContainer, const std::vector<std::string>& attributeNames,
+                                std::vector<AttributeStatistics>& statistics, const std::size_t nbBins = 100);
+
+} //namespace Lidar
+
+#endif /* ATTRIBUTESTATISTICS_H_ */
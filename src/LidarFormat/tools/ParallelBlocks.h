@@ -0,0 +1,135 @@
+/***********************************************************************
+
+This file is part of the LidarFormat project source files.
+
+LidarFormat is an open source library for efficiently handling 3D point 
+clouds with a variable number of attributes at runtime. 
+
+
+Homepage: 
+
+    http://code.google.com/p/lidarformat
+
+Copyright:
+
+    Institut Geographique National & CEMAGREF (2009)
+
+Author: 
+
+    Adrien Chauve
+
+Contributors:
+
+    Nicolas David, Olivier Tournaire, Bruno Vallet
+
+
+
+    LidarFormat is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LidarFormat is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with LidarFormat.  If not, see <http://www.gnu.org/licenses/>.
+
+***********************************************************************/
+
+
+#ifndef PARALLELBLOCKS_H_
+#define PARALLELBLOCKS_H_
+
+/**
+ * \brief Loops over the items [0, count[ split in consecutive blocks processed concurrently
+ *
+ * There is at most one block per core and each block has at least blockSize items
+ * (a single block, in the calling thread, when count < 2*blockSize). The blocks have
+ * parallelBlockSize(count, blockSize) items, except the last one which may be smaller.
+ *
+ */
+
+#include <algorithm>
+#include <vector>
+
+#include <boost/exception_ptr.hpp>
+#include <boost/thread.hpp>
+
+namespace Lidar
+{
+
+/// number of items of the blocks (the last one may be smaller), at least 1
+inline std::size_t parallelBlockSize(const std::size_t count, const std::size_t blockSize)
+{
+    const std::size_t nbThreads = std::max<std::size_t>(1, std::min<std::size_t>(boost::thread::hardware_concurrency(), count / std::max<std::size_t>(1, blockSize)));
+    return std::max<std::size_t>(1, (count + nbThreads - 1) / nbThreads);
+}
+
+/// number of blocks, 1 when there is no item
+inline std::size_t nbParallelBlocks(const std::size_t count, const std::size_t blockSize)
+{
+    const std::size_t size = parallelBlockSize(count, blockSize);
+    return std::max<std::size_t>(1, (count + size - 1) / size);
+}
+
+namespace detail
+{
+/// f(block, first, size) run by a thread, its exception is kept in error (an exception must not leave the function of a thread)
+template<typename TFunction>
+struct ParallelBlock
+{
+    ParallelBlock(const TFunction& f, const std::size_t block, const std::size_t first, const std::size_t size, boost::exception_ptr& error):
+        m_f(f), m_block(block), m_first(first), m_size(size), m_error(error) {}
+
+    void operator()()
+    {
+        try
+        {
+            m_f(m_block, m_first, m_size);
+        }
+        catch(...)
+        {
+            m_error = boost::current_exception();
+        }
+    }
+
+    TFunction m_f;
+    std::size_t m_block, m_first, m_size;
+    boost::exception_ptr& m_error;
+};
+}
+
+/// calls f(block, first, size) on each block [first, first+size[ (f(0, 0, 0) when there is no item), the first block in the calling thread,
+/// returns when all the blocks are done; f is copied for each thread (boost::ref for the outputs of a bind)
+/// the exception of the first block which failed is rethrown once all the blocks are done
+template<typename TFunction>
+void parallelForBlocks(const std::size_t count, const std::size_t blockSize, TFunction f)
+{
+    const std::size_t size = parallelBlockSize(count, blockSize);
+    const std::size_t nbBlocks = nbParallelBlocks(count, blockSize);
+    std::vector<boost::exception_ptr> errors(nbBlocks);
+    boost::thread_group threads;
+    try
+    {
+        for(std::size_t block = 1; block < nbBlocks; ++block)
+            threads.create_thread(detail::ParallelBlock<TFunction>(f, block, block*size, std::min(size, count - block*size), errors[block]));
+    }
+    catch(...)
+    {
+        threads.join_all();
+        throw;
+    }
+    detail::ParallelBlock<TFunction>(f, 0, 0, std::min(size, count), errors[0])();
+    threads.join_all();
+
+    for(std::size_t block = 0; block < nbBlocks; ++block)
+        if(errors[block])
+            boost::rethrow_exception(errors[block]);
+}
+
+} //namespace Lidar
+
+#endif /* PARALLELBLOCKS_H_ */
@@ -43,9 +43,12 @@ Contributors:
 #ifndef UNSORTEDASSOCMAP_H_
 #define UNSORTEDASSOCMAP_H_
 
+#include <cstddef>
 #include <vector>
 #include <utility>
 
+/// new revision of an UnsortedAssocMap, unique among all the maps (see UnsortedAssocMap::revision)
+std::size_t UnsortedAssocMapNextRevision();
 
 template<typename T1, typename T2>
 class UnsortedAssocMap
@@ -63,6 +66,24 @@ class UnsortedAssocMap
 
 		typedef UnsortedAssocMap<T1, T2> Self;
 
+		UnsortedAssocMap(): revision_(UnsortedAssocMapNextRevision()) {}
+
+		UnsortedAssocMap(const Self& rhs): container_(rhs.container_), revision_(rhs.revision_) {}
+
+		Self& operator=(const Self& rhs)
+		{
+			container_ = rhs.container_;
+			revision_ = rhs.revision_;
+			return *this;
+		}
+
+		/// changed by each change of the keys (push_back, erase) to a revision never given before (to any map)
+		/// a copy has the revision of its source: maps of the same revision have the same positions
+		std::size_t revision() const
+		{
+			return revision_;
+		}
+
 
 		const_iterator find(const first_type& value) const
 		{
@@ -77,10 +98,12 @@ class UnsortedAssocMap
 		void push_back(const value_type& value)
 		{
 			container_.push_back(value);
+			revision_ = UnsortedAssocMapNextRevision();
 		}
 
 		iterator erase(const iterator& it)
 		{
+			revision_ = UnsortedAssocMapNextRevision();
 			return container_.erase(it);
 		}
 
@@ -131,6 +154,7 @@ class UnsortedAssocMap
 
 	private:
 		container_type container_;
+		std::size_t revision_;
 
 
 		const_iterator _find(const first_type& value) const
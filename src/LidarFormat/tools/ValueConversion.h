@@ -0,0 +1,111 @@
+/***********************************************************************
+
+This file is part of the LidarFormat project source files.
+
+LidarFormat is an open source library for efficiently handling 3D point 
+clouds with a variable number of attributes at runtime. 
+
+
+Homepage: 
+
+    http://code.google.com/p/lidarformat
+
+Copyright:
+
+    Institut Geographique National & CEMAGREF (2009)
+
+Author: 
+
+    Adrien Chauve
+
+Contributors:
+
+    Nicolas David, Olivier Tournaire, Bruno Vallet
+
+
+
+    LidarFormat is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LidarFormat is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with LidarFormat.  If not, see <http://www.gnu.org/licenses/>.
+
+***********************************************************************/
+
+
+#ifndef VALUECONVERSION_H_
+#define VALUECONVERSION_H_
+
+#include <cmath>
+#include <limits>
+
+#include "LidarFormat/LidarDataFormatTypes.h"
+
+namespace Lidar
+{
+
+/// conversion of a value to the range of TDest: returns false if it is out of the range (converted is then clamped, 0 for NaN)
+/// floating point values are truncated toward zero as with static_cast, infinite values are kept by floating point types
+template<typename TDest, typename TSource>
+inline bool convertValue(const TSource value, TDest& converted)
+{
+    typedef std::numeric_limits<TDest> DestLimits;
+    typedef std::numeric_limits<TSource> SourceLimits;
+
+    if(!DestLimits::is_integer)
+    {
+        if(!SourceLimits::is_integer && sizeof(TDest) < sizeof(TSource) && value == value &&
+           (value > DestLimits::max() || value < -DestLimits::max()) && value != SourceLimits::infinity() && value != -SourceLimits::infinity())
+        {
+            converted = value > 0 ? DestLimits::max() : -DestLimits::max();
+            return false;
+        }
+        converted = static_cast<TDest>(value);
+        return true;
+    }
+
+    if(!SourceLimits::is_integer)
+    {
+        // [-2^digits, 2^digits[ for signed types, ]-1, 2^digits[ for unsigned types (exact bounds in floating point)
+        const TSource upper = std::ldexp(TSource(1), DestLimits::digits);
+        if(!(value < upper))
+        {
+            converted = value == value ? DestLimits::max() : TDest(0);
+            return false;
+        }
+        if(DestLimits::is_signed ? value < -upper : !(value > TSource(-1)))
+        {
+            converted = DestLimits::min();
+            return false;
+        }
+        converted = static_cast<TDest>(value);
+        return true;
+    }
+
+    if(SourceLimits::is_signed && value < TSource(0))
+    {
+        if(!DestLimits::is_signed || static_cast<int64>(value) < static_cast<int64>(DestLimits::min()))
+        {
+            converted = DestLimits::min();
+            return false;
+        }
+    }
+    else if(static_cast<uint64>(value) > static_cast<uint64>(DestLimits::max()))
+    {
+        converted = DestLimits::max();
+        return false;
+    }
+    converted = static_cast<TDest>(value);
+    return true;
+}
+
+} //namespace Lidar
+
+#endif /* VALUECONVERSION_H_ */
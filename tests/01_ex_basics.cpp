@@ -141,9 +141,8 @@ int main()
 		for(; itb != ite; ++itb)
 			std::cout << *itb << "\n";
 
-		//NB: if you use non-const iterators, you need to use:
-		//	cout << LidarEcho(*itb) << "\n";
-		//because in this case the operator* returns a proxy to a LidarEcho
+		//NB: operator* returns a reference on the echo in the container (LidarConstEchoRef or LidarEchoRef), not a copy
+		//use LidarEcho(*itb) to copy it
 
 	}
 
@@ -64,7 +64,7 @@ struct FoncteurFiltre
 		{
 		}
 
-	bool operator()(const LidarEcho& echo) const
+	bool operator()(const LidarConstEchoRef& echo) const
 	{
 		return echo.value<double>(decalage_)>=seuilMin_ && echo.value<double>(decalage_)<=seuilMax_;
 	}
@@ -80,7 +80,7 @@ struct LessEcho
 	LessEcho(const unsigned int decalage):
 		decalage_(decalage){}
 
-	bool operator()(const LidarEcho& e1, const LidarEcho& e2) const
+	bool operator()(const LidarConstEchoRef& e1, const LidarConstEchoRef& e2) const
 	{
 		return e1.value<double>(decalage_) < e2.value<double>(decalage_);
 	}
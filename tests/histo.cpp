@@ -49,60 +49,17 @@ Contributors:
 #include "LidarFormat/LidarDataContainer.h"
 #include "LidarFormat/LidarFile.h"
 #include "LidarFormat/geometry/LidarCenteringTransfo.h"
-#include "LidarFormat/tools/AttributeBounds.h"
+#include "LidarFormat/tools/AttributeStatistics.h"
 
 using namespace Lidar;
 using namespace std;
 
-// histo for float classes
-template <class T> void Histo(LidarDataContainer & ldc, unsigned int shift, int bins=100)
-{
-    vector<unsigned int> histo;
-    T min=numeric_limits<T>::max(), max=numeric_limits<T>::min();
-    for(LidarDataContainer::iterator it=ldc.begin(); it!=ldc.end(); it++)
-    {
-        T val = it.value<T>(shift);
-        if(val<min) min=val;
-        if(val>max) max=val;
-    }
-    T dv = (max-min)/bins;
-    for(LidarDataContainer::iterator it=ldc.begin(); it!=ldc.end(); it++)
-    {
-        T val = it.value<T>(shift);
-        int i = (val-min)/dv;
-        if(i<0) i=0;
-        if(!(i<histo.size())) i = histo.size();
-        histo[i]++;
-    }
-    for(int i=0; i<histo.size(); i++)
-    {
-        cout << min+i*dv << "-" << min+(i+1)*dv << ":" << histo[i] << endl;
-    }
-}
-
-// sparse histo for integer classes
-template <class T> void SparseHisto(LidarDataContainer & ldc, unsigned int shift)
-{
-    map<T, unsigned int> sparse_histo;
-    for(LidarDataContainer::iterator it=ldc.begin(); it!=ldc.end(); it++)
-    {
-        T val = it.value<T>(shift);
-        typename map<T, unsigned int>::iterator key = sparse_histo.find(val);
-        if(key == sparse_histo.end()) sparse_histo[val] = 1;
-        else key->second++;
-    }
-    for(typename map<T, unsigned int>::iterator key = sparse_histo.begin(); key != sparse_histo.end(); key++)
-    {
-        cout << (int)key->first << ":\t" << key->second << endl;
-    }
-}
-
 int main(int argc, char** argv)
 {
     if(argc<3)
     {
         cout << "Usage: " << argv[0] << " lidarfile.xml attrib_name [n_bins=100]" << std::endl;
-        cout << "Interger attribs: sparse histogram" << std::endl;
+        cout << "Integer attribs: sparse histogram (if less than " << AttributeStatistics::maxExactBins << " values)" << std::endl;
         cout << "Real attribs: n_bins bins between min and max" << std::endl;
         return 0;
     }
@@ -122,21 +79,20 @@ int main(int argc, char** argv)
         cout << "No attribute " << attrib_name << " in " << lidar_filename << endl;
         return 1;
     }
-    int shift = ldc.getDecalage(attrib_name);
 
-    switch(ldc.getAttributeType(attrib_name))
+    std::vector<AttributeStatistics> statistics;
+    computeAttributeStatistics(ldc, std::vector<std::string>(1, attrib_name), statistics, n_bins);
+    const AttributeStatistics& stats = statistics[0];
+    for(std::size_t i = 0; i < stats.histogram.size(); i++)
     {
-    case LidarDataType::float32: Histo<float32>(ldc, shift, n_bins); break;
-    case LidarDataType::float64: Histo<float64>(ldc, shift, n_bins); break;
-    case LidarDataType::int8: SparseHisto<int8>(ldc, shift); break;
-    case LidarDataType::int16: SparseHisto<int16>(ldc, shift); break;
-    case LidarDataType::int32: SparseHisto<int32>(ldc, shift); break;
-    case LidarDataType::int64: SparseHisto<int64>(ldc, shift); break;
-    case LidarDataType::uint8: SparseHisto<uint8>(ldc, shift); break;
-    case LidarDataType::uint16: SparseHisto<uint16>(ldc, shift); break;
-    case LidarDataType::uint32: SparseHisto<uint32>(ldc, shift); break;
-    case LidarDataType::uint64: SparseHisto<uint64>(ldc, shift); break;
+        if(stats.exactBins)
+        {
+            if(stats.histogram[i]) cout << stats.binMin(i) << ":\t" << stats.histogram[i] << endl;
+        }
+        else cout << stats.binMin(i) << "-" << stats.binMin(i+1) << ":" << stats.histogram[i] << endl;
     }
+    cout << "count " << stats.count << " mean " << stats.mean() << " stddev " << stats.stddev() << endl;
+    cout << "quantiles 1% " << stats.quantile(0.01) << " 50% " << stats.quantile(0.5) << " 99% " << stats.quantile(0.99) << endl;
 
     timer = clock()-timer;
     std::cout << "Time: " << ( double ) timer/CLOCKS_PER_SEC << " s" << std::endl;
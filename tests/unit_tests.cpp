@@ -46,8 +46,28 @@ Contributors:
 
 #include "config_data_test.h"
 
+#include <fstream>
+#include <sstream>
+#include <limits>
+#include <numeric>
+#include <clocale>
+#include <cstring>
+#include <boost/filesystem.hpp>
+
 #include "LidarFormat/LidarDataContainer.h"
 #include "LidarFormat/LidarFile.h"
+#include "LidarFormat/LidarFileIO.h"
+#include "LidarFormat/LidarStreamReader.h"
+#include "LidarFormat/LidarSegmentedData.h"
+#include "LidarFormat/LidarDataBuilder.h"
+#include "LidarFormat/tools/AttributeBounds.h"
+#include "LidarFormat/tools/AttributeStatistics.h"
+#include "LidarFormat/tools/ParallelBlocks.h"
+#include "LidarFormat/tools/AsciiNumbers.h"
+#include "LidarFormat/geometry/LidarSpatialIndexation2D.h"
+#include "LidarFormat/geometry/LidarKdTree.h"
+#include "LidarFormat/geometry/LidarOctree.h"
+#include "LidarFormat/extern/terrabin/TerraBin.h"
 
 using namespace Lidar;
 using namespace std;
@@ -152,4 +172,1349 @@ BOOST_AUTO_TEST_CASE( LidarIteratorAttribute_tests )
 
 
 
+BOOST_AUTO_TEST_CASE( ColumnarLayout_tests )
+{
+	LidarFile file(lidarFileName);
+	LidarDataContainer lidarContainer(LidarDataContainer::columnar);
+	file.loadData(lidarContainer);
+
+	BOOST_CHECK_EQUAL(lidarContainer.size(), 10);
+	const LidarConstIteratorXYZ<double> itBeginXYZ = lidarContainer.beginXYZ<double>();
+	BOOST_CHECK_EQUAL(*itBeginXYZ, TPoint3D<double>(firstX, firstY, firstZ));
+	BOOST_CHECK_EQUAL(*(itBeginXYZ+9), TPoint3D<double>(lastX, lastY, lastZ));
+	BOOST_CHECK_EQUAL(*(lidarContainer.endAttribute<double>("y")-1), lastY);
+	BOOST_CHECK_EQUAL((lidarContainer.end()-1).value<double>("z"), lastZ);
+
+	//ajout d'un attribut, d'un echo, suppression du premier echo
+	lidarContainer.addAttribute("intensity", LidarDataType::int16);
+	std::fill(lidarContainer.beginAttribute<int16>("intensity"), lidarContainer.endAttribute<int16>("intensity"), 7);
+	LidarEcho echo = lidarContainer[0];
+	echo.value<double>("x") = lastX;
+	lidarContainer.push_back(echo);
+	lidarContainer.erase(0);
+
+	BOOST_CHECK_EQUAL(lidarContainer.size(), 10);
+	BOOST_CHECK_EQUAL((lidarContainer.end()-1).value<double>("x"), lastX);
+	BOOST_CHECK_EQUAL((lidarContainer.end()-1).value<double>("y"), firstY);
+	BOOST_CHECK_EQUAL((lidarContainer.end()-2).value<int16>("intensity"), 7);
+
+	// growing within the capacity: the new echoes are set to 0, as in the interleaved layout
+	LidarDataContainer grown(lidarContainer);
+	BOOST_CHECK_EQUAL(grown.layout(), LidarDataContainer::columnar);
+	grown.clear();
+	grown.resize(10);
+	BOOST_CHECK_EQUAL(grown.beginAttribute<double>("x")[3], 0.);
+	BOOST_CHECK_EQUAL(std::count(grown.beginAttribute<int16>("intensity"), grown.endAttribute<int16>("intensity"), 0), 10);
+
+	lidarContainer.delAttribute("y");
+	lidarContainer.setLayout(LidarDataContainer::interleaved);
+
+	BOOST_CHECK_EQUAL(lidarContainer.pointSize(), 2*sizeof(double) + sizeof(int16));
+	BOOST_CHECK_EQUAL((lidarContainer.end()-1).value<double>("z"), firstZ);
+	BOOST_CHECK_EQUAL((lidarContainer.end()-1).value<int16>("intensity"), 7);
+	BOOST_CHECK_EQUAL(lidarContainer.begin().value<double>("x"), *(lidarContainer.beginAttribute<double>("x")));
+}
+
+BOOST_AUTO_TEST_CASE( ChangeAttributes_tests )
+{
+	LidarFile file(lidarFileName);
+	LidarDataContainer interleavedContainer, columnarContainer(LidarDataContainer::columnar);
+	file.loadData(interleavedContainer);
+	file.loadData(columnarContainer);
+
+	for(int layout = 0; layout < 2; ++layout)
+	{
+		LidarDataContainer& container = layout ? columnarContainer : interleavedContainer;
+		container.addAttribute("intensity", LidarDataType::int16);
+		std::fill(container.beginAttribute<int16>("intensity"), container.endAttribute<int16>("intensity"), 7);
+
+		// all the changes in a single pass
+		container.changeAttributes(AttributeChanges().remove("y").remove("none").changeType("z", LidarDataType::float32)
+		                           .add("classification", LidarDataType::uint8).add("x", LidarDataType::float32));
+		BOOST_CHECK_EQUAL(container.size(), 10);
+		BOOST_CHECK_EQUAL(container.pointSize(), sizeof(double) + sizeof(float) + sizeof(int16) + sizeof(uint8));
+		BOOST_CHECK_EQUAL(container.getAttributeType("x"), LidarDataType::float64);
+		BOOST_CHECK_EQUAL(container.getAttributeType("z"), LidarDataType::float32);
+		BOOST_CHECK(!container.checkAttributeIsPresent("y"));
+		BOOST_CHECK_EQUAL((container.end()-1).value<double>("x"), lastX);
+		BOOST_CHECK_EQUAL((container.end()-1).value<float>("z"), float(lastZ));
+		BOOST_CHECK_EQUAL((container.end()-1).value<int16>("intensity"), 7);
+		BOOST_CHECK_EQUAL(std::count(container.beginAttribute<uint8>("classification"), container.endAttribute<uint8>("classification"), 0), 10);
+		BOOST_CHECK_THROW(container.changeAttributes(AttributeChanges().changeType("y", LidarDataType::int8)), std::logic_error);
+
+		std::vector<std::string> names(1, "intensity");
+		names.push_back("classification");
+		container.delAttributeList(names);
+		BOOST_CHECK_EQUAL(container.pointSize(), sizeof(double) + sizeof(float));
+		BOOST_CHECK_EQUAL(container.begin().value<float>("z"), float(firstZ));
+	}
+}
+
+BOOST_AUTO_TEST_CASE( ChangeAttributesBlocks_tests )
+{
+	// more echoes than two reshape blocks: the reshape is split between threads, and in rounds of blocks when it is in place
+	const std::size_t nbEchos = 3*65536 + 5;
+	for(int layout = 0; layout < 2; ++layout)
+	{
+		LidarDataContainer container(layout ? LidarDataContainer::columnar : LidarDataContainer::interleaved);
+		container.addAttribute("x", LidarDataType::float64);
+		container.addAttribute("intensity", LidarDataType::int32);
+		container.addAttribute("y", LidarDataType::float64);
+		container.resize(nbEchos);
+		for(std::size_t i = 0; i < nbEchos; ++i)
+		{
+			container.beginAttribute<double>("x")[i] = i + 0.25;
+			container.beginAttribute<int32>("intensity")[i] = int32(i) - 100000;
+			container.beginAttribute<double>("y")[i] = -double(i);
+		}
+
+		container.changeAttributes(AttributeChanges().remove("y").changeType("x", LidarDataType::float32, AttributeChanges::cast, 1000.)
+		                           .changeType("intensity", LidarDataType::int16).add("classification", LidarDataType::uint8));
+		BOOST_CHECK_EQUAL(container.size(), nbEchos);
+		BOOST_CHECK_EQUAL(container.pointSize(), sizeof(float) + sizeof(int16) + sizeof(uint8));
+		bool converted = true;
+		for(std::size_t i = 0; i < nbEchos; ++i)
+		{
+			const int16 intensity = int16(std::max(-32768, std::min(32767, int(i) - 100000)));
+			converted = converted && container.beginAttribute<float>("x")[i] == float(i + 0.25 - 1000.) &&
+			            container.beginAttribute<int16>("intensity")[i] == intensity && container.beginAttribute<uint8>("classification")[i] == 0;
+		}
+		BOOST_CHECK(converted);
+
+		// the xml attributes follow the changes
+		const cs::LidarDataType::AttributesType::AttributeSequence& xmlAttributes = container.getXmlStructure()->attributes().attribute();
+		BOOST_CHECK_EQUAL(xmlAttributes.size(), 3);
+		BOOST_CHECK_EQUAL(xmlAttributes[0].name(), "x");
+		BOOST_CHECK(xmlAttributes[0].dataType() == LidarDataType::float32);
+		BOOST_CHECK_EQUAL(xmlAttributes[1].name(), "intensity");
+		BOOST_CHECK(xmlAttributes[1].dataType() == LidarDataType::int16);
+		BOOST_CHECK_EQUAL(xmlAttributes[2].name(), "classification");
+
+		// checked conversion in a new buffer: the container is not modified
+		BOOST_CHECK_THROW(container.changeAttributeType("intensity", LidarDataType::uint8, AttributeChanges::check), std::logic_error);
+		BOOST_CHECK_EQUAL(container.getAttributeType("intensity"), LidarDataType::int16);
+		BOOST_CHECK(xmlAttributes[1].dataType() == LidarDataType::int16);
+		BOOST_CHECK_EQUAL(container.beginAttribute<int16>("intensity")[nbEchos-1], 32767);
+	}
+}
+
+BOOST_AUTO_TEST_CASE( ChangeAttributeType_tests )
+{
+	const double values[] = {-1.5, 300.7, std::numeric_limits<double>::quiet_NaN(), 1e40, 42.};
+	for(int layout = 0; layout < 2; ++layout)
+	{
+		LidarDataContainer container(layout ? LidarDataContainer::columnar : LidarDataContainer::interleaved);
+		container.addAttribute("value", LidarDataType::float64);
+		container.addAttribute("count", LidarDataType::int32);
+		container.resize(5);
+		std::copy(values, values + 5, container.beginAttribute<double>("value"));
+		for(int i = 0; i < 5; ++i)
+			container.beginAttribute<int32>("count")[i] = (i - 2)*35000;
+
+		// checked conversion: the container is not modified
+		BOOST_CHECK_THROW(container.changeAttributeType("value", LidarDataType::uint8, AttributeChanges::check), std::logic_error);
+		BOOST_CHECK_EQUAL(container.getAttributeType("value"), LidarDataType::float64);
+		BOOST_CHECK_EQUAL(container.beginAttribute<double>("value")[3], 1e40);
+
+		container.changeAttributes(AttributeChanges().changeType("value", LidarDataType::float32).changeType("count", LidarDataType::int16));
+		BOOST_CHECK_EQUAL(container.beginAttribute<float>("value")[1], float(300.7));
+		BOOST_CHECK_EQUAL(container.beginAttribute<float>("value")[3], std::numeric_limits<float>::max());
+		BOOST_CHECK_EQUAL(container.beginAttribute<int16>("count")[0], std::numeric_limits<int16>::min());
+		BOOST_CHECK_EQUAL(container.beginAttribute<int16>("count")[2], 0);
+		BOOST_CHECK_EQUAL(container.beginAttribute<int16>("count")[4], std::numeric_limits<int16>::max());
+
+		container.changeAttributeType("value", LidarDataType::uint8);
+		const uint8 expected[] = {0, 255, 0, 255, 42};
+		BOOST_CHECK_EQUAL_COLLECTIONS(container.beginAttribute<uint8>("value"), container.endAttribute<uint8>("value"), expected, expected + 5);
+		BOOST_CHECK_EQUAL(container.pointSize(), sizeof(uint8) + sizeof(int16));
+
+		container.changeAttributeType("count", LidarDataType::uint8, AttributeChanges::cast);
+		BOOST_CHECK_EQUAL(container.beginAttribute<uint8>("count")[2], 0);
+	}
+}
+
+BOOST_AUTO_TEST_CASE( LidarEchoRef_tests )
+{
+	LidarFile file(lidarFileName);
+	LidarDataContainer interleavedContainer, columnarContainer(LidarDataContainer::columnar);
+	file.loadData(interleavedContainer);
+	file.loadData(columnarContainer);
+
+	// references on the echoes of both layouts
+	const LidarDataContainer::const_iterator it = columnarContainer.begin();
+	BOOST_CHECK_EQUAL(it->value<double>("x"), firstX);
+	BOOST_CHECK((*it) == interleavedContainer[0]);
+	BOOST_CHECK(!((*it) == interleavedContainer[9]));
+	LidarEchoRef echo = columnarContainer[1];
+	echo.value<double>("z") = lastZ;
+	BOOST_CHECK_EQUAL(columnarContainer.beginAttribute<double>("z")[1], lastZ);
+
+	// assigning a reference copies the echo, a LidarEcho is an independent copy
+	LidarEcho copy = columnarContainer[9];
+	echo = interleavedContainer[9];
+	BOOST_CHECK(copy == columnarContainer[1]);
+	copy.value<double>("x") = firstX;
+	BOOST_CHECK_EQUAL(columnarContainer.beginAttribute<double>("x")[1], lastX);
+
+	std::reverse(columnarContainer.begin(), columnarContainer.end());
+	BOOST_CHECK_EQUAL(columnarContainer.beginAttribute<double>("x")[0], lastX);
+	BOOST_CHECK_EQUAL(columnarContainer.beginAttribute<double>("y")[9], firstY);
+}
+
+/// sum of an attribute column, and scaling of a column (kernels of applyOnAttribute)
+struct SumKernel
+{
+	SumKernel(): sum(0) {}
+
+	template<typename T>
+	void operator()(LidarConstIteratorAttribute<T> begin, const LidarConstIteratorAttribute<T> end)
+	{
+		for(; begin != end; ++begin)
+			sum += *begin;
+	}
+
+	double sum;
+};
+
+struct DoubleKernel
+{
+	template<typename T>
+	void operator()(LidarIteratorAttribute<T> begin, const LidarIteratorAttribute<T> end)
+	{
+		for(; begin != end; ++begin)
+			*begin *= 2;
+	}
+};
+
+BOOST_AUTO_TEST_CASE( ApplyOnAttribute_tests )
+{
+	LidarFile file(lidarFileName);
+	LidarDataContainer lidarContainer(LidarDataContainer::columnar);
+	file.loadData(lidarContainer);
+	lidarContainer.addAttribute("intensity", LidarDataType::int16);
+	std::fill(lidarContainer.beginAttribute<int16>("intensity"), lidarContainer.endAttribute<int16>("intensity"), 7);
+
+	DoubleKernel doubleKernel;
+	lidarContainer.applyOnAttribute("intensity", doubleKernel);
+	SumKernel sumKernel;
+	static_cast<const LidarDataContainer&>(lidarContainer).applyOnAttribute("intensity", sumKernel);
+	BOOST_CHECK_EQUAL(sumKernel.sum, 140);
+
+	// centering copies the other attributes column by column
+	LidarCenteringTransfo transfo;
+	const shared_ptr<LidarDataContainer> centered = transfo.centerLidarDataContainer(lidarContainer);
+	BOOST_CHECK_EQUAL(transfo.x(), 919000);
+	BOOST_CHECK_CLOSE(centered->beginAttribute<float32>("x")[9], lastX - 919000, 1e-3);
+	BOOST_CHECK(std::equal(lidarContainer.beginAttribute<int16>("intensity"), lidarContainer.endAttribute<int16>("intensity"),
+	                       centered->beginAttribute<int16>("intensity")));
+}
+
+BOOST_AUTO_TEST_CASE( CenteringInPlace_tests )
+{
+	LidarFile file(lidarFileName);
+	for(int layout = 0; layout < 2; ++layout)
+	{
+		LidarDataContainer lidarContainer(layout ? LidarDataContainer::columnar : LidarDataContainer::interleaved);
+		file.loadData(lidarContainer);
+		lidarContainer.addAttribute("intensity", LidarDataType::int16);
+		std::fill(lidarContainer.beginAttribute<int16>("intensity"), lidarContainer.endAttribute<int16>("intensity"), 7);
+
+		LidarCenteringTransfo transfo;
+		transfo.centerLidarDataContainerInPlace(lidarContainer);
+		BOOST_CHECK_EQUAL(transfo.x(), 919000);
+		BOOST_CHECK_EQUAL(lidarContainer.getAttributeType("y"), LidarDataType::float32);
+		BOOST_CHECK_CLOSE(lidarContainer.beginAttribute<float32>("x")[9], lastX - 919000, 1e-3);
+		BOOST_CHECK_CLOSE(lidarContainer.beginAttribute<float32>("y")[0], firstY - 1914000, 1e-3);
+		BOOST_CHECK_CLOSE(lidarContainer.beginAttribute<float32>("z")[0], firstZ, 1e-3);
+		BOOST_CHECK_EQUAL(lidarContainer.beginAttribute<int16>("intensity")[9], 7);
+		double x = 0, y = 0;
+		BOOST_CHECK(lidarContainer.getCenteringTransfo(x, y));
+		BOOST_CHECK_EQUAL(y, 1914000);
+	}
+
+	// streaming: the chunks are centered with the transfo of the first echo
+	LidarStreamReader reader(lidarFileName, 3);
+	reader.setCentering(LidarCenteringTransfo());
+	LidarDataContainer chunk;
+	float lastChunkX = 0.f;
+	while(reader.readChunk(chunk))
+		lastChunkX = *(chunk.endAttribute<float32>("x")-1);
+	BOOST_CHECK_EQUAL(reader.centeringTransfo().x(), 919000);
+	BOOST_CHECK_CLOSE(lastChunkX, lastX - 919000, 1e-3);
+	LidarDataContainer metaData;
+	reader.loadMetaData(metaData);
+	BOOST_CHECK_EQUAL(metaData.getAttributeType("x"), LidarDataType::float32);
+}
+
+/// records the range of each block
+void recordBlock(std::vector<std::pair<std::size_t, std::size_t> >& ranges, const std::size_t block, const std::size_t first, const std::size_t count)
+{
+	ranges[block] = std::make_pair(first, count);
+}
+
+/// fails on the last block (a worker thread when there are several blocks)
+void failLastBlock(const std::size_t nbBlocks, const std::size_t block, const std::size_t /*first*/, const std::size_t /*count*/)
+{
+	if(block + 1 == nbBlocks)
+		throw std::logic_error("last block");
+}
+
+BOOST_AUTO_TEST_CASE( ParallelBlocks_tests )
+{
+	// the blocks cover each item once, in order, the first blocks have parallelBlockSize items
+	const std::size_t counts[] = {0, 5, 1000, 3*1000 + 7};
+	for(int c = 0; c < 4; ++c)
+	{
+		const std::size_t count = counts[c], nbBlocks = nbParallelBlocks(count, 1000);
+		BOOST_REQUIRE(nbBlocks >= 1);
+		std::vector<std::pair<std::size_t, std::size_t> > ranges(nbBlocks, std::make_pair(count + 1, count + 1));
+		parallelForBlocks(count, 1000, boost::bind(&recordBlock, boost::ref(ranges), _1, _2, _3));
+		std::size_t next = 0;
+		for(std::size_t block = 0; block < nbBlocks; ++block)
+		{
+			BOOST_CHECK_EQUAL(ranges[block].first, next);
+			BOOST_CHECK(ranges[block].second > 0 || count == 0);
+			BOOST_CHECK(ranges[block].second == parallelBlockSize(count, 1000) || block + 1 == nbBlocks);
+			next += ranges[block].second;
+		}
+		BOOST_CHECK_EQUAL(next, count);
+	}
+	BOOST_CHECK_EQUAL(nbParallelBlocks(1999, 1000), 1);
+
+	// the exception of a block is rethrown by the calling thread
+	const std::size_t nbBlocks = nbParallelBlocks(1 << 20, 1000);
+	BOOST_CHECK_THROW(parallelForBlocks(1 << 20, 1000, boost::bind(&failLastBlock, nbBlocks, _1, _2, _3)), std::logic_error);
+}
+
+BOOST_AUTO_TEST_CASE( AttributeBounds_tests )
+{
+	// a single block, and more echoes than two blocks (several threads)
+	const std::size_t sizes[] = {1003, 2*65536 + 7};
+	for(int test = 0; test < 4; ++test)
+	{
+		const int layout = test % 2 ? LidarDataContainer::columnar : LidarDataContainer::interleaved;
+		const std::size_t size = sizes[test / 2];
+		const std::size_t lastOdd = (size - 1) % 2 ? size - 1 : size - 2, lastEven = (size - 1) % 2 ? size - 2 : size - 1;
+		LidarDataContainer container(static_cast<LidarDataContainer::Layout>(layout));
+		container.addAttribute("z", LidarDataType::float32);
+		container.addAttribute("intensity", LidarDataType::int16);
+		container.resize(size);
+		for(std::size_t i = 0; i < container.size(); ++i)
+		{
+			container.beginAttribute<float32>("z")[i] = i % 2 ? -0.5f * i : 0.25f * i;
+			container.beginAttribute<int16>("intensity")[i] = static_cast<int16>(i % 100 - 30);
+		}
+
+		std::vector<std::string> names;
+		names.push_back("intensity");
+		names.push_back("z");
+		std::vector<AttributeBoundValues> bounds;
+		computeAttributeBounds(container, names, bounds);
+		BOOST_CHECK_EQUAL(bounds[0].min, -30);
+		BOOST_CHECK_EQUAL(bounds[0].max, 69);
+		BOOST_CHECK_EQUAL(bounds[0].count, size);
+		BOOST_CHECK_EQUAL(bounds[1].min, -0.5 * lastOdd);
+		BOOST_CHECK_EQUAL(bounds[1].max, 0.25 * lastEven);
+
+		double sum = 0.;
+		for(std::size_t i = 0; i < container.size(); ++i)
+			sum += container.beginAttribute<int16>("intensity")[i];
+		BOOST_CHECK_EQUAL(bounds[0].sum, sum);
+
+		container.recomputeBounds(true);
+		double min, max;
+		BOOST_CHECK(container.getAttributeBounds("intensity", min, max));
+		BOOST_CHECK_EQUAL(min, -30);
+		BOOST_CHECK_EQUAL(max, 69);
+	}
+}
+
+BOOST_AUTO_TEST_CASE( AttributeStatistics_tests )
+{
+	const string xmlFileName = (boost::filesystem::temp_directory_path() / "lidarformat_statistics_test.xml").string();
+
+	LidarDataContainer container(LidarDataContainer::columnar);
+	container.addAttribute("z", LidarDataType::float64);
+	container.addAttribute("classification", LidarDataType::uint8);
+	container.resize(1000);
+	for(std::size_t i = 0; i < container.size(); ++i)
+	{
+		container.beginAttribute<float64>("z")[i] = 100. + i * 0.1;
+		container.beginAttribute<uint8>("classification")[i] = i < 900 ? 2 : 6;
+	}
+
+	std::vector<AttributeStatistics> statistics;
+	container.computeStatistics(statistics, 10);
+	BOOST_CHECK_EQUAL(statistics.size(), 2);
+	BOOST_CHECK_EQUAL(statistics[0].count, 1000);
+	BOOST_CHECK_CLOSE(statistics[0].mean(), 149.95, 1e-9);
+	BOOST_CHECK_CLOSE(statistics[0].variance(), (1000. * 1000. - 1.) / 12. * 0.01, 1e-9);
+	BOOST_CHECK_EQUAL(statistics[0].histogram.size(), 10);
+	BOOST_CHECK_EQUAL(statistics[0].histogram[0], 100);
+	BOOST_CHECK_CLOSE(statistics[0].quantile(0.5), 150., 0.1);
+
+	// one bin per value for integers: exact histogram and quantiles
+	BOOST_CHECK(statistics[1].exactBins);
+	BOOST_CHECK_EQUAL(statistics[1].histogram.size(), 5);
+	BOOST_CHECK_EQUAL(statistics[1].histogram[0], 900);
+	BOOST_CHECK_EQUAL(statistics[1].histogram[4], 100);
+	BOOST_CHECK_EQUAL(statistics[1].quantile(0.9), 2);
+	BOOST_CHECK_EQUAL(statistics[1].quantile(0.95), 6);
+
+	// NaN and infinite values are counted apart, the histogram is on the finite values
+	LidarDataContainer nonFinite;
+	nonFinite.addAttribute("amplitude", LidarDataType::float32);
+	nonFinite.resize(6);
+	const float amplitudes[] = {1.f, std::numeric_limits<float>::infinity(), 2.f, -std::numeric_limits<float>::infinity(), 3.f, std::numeric_limits<float>::quiet_NaN()};
+	std::copy(amplitudes, amplitudes + 6, nonFinite.beginAttribute<float32>("amplitude"));
+	std::vector<AttributeStatistics> nonFiniteStatistics;
+	nonFinite.computeStatistics(nonFiniteStatistics, 4);
+	BOOST_CHECK_EQUAL(nonFiniteStatistics[0].count, 3);
+	BOOST_CHECK_EQUAL(nonFiniteStatistics[0].nbNonFinite, 3);
+	BOOST_CHECK_EQUAL(nonFiniteStatistics[0].min, 1.);
+	BOOST_CHECK_EQUAL(nonFiniteStatistics[0].max, 3.);
+	BOOST_CHECK_CLOSE(nonFiniteStatistics[0].mean(), 2., 1e-9);
+	BOOST_CHECK_EQUAL(std::accumulate(nonFiniteStatistics[0].histogram.begin(), nonFiniteStatistics[0].histogram.end(), std::size_t(0)), 3);
+
+	// summary in the xml
+	container.save(xmlFileName, cs::DataFormatType::binary);
+	LidarDataContainer loaded;
+	loaded.load(xmlFileName, true);
+	const AttributesInfo& info = loaded.getAttributeMap().find("z")->second;
+	BOOST_CHECK(info.mean().present() && info.stddev().present());
+	BOOST_CHECK_CLOSE(info.mean().get(), 149.95, 1e-9);
+
+	boost::filesystem::remove(xmlFileName);
+	boost::filesystem::remove(boost::filesystem::path(xmlFileName).replace_extension(".bin"));
+}
+
+BOOST_AUTO_TEST_CASE( MappedBinary_tests )
+{
+	LidarDataContainer asciiContainer(lidarFileName);
+	const string binFileName = (boost::filesystem::temp_directory_path() / "lidarformat_mapped_test.xml").string();
+	asciiContainer.save(binFileName, cs::DataFormatType::binary);
+
+	{
+		LidarDataContainer lidarContainer;
+		LidarFile(binFileName).mapData(lidarContainer);
+		BOOST_CHECK(lidarContainer.isMapped());
+		BOOST_CHECK_EQUAL(lidarContainer.size(), 10);
+		const LidarDataContainer& constContainer = lidarContainer;
+		BOOST_CHECK_EQUAL(*(constContainer.endXYZ<double>()-1), TPoint3D<double>(lastX, lastY, lastZ));
+	}
+
+	{
+		//copy on write : modifications are not written in the file
+		LidarDataContainer lidarContainer;
+		LidarFile(binFileName).mapData(lidarContainer, true);
+		*lidarContainer.beginAttribute<double>("x") = 0.;
+		BOOST_CHECK_EQUAL(*lidarContainer.beginAttribute<double>("x"), 0.);
+
+		lidarContainer.push_back(lidarContainer[1]);
+		BOOST_CHECK(!lidarContainer.isMapped());
+		BOOST_CHECK_EQUAL(lidarContainer.size(), 11);
+		BOOST_CHECK_EQUAL(*lidarContainer.beginAttribute<double>("x"), 0.);
+	}
+
+	LidarDataContainer lidarContainer(binFileName);
+	BOOST_CHECK_EQUAL(*lidarContainer.beginAttribute<double>("x"), firstX);
+
+	// no attributes: no record size to count the echoes
+	LidarDataContainer emptyContainer;
+	emptyContainer.save(binFileName, cs::DataFormatType::binary);
+	BOOST_CHECK_THROW(LidarFile(binFileName).mapData(emptyContainer), std::logic_error);
+
+	boost::filesystem::remove(binFileName);
+	boost::filesystem::remove(boost::filesystem::path(binFileName).replace_extension(".bin"));
+}
+
+/// pseudo random points of the spatial index tests, appended to a container (x, y and z of type T are added if needed):
+/// offset + [0,20[x[0,10[x[0,5[ for a scale of 100 (z is 0 for a flat cloud), the generator goes on from seed
+template<typename T>
+void appendPseudoRandomPoints(LidarDataContainer& lidarContainer, const std::size_t count, unsigned int& seed,
+                              const double scale = 100., const double offset = 0., const bool flat = false)
+{
+	if(!lidarContainer.checkAttributeIsPresent("x"))
+	{
+		lidarContainer.addAttribute("x", LidarTypeTraits<T>::enum_type);
+		lidarContainer.addAttribute("y", LidarTypeTraits<T>::enum_type);
+		lidarContainer.addAttribute("z", LidarTypeTraits<T>::enum_type);
+	}
+	const std::size_t first = lidarContainer.size();
+	lidarContainer.resize(first + count);
+	for(LidarIteratorXYZ<T> it = lidarContainer.beginXYZ<T>() + first; it != lidarContainer.endXYZ<T>(); ++it)
+	{
+		seed = seed*1103515245 + 12345;
+		it.x() = static_cast<T>(offset + (seed >> 8) % 2000 / scale);
+		seed = seed*1103515245 + 12345;
+		it.y() = static_cast<T>(offset + (seed >> 8) % 1000 / scale);
+		if(flat)
+			it.z() = T(0);
+		else
+		{
+			seed = seed*1103515245 + 12345;
+			it.z() = static_cast<T>(offset + (seed >> 8) % 500 / scale);
+		}
+	}
+}
+
+/// centre of the queries on these points
+const TPoint3D<float> queryCentre(7.3f, 4.1f, 2.2f);
+
+BOOST_AUTO_TEST_CASE( SpatialIndexation_tests )
+{
+	LidarDataContainer lidarContainer;
+	unsigned int seed = 1;
+	appendPseudoRandomPoints<float>(lidarContainer, 500, seed, 100., 0., true);
+
+	LidarSpatialIndexation2D spatialIndexation(lidarContainer);
+	spatialIndexation.setResolution(1);
+	spatialIndexation.indexData();
+
+	// each point is in a single cell, indices are ascending in each cell (whatever the number of threads)
+	std::size_t nbIndexed = 0;
+	for(int col = 0; col < spatialIndexation.getTaille().x; ++col)
+	{
+		nbIndexed += spatialIndexation.cellEnd(col, spatialIndexation.getTaille().y - 1) - spatialIndexation.cellBegin(col, 0);
+		for(int lig = 0; lig < spatialIndexation.getTaille().y; ++lig)
+			BOOST_CHECK(std::adjacent_find(spatialIndexation.cellBegin(col, lig), spatialIndexation.cellEnd(col, lig),
+			                               std::greater_equal<unsigned int>()) == spatialIndexation.cellEnd(col, lig));
+	}
+	BOOST_CHECK_EQUAL(nbIndexed, 500);
+
+	const TPoint2D<float> centre(queryCentre.x, queryCentre.y);
+	RasterSpatialIndexation::NeighborhoodListeType neighborhood, expected, rectangle;
+	spatialIndexation.GetCenteredNeighborhood(neighborhood, centre, 2.5f, Neighborhoods::CylindricalNeighborhood(centre, 2.5f));
+	spatialIndexation.getApproximateRectangularNeighborhood(rectangle, TPoint2D<float>(4.8f, 1.6f), TPoint2D<float>(9.8f, 6.6f));
+	std::sort(rectangle.begin(), rectangle.end());
+	BOOST_CHECK(std::adjacent_find(rectangle.begin(), rectangle.end()) == rectangle.end());
+	for(unsigned int i = 0; i < lidarContainer.size(); ++i)
+	{
+		const LidarConstIteratorXYZ<float> it = lidarContainer.beginXYZ<float>() + i;
+		if((it.x() - centre.x)*(it.x() - centre.x) + (it.y() - centre.y)*(it.y() - centre.y) <= 2.5f*2.5f)
+		{
+			expected.push_back(i);
+			BOOST_CHECK(std::binary_search(rectangle.begin(), rectangle.end(), i));
+		}
+	}
+	std::sort(neighborhood.begin(), neighborhood.end());
+	BOOST_CHECK(!expected.empty());
+	BOOST_CHECK_EQUAL_COLLECTIONS(neighborhood.begin(), neighborhood.end(), expected.begin(), expected.end());
+
+	// float64 coordinates are centered on the fly: same neighborhoods as the index of a centered copy
+	LidarDataContainer doubleContainer(lidarFileName);
+	LidarCenteringTransfo transfo(919000, 1914000);
+	const shared_ptr<LidarDataContainer> centeredContainer = transfo.centerLidarDataContainer(doubleContainer);
+	LidarSpatialIndexation2D doubleIndexation(doubleContainer, transfo), centeredIndexation(*centeredContainer);
+	doubleIndexation.setResolution(1);
+	doubleIndexation.indexData();
+	centeredIndexation.setResolution(1);
+	centeredIndexation.indexData();
+	BOOST_CHECK(doubleIndexation.getBBoxMin() == centeredIndexation.getBBoxMin());
+	const TPoint2D<float> doubleCentre(float(lastX - 919000), float(lastY - 1914000));
+	neighborhood.clear();
+	expected.clear();
+	doubleIndexation.GetCenteredNeighborhood(neighborhood, doubleCentre, 3.f, Neighborhoods::CylindricalNeighborhood(doubleCentre, 3.f));
+	centeredIndexation.GetCenteredNeighborhood(expected, doubleCentre, 3.f, Neighborhoods::CylindricalNeighborhood(doubleCentre, 3.f));
+	BOOST_CHECK(!neighborhood.empty());
+	BOOST_CHECK_EQUAL_COLLECTIONS(neighborhood.begin(), neighborhood.end(), expected.begin(), expected.end());
+
+	// more points than two fill blocks (grid filled by several threads): the points repeated are in the cells of the serial grid, in order
+	const std::size_t nbRepeats = 400;
+	LidarDataContainer repeatedContainer;
+	repeatedContainer.copy(lidarContainer, false);
+	for(std::size_t r = 0; r < nbRepeats; ++r)
+		repeatedContainer.append(lidarContainer);
+	LidarSpatialIndexation2D repeatedIndexation(repeatedContainer);
+	repeatedIndexation.setResolution(1);
+	repeatedIndexation.indexData();
+	BOOST_CHECK(repeatedIndexation.getTaille() == spatialIndexation.getTaille());
+	bool sameCells = true;
+	for(int col = 0; col < spatialIndexation.getTaille().x; ++col)
+		for(int lig = 0; lig < spatialIndexation.getTaille().y; ++lig)
+		{
+			std::vector<unsigned int> expectedCell;
+			for(std::size_t r = 0; r < nbRepeats; ++r)
+				for(RasterSpatialIndexation::CellIterator it = spatialIndexation.cellBegin(col, lig); it != spatialIndexation.cellEnd(col, lig); ++it)
+					expectedCell.push_back(static_cast<unsigned int>(r*lidarContainer.size() + *it));
+			sameCells = sameCells && repeatedIndexation.cellEnd(col, lig) - repeatedIndexation.cellBegin(col, lig) == static_cast<std::ptrdiff_t>(expectedCell.size()) &&
+			            std::equal(expectedCell.begin(), expectedCell.end(), repeatedIndexation.cellBegin(col, lig));
+		}
+	BOOST_CHECK(sameCells);
+}
+
+BOOST_AUTO_TEST_CASE( LidarKdTree_tests )
+{
+	// float64 coordinates, more echoes than two query blocks (queries of all the echoes on several threads)
+	LidarDataContainer lidarContainer;
+	unsigned int seed = 1;
+	appendPseudoRandomPoints<double>(lidarContainer, 3000, seed);
+
+	const LidarKdTree kdTree(lidarContainer, LidarCenteringTransfo(), 8);
+	BOOST_CHECK_EQUAL(kdTree.size(), 3000);
+
+	// brute force: (squared distance, index) of all the points, sorted
+	const TPoint3D<float>& point = queryCentre;
+	std::vector<std::pair<float, unsigned int> > expected;
+	for(unsigned int i = 0; i < lidarContainer.size(); ++i)
+	{
+		const LidarConstIteratorXYZ<double> it = lidarContainer.beginXYZ<double>() + i;
+		const float dx = float(it.x()) - point.x, dy = float(it.y()) - point.y, dz = float(it.z()) - point.z;
+		expected.push_back(std::make_pair(dx*dx + dy*dy + dz*dz, i));
+	}
+	std::sort(expected.begin(), expected.end());
+
+	LidarKdTree::NeighborhoodListeType indices;
+	std::vector<float> sqrDistances;
+	kdTree.knn(point, 10, indices, sqrDistances);
+	BOOST_REQUIRE_EQUAL(indices.size(), 10);
+	for(std::size_t i = 0; i < indices.size(); ++i)
+	{
+		BOOST_CHECK_EQUAL(indices[i], expected[i].second);
+		BOOST_CHECK_EQUAL(sqrDistances[i], expected[i].first);
+	}
+
+	kdTree.radiusSearch(point, 1.5f, indices, sqrDistances);
+	std::size_t nbInside = 0;
+	while(expected[nbInside].first <= 1.5f*1.5f)
+		++nbInside;
+	BOOST_REQUIRE_EQUAL(indices.size(), nbInside);
+	for(std::size_t i = 0; i < indices.size(); ++i)
+		BOOST_CHECK_EQUAL(indices[i], expected[i].second);
+
+	// batched queries (more than two query blocks): same results as single queries, each echo is its own nearest neighbour
+	LidarKdTree::NeighborhoodListeType allIndices, batchIndices;
+	std::vector<float> allDistances, batchDistances;
+	kdTree.knnAll(5, allIndices, allDistances);
+	BOOST_REQUIRE_EQUAL(allIndices.size(), 5*lidarContainer.size());
+	LidarDataContainer queryContainer;
+	appendPseudoRandomPoints<float>(queryContainer, 2*1024 + 5, seed);
+	const std::vector<TPoint3D<float> > queries(queryContainer.beginXYZ<float>(), queryContainer.endXYZ<float>());
+	kdTree.knn(queries, 5, batchIndices, batchDistances);
+	BOOST_REQUIRE_EQUAL(batchIndices.size(), 5*queries.size());
+	bool sameAsSingle = true;
+	for(std::size_t q = 0; q < queries.size(); ++q)
+	{
+		kdTree.knn(queries[q], 5, indices, sqrDistances);
+		sameAsSingle = sameAsSingle && std::equal(indices.begin(), indices.end(), batchIndices.begin() + 5*q) &&
+		               std::equal(sqrDistances.begin(), sqrDistances.end(), batchDistances.begin() + 5*q);
+	}
+	for(unsigned int i = 0; i < lidarContainer.size(); ++i)
+	{
+		const LidarConstIteratorXYZ<double> it = lidarContainer.beginXYZ<double>() + i;
+		kdTree.knn(TPoint3D<float>(float(it.x()), float(it.y()), float(it.z())), 5, indices, sqrDistances);
+		sameAsSingle = sameAsSingle && sqrDistances[0] == 0.f && std::equal(indices.begin(), indices.end(), allIndices.begin() + 5*i);
+	}
+	BOOST_CHECK(sameAsSingle);
+}
+
+BOOST_AUTO_TEST_CASE( LidarOctree_tests )
+{
+	// a sparse cloud in [0,20[x[0,10[x[0,5[ and a dense cluster in [5,5.1[^3
+	// more echoes than two blocks: the Morton codes are sorted by blocks then merged when there are several threads
+	LidarDataContainer lidarContainer;
+	unsigned int seed = 1;
+	appendPseudoRandomPoints<double>(lidarContainer, 2*65536, seed);
+	appendPseudoRandomPoints<double>(lidarContainer, 1000, seed, 10000., 5.);
+	std::vector<TPoint3D<float> > points;
+	for(LidarConstIteratorXYZ<double> it = lidarContainer.beginXYZ<double>(); it != lidarContainer.endXYZ<double>(); ++it)
+		points.push_back(TPoint3D<float>(float(it.x()), float(it.y()), float(it.z())));
+
+	const LidarOctree octree(lidarContainer, LidarCenteringTransfo(), 16);
+	BOOST_CHECK_EQUAL(octree.size(), 2*65536 + 1000);
+	BOOST_CHECK(octree.depth() > 5);
+
+	// brute force queries
+	const TPoint3D<float> min(4.f, 2.f, 1.f), max(5.05f, 6.f, 5.05f), centre(5.f, 5.f, 5.f);
+	std::vector<LidarOctree::Plane> planes;
+	planes.push_back(LidarOctree::Plane(TPoint3D<float>(1.f, 0.f, 0.f), -3.f));
+	planes.push_back(LidarOctree::Plane(TPoint3D<float>(-1.f, 1.f, 0.f), 2.f));
+	planes.push_back(LidarOctree::Plane(TPoint3D<float>(0.f, 0.f, -1.f), 5.02f));
+	LidarOctree::NeighborhoodListeType expectedBox, expectedSphere, expectedFrustum, list;
+	for(unsigned int i = 0; i < points.size(); ++i)
+	{
+		const TPoint3D<float>& p = points[i];
+		if(p.x >= min.x && p.y >= min.y && p.z >= min.z && p.x <= max.x && p.y <= max.y && p.z <= max.z)
+			expectedBox.push_back(i);
+		if((p.x - centre.x)*(p.x - centre.x) + (p.y - centre.y)*(p.y - centre.y) + (p.z - centre.z)*(p.z - centre.z) <= 0.05f*0.05f)
+			expectedSphere.push_back(i);
+		if(p.x - 3.f >= 0 && 2.f - p.x + p.y >= 0 && 5.02f - p.z >= 0)
+			expectedFrustum.push_back(i);
+	}
+	BOOST_CHECK(!expectedBox.empty() && !expectedSphere.empty() && !expectedFrustum.empty());
+
+	octree.boxQuery(list, min, max);
+	std::sort(list.begin(), list.end());
+	BOOST_CHECK(list == expectedBox);
+	list.clear();
+	octree.sphereQuery(list, centre, 0.05f);
+	std::sort(list.begin(), list.end());
+	BOOST_CHECK(list == expectedSphere);
+	list.clear();
+	octree.frustumQuery(list, planes);
+	std::sort(list.begin(), list.end());
+	BOOST_CHECK(list == expectedFrustum);
+
+	// the queries append to the list
+	octree.sphereQuery(list, centre, 0.05f);
+	BOOST_CHECK_EQUAL(list.size(), expectedFrustum.size() + expectedSphere.size());
+	std::sort(list.begin() + expectedFrustum.size(), list.end());
+	BOOST_CHECK(std::equal(expectedSphere.begin(), expectedSphere.end(), list.begin() + expectedFrustum.size()));
+}
+
+BOOST_AUTO_TEST_CASE( LidarStreamReader_tests )
+{
+	LidarDataContainer asciiContainer(lidarFileName);
+	const string binFileName = (boost::filesystem::temp_directory_path() / "lidarformat_stream_test.xml").string();
+	asciiContainer.save(binFileName, cs::DataFormatType::binary);
+
+	const string fileNames[] = {lidarFileName, binFileName};
+	for(int i = 0; i < 2; ++i)
+	{
+		LidarStreamReader reader(fileNames[i], 3);
+		LidarDataContainer chunk;
+		std::vector<std::size_t> chunkSizes;
+		double lastChunkX = 0.;
+		while(reader.readChunk(chunk))
+		{
+			if(chunkSizes.empty())
+				BOOST_CHECK_EQUAL(*chunk.beginAttribute<double>("x"), firstX);
+			chunkSizes.push_back(chunk.size());
+			lastChunkX = *(chunk.endAttribute<double>("x")-1);
+		}
+
+		BOOST_CHECK_EQUAL(chunkSizes.size(), 4);
+		BOOST_CHECK_EQUAL(chunkSizes.back(), 1);
+		BOOST_CHECK_EQUAL(reader.position(), 10);
+		BOOST_CHECK_EQUAL(lastChunkX, lastX);
+	}
+
+	boost::filesystem::remove(binFileName);
+	boost::filesystem::remove(boost::filesystem::path(binFileName).replace_extension(".bin"));
+}
+
+/// format without streaming: uses the default streaming of LidarFileIO (all the data loaded at once)
+class DefaultStreamingIO : public LidarFileIO
+{
+public:
+	explicit DefaultStreamingIO(const LidarDataContainer& source) : LidarFileIO(".txt"), m_source(source) {}
+	void loadData(LidarDataContainer& lidarContainer, std::string filename)
+	{
+		std::copy(m_source.begin(), m_source.end(), lidarContainer.begin());
+	}
+	void save(const LidarDataContainer& lidarContainer, std::string filename) {}
+
+private:
+	const LidarDataContainer& m_source;
+};
+
+BOOST_AUTO_TEST_CASE( DefaultStreaming_tests )
+{
+	LidarDataContainer asciiContainer(lidarFileName);
+	DefaultStreamingIO io(asciiContainer);
+	io.openStream(asciiContainer, lidarFileName);
+
+	LidarDataContainer chunk(asciiContainer.getXmlStructure());
+	std::size_t nbRead = 0;
+	while(std::size_t n = io.readChunk(chunk, 4))
+		nbRead += n;
+	BOOST_CHECK_EQUAL(nbRead, 10);
+	BOOST_CHECK_EQUAL(io.readChunk(chunk, 4), 0);
+
+	// rewind after the end of the stream
+	io.seekStream(chunk, 0);
+	BOOST_CHECK_EQUAL(io.readChunk(chunk, 3), 3);
+	BOOST_CHECK(std::equal(chunk.begin(), chunk.end(), asciiContainer.begin()));
+	io.seekStream(chunk, 8);
+	BOOST_CHECK_EQUAL(io.readChunk(chunk, 4), 2);
+	BOOST_CHECK_EQUAL(*(chunk.endAttribute<double>("x")-1), lastX);
+}
+
+BOOST_AUTO_TEST_CASE( LoadRange_tests )
+{
+	LidarDataContainer asciiContainer(lidarFileName);
+	const string binFileName = (boost::filesystem::temp_directory_path() / "lidarformat_range_test.xml").string();
+	asciiContainer.save(binFileName, cs::DataFormatType::binary);
+
+	const string fileNames[] = {lidarFileName, binFileName};
+	for(int i = 0; i < 2; ++i)
+	{
+		LidarFile file(fileNames[i]);
+		LidarDataContainer range;
+		file.loadRange(range, 2, 3);
+		BOOST_CHECK_EQUAL(range.size(), 3);
+		BOOST_CHECK(std::equal(range.begin(), range.end(), asciiContainer.begin() + 2));
+
+		// the range is truncated at the end of the file
+		file.loadRange(range, 8, 5);
+		BOOST_CHECK_EQUAL(range.size(), 2);
+		BOOST_CHECK_EQUAL(*(range.endAttribute<double>("x")-1), lastX);
+
+		std::vector<std::string> attributeNames(1, "z");
+		LidarDataContainer zRange;
+		file.loadRange(zRange, attributeNames, 4, 3);
+		BOOST_CHECK_EQUAL(zRange.size(), 3);
+		BOOST_CHECK(std::equal(zRange.beginAttribute<double>("z"), zRange.endAttribute<double>("z"), asciiContainer.beginAttribute<double>("z") + 4));
+
+		LidarStreamReader reader(fileNames[i], 2);
+		reader.setRange(5, 3);
+		LidarDataContainer chunk;
+		std::size_t nbRead = 0;
+		while(reader.readChunk(chunk))
+			nbRead += chunk.size();
+		BOOST_CHECK_EQUAL(nbRead, 3);
+		BOOST_CHECK_EQUAL(reader.position(), 8);
+	}
+
+	boost::filesystem::remove(binFileName);
+	boost::filesystem::remove(boost::filesystem::path(binFileName).replace_extension(".bin"));
+}
+
+BOOST_AUTO_TEST_CASE( LidarSegmentedData_tests )
+{
+	LidarFile file(lidarFileName);
+	LidarDataContainer tile, columnarTile(LidarDataContainer::columnar);
+	file.loadData(tile);
+	file.loadData(columnarTile);
+
+	// blocks of 4 echoes: the tiles cross the blocks
+	LidarSegmentedData merged(tile, 4), other(tile, 4);
+	merged.append(tile);
+	const LidarConstEchoRef first = merged[0];
+	other.append(columnarTile);
+	other.push_back(tile[0]);
+	merged.splice(other);
+	BOOST_CHECK(other.empty());
+	BOOST_CHECK_EQUAL(merged.size(), 21);
+	BOOST_CHECK_EQUAL(merged.nbBlocks(), 6);
+	BOOST_CHECK_EQUAL(first.value<double>("x"), firstX); // appending does not move the echoes
+	BOOST_CHECK(merged[19] == tile[9]);
+	merged[20].value<double>("z") = lastZ;
+
+	std::size_t count = 0;
+	for(LidarSegmentedData::const_iterator it = merged.begin(); it != merged.end(); ++it, ++count)
+		BOOST_CHECK(*it == tile[count % 10] || count == 20);
+	BOOST_CHECK_EQUAL(count, 21);
+
+	// the layout of the destination is kept
+	LidarSegmentedData copy(tile, 4);
+	copy.append(tile);
+	LidarDataContainer result(LidarDataContainer::columnar), interleavedResult;
+	merged.moveTo(result);
+	copy.moveTo(interleavedResult);
+	BOOST_CHECK(merged.empty());
+	BOOST_CHECK_EQUAL(result.layout(), LidarDataContainer::columnar);
+	BOOST_CHECK_EQUAL(result.size(), 21);
+	BOOST_CHECK_EQUAL(result.capacity(), 21);
+	BOOST_CHECK(result[13] == tile[3]);
+	BOOST_CHECK_EQUAL(result.beginAttribute<double>("x")[20], firstX);
+	BOOST_CHECK_EQUAL(result.beginAttribute<double>("z")[20], lastZ);
+	BOOST_CHECK_EQUAL(interleavedResult.layout(), LidarDataContainer::interleaved);
+	BOOST_CHECK(std::equal(interleavedResult.begin(), interleavedResult.end(), tile.begin()));
+
+	// same point size, other attributes
+	LidarDataContainer xContainer, yContainer;
+	xContainer.addAttribute("x", LidarDataType::float64);
+	yContainer.addAttribute("y", LidarDataType::float64);
+	yContainer.resize(3);
+	LidarSegmentedData xData(xContainer), yData(yContainer);
+	yData.append(yContainer);
+	BOOST_CHECK_THROW(xData.append(yContainer), std::logic_error);
+	BOOST_CHECK_THROW(xData.splice(yData), std::logic_error);
+	BOOST_CHECK_EQUAL(yData.size(), 3);
+}
+
+BOOST_AUTO_TEST_CASE( LidarDataBuilder_tests )
+{
+	LidarFile file(lidarFileName);
+	LidarDataContainer tile, columnarTile(LidarDataContainer::columnar);
+	file.loadData(tile);
+	file.loadData(columnarTile);
+	std::vector<char> record(tile.pointSize());
+	tile.exportRecords(&record[0], 9, 1);
+
+	for(int layout = 0; layout < 2; ++layout)
+	{
+		LidarDataContainer& container = layout ? columnarTile : tile;
+		const AttributeHandle<double> z = container.getAttributeHandle<double>("z");
+		LidarDataBuilder builder(container, 8);
+		BOOST_CHECK_EQUAL(container.capacity(), 18);
+		BOOST_CHECK_THROW(builder.cursor(6, 4), std::logic_error);
+
+		// two partly filled ranges: the echoes are kept in the order of the ranges
+		LidarAppendCursor first = builder.cursor(0, 4), second = builder.cursor(4, 4);
+		second.append(&record[0]);
+		second.append(container[0]);
+		second.value(z) = 0.5;
+		first.append(container[1]);
+		first.append();
+		first.pop_back();
+		BOOST_CHECK_EQUAL(first.size(), 1);
+		BOOST_CHECK(!second.full());
+
+		BOOST_CHECK_EQUAL(builder.commit(), 3);
+		BOOST_CHECK_EQUAL(container.size(), 13);
+		BOOST_CHECK(container[10] == container[1]);
+		BOOST_CHECK(container[11] == container[9]);
+		BOOST_CHECK_EQUAL(container[12].value<double>("x"), firstX);
+		BOOST_CHECK_EQUAL(container[12].value(z), 0.5);
+	}
+}
+
+BOOST_AUTO_TEST_CASE( AttributeHandle_tests )
+{
+	LidarDataContainer container(LidarDataContainer::columnar);
+	container.addAttribute("x", LidarDataType::float64);
+	container.addAttribute("intensity", LidarDataType::uint16);
+	container.resize(10);
+
+	AttributeHandle<uint16> intensity = container.getAttributeHandle<uint16>("intensity");
+	BOOST_CHECK(container.isValid(intensity));
+	BOOST_CHECK_THROW(container.getAttributeHandle<float32>("intensity"), std::logic_error);
+	BOOST_CHECK_THROW(container.getAttributeHandle<uint16>("none"), std::logic_error);
+
+	for(LidarDataContainer::iterator it = container.begin(); it != container.end(); ++it)
+		it.value(intensity) = 3;
+	BOOST_CHECK_EQUAL(std::count(container.beginAttribute(intensity), container.endAttribute(intensity), 3), 10);
+	BOOST_CHECK_EQUAL(container.createEcho().value(intensity), container.createEcho().value<uint16>("intensity"));
+
+	// the handle is stale after a change of the attributes
+	container.addAttribute("classification", LidarDataType::uint8);
+	BOOST_CHECK(!container.isValid(intensity));
+	intensity = container.getAttributeHandle<uint16>("intensity");
+	container.delAttribute("x");
+	BOOST_CHECK(!container.isValid(intensity));
+	intensity = container.getAttributeHandle<uint16>("intensity");
+	BOOST_CHECK_EQUAL(container.begin().value(intensity), 3);
+
+	// a copy has the same attributes, the handle stays valid until one of them changes its attributes
+	LidarDataContainer copy(container);
+	BOOST_CHECK(copy.isValid(intensity));
+	BOOST_CHECK_EQUAL((copy.end()-1).value(intensity), 3);
+	copy.delAttribute("classification");
+	container.delAttribute("classification");
+	BOOST_CHECK(!copy.isValid(intensity));
+	BOOST_CHECK(!copy.isValid(container.getAttributeHandle<uint16>("intensity")));
+
+	// an echo copied from a reference owns its attribute infos, the changes of the container do not affect it
+	const AttributeHandle<uint16> copyIntensity = copy.getAttributeHandle<uint16>("intensity");
+	const LidarEcho echo = copy[0];
+	copy.addAttribute("classification", LidarDataType::uint8);
+	BOOST_CHECK_EQUAL(echo.value(copyIntensity), 3);
+}
+
+/// sets a global locale with a decimal comma if one is installed, returns false (the "C" locale) otherwise
+bool setCommaLocale()
+{
+	const char* const names[] = {"fr_FR.UTF-8", "fr_FR.utf8", "fr_FR", "de_DE.UTF-8", "de_DE.utf8", "de_DE", "French_France.1252"};
+	for(int i = 0; i < 7; ++i)
+		if(setlocale(LC_ALL, names[i]) && localeconv()->decimal_point[0] == ',')
+			return true;
+	setlocale(LC_ALL, "C");
+	BOOST_TEST_MESSAGE("no locale with a decimal comma is installed: checked in the C locale");
+	return false;
+}
+
+BOOST_AUTO_TEST_CASE( AsciiParser_tests )
+{
+	const string txtFileName = (boost::filesystem::temp_directory_path() / "lidarformat_ascii_test.xml").string();
+	const string dataFileName = boost::filesystem::path(txtFileName).replace_extension(".txt").string();
+
+	LidarDataContainer container;
+	container.addAttribute("x", LidarDataType::float64);
+	container.addAttribute("intensity", LidarDataType::uint8);
+	container.addAttribute("delta", LidarDataType::int8);
+	container.addAttribute("t", LidarDataType::float32);
+	container.resize(3);
+	container.save(txtFileName, cs::DataFormatType::ascii);
+
+	// all the separators, values split on several lines, missing last echo
+	{
+		std::ofstream ofs(dataFileName.c_str());
+		ofs << "1.5, 200; -3:0.25\n-2e3 7\n-128\t1e-2\r\n";
+	}
+	LidarDataContainer loaded(txtFileName);
+	BOOST_CHECK_EQUAL(loaded.size(), 2);
+	BOOST_CHECK_EQUAL(loaded.beginAttribute<float64>("x")[0], 1.5);
+	BOOST_CHECK_EQUAL(loaded.beginAttribute<float64>("x")[1], -2000.);
+	BOOST_CHECK_EQUAL(int(loaded.beginAttribute<uint8>("intensity")[0]), 200);
+	BOOST_CHECK_EQUAL(int(loaded.beginAttribute<int8>("delta")[0]), -3);
+	BOOST_CHECK_EQUAL(int(loaded.beginAttribute<int8>("delta")[1]), -128);
+	BOOST_CHECK_EQUAL(loaded.beginAttribute<float32>("t")[1], 1e-2f);
+
+	{
+		std::ofstream ofs(dataFileName.c_str());
+		ofs << "1.5 200 -3 0.25\n1.5 2OO -3 0.25\n";
+	}
+	LidarDataContainer invalid;
+	BOOST_CHECK_THROW(invalid.load(txtFileName), std::logic_error);
+
+	// integers out of the range of their type
+	{
+		std::ofstream ofs(dataFileName.c_str());
+		ofs << "1.5 256 -3 0.25\n";
+	}
+	BOOST_CHECK_THROW(invalid.load(txtFileName), std::logic_error);
+	const char* const integers[] = {"-128", "-129", "127", "128", "-0", "18446744073709551615", "18446744073709551616", "-9223372036854775808"};
+	int8 int8Value = 0;
+	boost::uint64_t uint64Value = 0;
+	boost::int64_t int64Value = 0;
+	bool accepted[8];
+	for(int i = 0; i < 5; ++i)
+	{
+		const char* it = integers[i];
+		accepted[i] = parseAsciiValue(it, it + strlen(it), int8Value);
+	}
+	for(int i = 5; i < 7; ++i)
+	{
+		const char* it = integers[i];
+		accepted[i] = parseAsciiValue(it, it + strlen(it), uint64Value);
+	}
+	const char* itInt64 = integers[7];
+	accepted[7] = parseAsciiValue(itInt64, itInt64 + strlen(itInt64), int64Value);
+	const bool expectedAccepted[] = {true, false, true, false, true, true, false, true};
+	BOOST_CHECK_EQUAL_COLLECTIONS(accepted, accepted + 8, expectedAccepted, expectedAccepted + 8);
+	BOOST_CHECK_EQUAL(uint64Value, std::numeric_limits<boost::uint64_t>::max());
+	BOOST_CHECK_EQUAL(int64Value, std::numeric_limits<boost::int64_t>::min());
+	BOOST_CHECK_EQUAL(int(int8Value), 0);
+
+	// the values which fall back to strtod have a decimal point whatever the global locale
+	setCommaLocale();
+	const char* const fallbacks[] = {"1.5e-300", "0.12345678901234567890123", "-inf"};
+	const double expectedFallbacks[] = {1.5e-300, 0.12345678901234567890123, -std::numeric_limits<double>::infinity()};
+	for(int i = 0; i < 3; ++i)
+	{
+		const char* it = fallbacks[i];
+		double value = 0.;
+		BOOST_CHECK(parseAsciiValue(it, it + strlen(it), value) && value == expectedFallbacks[i] && *it == '\0');
+	}
+	setlocale(LC_ALL, "C");
+
+	// same values as the stream parser (operator>>)
+	LidarDataContainer xyz;
+	xyz.addAttribute("x", LidarDataType::float64);
+	xyz.addAttribute("y", LidarDataType::float64);
+	xyz.addAttribute("z", LidarDataType::float32);
+	xyz.resize(100000);
+	for(std::size_t i = 0; i < xyz.size(); ++i)
+	{
+		xyz.beginAttribute<float64>("x")[i] = 919351.96 + i * 0.0137;
+		xyz.beginAttribute<float64>("y")[i] = -1914105.38 / (i + 1);
+		xyz.beginAttribute<float32>("z")[i] = 1075.35f + i;
+	}
+	xyz.save(txtFileName, cs::DataFormatType::ascii);
+	LidarDataContainer parsed(txtFileName);
+	LidarStreamReader reader(txtFileName, xyz.size());
+	LidarDataContainer streamed;
+	reader.readChunk(streamed);
+	BOOST_CHECK_EQUAL(parsed.size(), xyz.size());
+	BOOST_CHECK(std::equal(parsed.begin(), parsed.end(), streamed.begin()));
+
+	boost::filesystem::remove(txtFileName);
+	boost::filesystem::remove(dataFileName);
+}
+
+BOOST_AUTO_TEST_CASE( AsciiWriter_tests )
+{
+	const string txtFileName = (boost::filesystem::temp_directory_path() / "lidarformat_ascii_writer_test.xml").string();
+	const string dataFileName = boost::filesystem::path(txtFileName).replace_extension(".txt").string();
+
+	LidarDataContainer container;
+	container.addAttribute("x", LidarDataType::float64);
+	container.addAttribute("intensity", LidarDataType::uint8);
+	container.addAttribute("delta", LidarDataType::int16);
+	container.addAttribute("t", LidarDataType::float32);
+	container.resize(40000);
+	for(std::size_t i = 0; i < container.size(); ++i)
+	{
+		container.beginAttribute<float64>("x")[i] = 919351.96 + i * 0.0137 - (i % 7 == 0 ? 1e7 : 0.);
+		container.beginAttribute<uint8>("intensity")[i] = i % 256;
+		container.beginAttribute<int16>("delta")[i] = -int(i % 1000);
+		container.beginAttribute<float32>("t")[i] = i % 3 ? 1.f / (i + 1) : 0.f;
+	}
+	container.save(txtFileName, cs::DataFormatType::ascii);
+
+	// same text as the echoes written with a precision of 12
+	std::ostringstream expected;
+	expected.precision(12);
+	for(LidarDataContainer::const_iterator it = container.begin(); it != container.end(); ++it)
+		expected << *it << "\n";
+	std::ifstream ifs(dataFileName.c_str());
+	std::ostringstream written;
+	written << ifs.rdbuf();
+	BOOST_CHECK(written.str() == expected.str());
+
+	// the values which fall back to sprintf have a decimal point whatever the global locale
+	setCommaLocale();
+	char buffer[32];
+	BOOST_CHECK_EQUAL(std::string(buffer, formatAsciiValue<double>(buffer, 1.5e-15, 12)), "1.5e-15");
+	BOOST_CHECK_EQUAL(std::string(buffer, formatAsciiValue<double>(buffer, -2.25e+300, 12)), "-2.25e+300");
+	BOOST_CHECK_EQUAL(std::string(buffer, formatAsciiValue<double>(buffer, std::numeric_limits<double>::infinity(), 12)), "inf");
+	setlocale(LC_ALL, "C");
+
+	boost::filesystem::remove(txtFileName);
+	boost::filesystem::remove(dataFileName);
+}
+
+BOOST_AUTO_TEST_CASE( AttributeProjection_tests )
+{
+	std::vector<std::string> attributeNames;
+	attributeNames.push_back("z");
+	attributeNames.push_back("x");
+
+	LidarDataContainer lidarContainer;
+	LidarFile(lidarFileName).loadData(lidarContainer, attributeNames);
+
+	BOOST_CHECK_EQUAL(lidarContainer.size(), 10);
+	BOOST_CHECK_EQUAL(lidarContainer.pointSize(), 2*sizeof(double));
+	BOOST_CHECK(!lidarContainer.checkAttributeIsPresent("y"));
+	BOOST_CHECK_EQUAL(*(lidarContainer.endAttribute<double>("x")-1), lastX);
+	BOOST_CHECK_EQUAL(*(lidarContainer.endAttribute<double>("z")-1), lastZ);
+
+	LidarDataContainer asciiContainer(lidarFileName);
+	const string binFileName = (boost::filesystem::temp_directory_path() / "lidarformat_projection_test.xml").string();
+	asciiContainer.save(binFileName, cs::DataFormatType::binary);
+
+	LidarStreamReader reader(binFileName, attributeNames, 4);
+	LidarDataContainer chunk;
+	reader.readChunk(chunk);
+	BOOST_CHECK_EQUAL(chunk.size(), 4);
+	BOOST_CHECK_EQUAL(chunk.pointSize(), 2*sizeof(double));
+	BOOST_CHECK_EQUAL(*chunk.beginAttribute<double>("z"), firstZ);
+
+	// the container and its xml structure are not modified
+	attributeNames.push_back("intensity");
+	BOOST_CHECK_THROW(LidarFile(binFileName).loadData(lidarContainer, attributeNames), std::logic_error);
+	BOOST_CHECK_EQUAL(lidarContainer.getXmlStructure()->attributes().attribute().size(), 2);
+	BOOST_CHECK_EQUAL(lidarContainer.getXmlStructure()->attributes().dataFormat(), cs::DataFormatType::ascii);
+	BOOST_CHECK_EQUAL(*(lidarContainer.endAttribute<double>("x")-1), lastX);
+
+	boost::filesystem::remove(binFileName);
+	boost::filesystem::remove(boost::filesystem::path(binFileName).replace_extension(".bin"));
+}
+
+/// overwrites the record length of the first variable length record of a LAS file
+void setLasExtraBytesLength(const string& fileName, const boost::uint16_t length)
+{
+	std::fstream fs(fileName.c_str(), std::ios::in | std::ios::out | std::ios::binary);
+	boost::uint16_t headerSize = 0;
+	fs.seekg(94);
+	fs.read(reinterpret_cast<char*>(&headerSize), sizeof(headerSize));
+	fs.seekp(headerSize + 20);
+	fs.write(reinterpret_cast<const char*>(&length), sizeof(length));
+	BOOST_REQUIRE(fs.good());
+}
+
+BOOST_AUTO_TEST_CASE( Las_tests )
+{
+	const string lasFileName = (boost::filesystem::temp_directory_path() / "lidarformat_las_test.las").string();
+
+	LidarDataContainer container;
+	container.addAttribute("x", LidarDataType::float64);
+	container.addAttribute("y", LidarDataType::float64);
+	container.addAttribute("z", LidarDataType::float32);
+	container.addAttribute("intensity", LidarDataType::uint16);
+	container.addAttribute("returnNumber", LidarDataType::uint8);
+	container.addAttribute("numberOfReturns", LidarDataType::uint8);
+	container.addAttribute("classification", LidarDataType::uint8);
+	container.addAttribute("gpsTime", LidarDataType::float64);
+	container.addAttribute("red", LidarDataType::uint16);
+	container.addAttribute("amplitude", LidarDataType::float32);
+	container.resize(100000);
+	for(std::size_t i = 0; i < container.size(); ++i)
+	{
+		container.beginAttribute<float64>("x")[i] = 651234.567 + i * 0.01;
+		container.beginAttribute<float64>("y")[i] = 6861234.5 - i * 0.001;
+		container.beginAttribute<float32>("z")[i] = 100.f + i % 7;
+		container.beginAttribute<uint16>("intensity")[i] = i % 60000;
+		container.beginAttribute<uint8>("returnNumber")[i] = 1 + i % 3;
+		container.beginAttribute<uint8>("numberOfReturns")[i] = 3;
+		container.beginAttribute<uint8>("classification")[i] = i % 20;
+		container.beginAttribute<float64>("gpsTime")[i] = 1e5 + i * 1e-3;
+		container.beginAttribute<uint16>("red")[i] = i % 65536;
+		container.beginAttribute<float32>("amplitude")[i] = i * 0.5f;
+	}
+	container.save(lasFileName);
+
+	// point data record format 3 with amplitude in extra bytes, native types
+	LidarDataContainer las(lasFileName);
+	BOOST_CHECK_EQUAL(las.size(), container.size());
+	BOOST_CHECK_EQUAL(las.getAttributeType("x"), LidarDataType::float64);
+	BOOST_CHECK_EQUAL(las.getAttributeType("intensity"), LidarDataType::uint16);
+	BOOST_CHECK_EQUAL(las.getAttributeType("amplitude"), LidarDataType::float32);
+	BOOST_CHECK(las.checkAttributeIsPresent("scanAngleRank"));
+	BOOST_CHECK(las.checkAttributeIsPresent("blue"));
+	for(std::size_t i = 0; i < container.size(); i += 997)
+	{
+		BOOST_CHECK_SMALL(las.beginAttribute<float64>("x")[i] - container.beginAttribute<float64>("x")[i], 1e-3);
+		BOOST_CHECK_SMALL(las.beginAttribute<float64>("y")[i] - container.beginAttribute<float64>("y")[i], 1e-3);
+		BOOST_CHECK_EQUAL(las.beginAttribute<float64>("z")[i], container.beginAttribute<float32>("z")[i]);
+		BOOST_CHECK_EQUAL(las.beginAttribute<uint16>("intensity")[i], container.beginAttribute<uint16>("intensity")[i]);
+		BOOST_CHECK_EQUAL(int(las.beginAttribute<uint8>("returnNumber")[i]), int(container.beginAttribute<uint8>("returnNumber")[i]));
+		BOOST_CHECK_EQUAL(int(las.beginAttribute<uint8>("classification")[i]), int(container.beginAttribute<uint8>("classification")[i]));
+		BOOST_CHECK_EQUAL(las.beginAttribute<float64>("gpsTime")[i], container.beginAttribute<float64>("gpsTime")[i]);
+		BOOST_CHECK_EQUAL(las.beginAttribute<uint16>("red")[i], container.beginAttribute<uint16>("red")[i]);
+		BOOST_CHECK_EQUAL(las.beginAttribute<float32>("amplitude")[i], container.beginAttribute<float32>("amplitude")[i]);
+	}
+
+	// streaming and ranges
+	LidarDataContainer range;
+	LidarFile(lasFileName).loadRange(range, 70000, 5);
+	BOOST_CHECK(std::equal(range.begin(), range.end(), las.begin() + 70000));
+	LidarStreamReader reader(lasFileName, 30000);
+	LidarDataContainer chunk;
+	std::size_t nbRead = 0;
+	while(reader.readChunk(chunk))
+	{
+		BOOST_CHECK(std::equal(chunk.begin(), chunk.end(), las.begin() + nbRead));
+		nbRead += chunk.size();
+	}
+	BOOST_CHECK_EQUAL(nbRead, las.size());
+
+	// length of the extra bytes record (the only variable length record): not a multiple of a descriptor, empty
+	setLasExtraBytesLength(lasFileName, 191);
+	BOOST_CHECK_THROW(LidarDataContainer corrupted(lasFileName), std::logic_error);
+	setLasExtraBytesLength(lasFileName, 0);
+	LidarDataContainer noExtraBytes(lasFileName);
+	BOOST_CHECK_EQUAL(noExtraBytes.size(), container.size());
+	BOOST_CHECK(!noExtraBytes.checkAttributeIsPresent("amplitude"));
+
+	// values that do not fit in the record format
+	container.beginAttribute<uint8>("classification")[0] = 40;
+	BOOST_CHECK_THROW(container.save(lasFileName), std::logic_error);
+
+	// whole value fields are range checked: an int32 intensity is written only if it fits in uint16
+	LidarDataContainer wideIntensity;
+	wideIntensity.addAttribute("x", LidarDataType::float64);
+	wideIntensity.addAttribute("y", LidarDataType::float64);
+	wideIntensity.addAttribute("z", LidarDataType::float64);
+	wideIntensity.addAttribute("intensity", LidarDataType::int32);
+	wideIntensity.resize(3);
+	std::fill(wideIntensity.beginAttribute<int32>("intensity"), wideIntensity.endAttribute<int32>("intensity"), 65535);
+	wideIntensity.save(lasFileName);
+	BOOST_CHECK_EQUAL(LidarDataContainer(lasFileName).beginAttribute<uint16>("intensity")[2], 65535);
+	wideIntensity.beginAttribute<int32>("intensity")[1] = 70000;
+	BOOST_CHECK_THROW(wideIntensity.save(lasFileName), std::logic_error);
+	wideIntensity.beginAttribute<int32>("intensity")[1] = -1;
+	BOOST_CHECK_THROW(wideIntensity.save(lasFileName), std::logic_error);
+
+	boost::filesystem::remove(lasFileName);
+	boost::filesystem::remove(boost::filesystem::path(lasFileName).replace_extension(".xml"));
+}
+
+/// length of the records of a TerraBin file, from its size and its header
+unsigned int terraBinRecordLength(const string& fileName, TerraScanHeader& header)
+{
+	BOOST_REQUIRE_EQUAL(ScanGetHeader(&header, fileName.c_str()), 1);
+	BOOST_REQUIRE(header.PntCnt > 0);
+	return static_cast<unsigned int>((boost::filesystem::file_size(fileName) - header.HdrSize) / header.PntCnt);
+}
+
+/// largest difference between the x, y, z (float64) of a container read from a file and of the saved one, translated by tx, ty
+double maxCoordinateError(const LidarDataContainer& read, const LidarDataContainer& saved, const double tx = 0., const double ty = 0.)
+{
+	double maxError = 0.;
+	LidarConstIteratorXYZ<double> it = read.beginXYZ<double>();
+	for(LidarConstIteratorXYZ<double> itSaved = saved.beginXYZ<double>(); itSaved != saved.endXYZ<double>(); ++it, ++itSaved)
+		maxError = std::max(maxError, std::max(std::abs(it.x() - itSaved.x() - tx), std::max(std::abs(it.y() - itSaved.y() - ty), std::abs(it.z() - itSaved.z()))));
+	return maxError;
+}
+
+BOOST_AUTO_TEST_CASE( TerraBin_tests )
+{
+	const string terraBinFileName = (boost::filesystem::temp_directory_path() / "lidarformat_terrabin_test.terrabin").string();
+	TerraScanHeader header;
+
+	// negative coordinates with fractions of millimetres, more echoes than a block of records
+	LidarDataContainer container;
+	container.addAttribute("x", LidarDataType::float64);
+	container.addAttribute("y", LidarDataType::float64);
+	container.addAttribute("z", LidarDataType::float64);
+	container.addAttribute("intensity", LidarDataType::uint16);
+	container.resize(70000);
+	for(std::size_t i = 0; i < container.size(); ++i)
+	{
+		container.beginAttribute<float64>("x")[i] = -1234.5675 + i * 0.01;
+		container.beginAttribute<float64>("y")[i] = 6861234.5 - i * 0.0001;
+		container.beginAttribute<float64>("z")[i] = -12.2504 + i % 7;
+		container.beginAttribute<uint16>("intensity")[i] = i % 60000;
+	}
+
+	// TerraScanPnt records, millimetric with an integer origin in meters: the floor of the minimum
+	container.save(terraBinFileName);
+	BOOST_CHECK_EQUAL(terraBinRecordLength(terraBinFileName, header), sizeof(TerraScanPnt));
+	BOOST_CHECK(!header.Time && !header.Color);
+	BOOST_CHECK_EQUAL(header.Units, 1000);
+	BOOST_CHECK_EQUAL(header.OrgX, 1235000.);
+	BOOST_CHECK_EQUAL(header.OrgY, -6861227000.);
+	BOOST_CHECK_EQUAL(header.OrgZ, 13000.);
+	{
+		LidarDataContainer terraBin(terraBinFileName);
+		BOOST_CHECK(!terraBin.checkAttributeIsPresent("time") && !terraBin.checkAttributeIsPresent("red"));
+		BOOST_CHECK(terraBin.checkAttributeIsPresent("line"));
+		BOOST_CHECK(maxCoordinateError(terraBin, container) <= 0.5e-3 + 1e-9);
+		BOOST_CHECK(std::equal(container.beginAttribute<uint16>("intensity"), container.endAttribute<uint16>("intensity"), terraBin.beginAttribute<uint16>("intensity")));
+	}
+
+	// time stamps appended to the records
+	container.addAttribute("time", LidarDataType::uint32);
+	for(std::size_t i = 0; i < container.size(); ++i)
+		container.beginAttribute<uint32>("time")[i] = 4000000000u + i;
+	container.save(terraBinFileName);
+	BOOST_CHECK_EQUAL(terraBinRecordLength(terraBinFileName, header), sizeof(TerraScanPnt) + 4);
+	BOOST_CHECK(header.Time && !header.Color);
+	{
+		LidarDataContainer terraBin(terraBinFileName);
+		BOOST_CHECK(!terraBin.checkAttributeIsPresent("red"));
+		BOOST_CHECK(std::equal(container.beginAttribute<uint32>("time"), container.endAttribute<uint32>("time"), terraBin.beginAttribute<uint32>("time")));
+	}
+
+	// colors (4 bytes) after the time stamps: a single channel is enough, the others are 0
+	container.addAttribute("blue", LidarDataType::uint8);
+	for(std::size_t i = 0; i < container.size(); ++i)
+		container.beginAttribute<uint8>("blue")[i] = i % 251;
+	container.save(terraBinFileName);
+	BOOST_CHECK_EQUAL(terraBinRecordLength(terraBinFileName, header), sizeof(TerraScanPnt) + 8);
+	BOOST_CHECK(header.Time && header.Color);
+	{
+		LidarDataContainer terraBin(terraBinFileName);
+		BOOST_CHECK(std::equal(container.beginAttribute<uint32>("time"), container.endAttribute<uint32>("time"), terraBin.beginAttribute<uint32>("time")));
+		BOOST_CHECK(std::equal(container.beginAttribute<uint8>("blue"), container.endAttribute<uint8>("blue"), terraBin.beginAttribute<uint8>("blue")));
+		BOOST_CHECK(std::count(terraBin.beginAttribute<uint8>("red"), terraBin.endAttribute<uint8>("red"), 0) == int(terraBin.size()));
+		BOOST_CHECK(std::count(terraBin.beginAttribute<uint8>("green"), terraBin.endAttribute<uint8>("green"), 0) == int(terraBin.size()));
+
+		LidarDataContainer range;
+		LidarFile(terraBinFileName).loadRange(range, 65530, 10);
+		BOOST_CHECK_EQUAL(range.size(), 10);
+		BOOST_CHECK(std::equal(range.begin(), range.end(), terraBin.begin() + 65530));
+	}
+	container.delAttribute("time");
+	container.save(terraBinFileName);
+	BOOST_CHECK_EQUAL(terraBinRecordLength(terraBinFileName, header), sizeof(TerraScanPnt) + 4);
+	BOOST_CHECK(!header.Time && header.Color);
+	BOOST_CHECK_EQUAL(int(*(LidarDataContainer(terraBinFileName).endAttribute<uint8>("blue") - 1)), int(*(container.endAttribute<uint8>("blue") - 1)));
+
+	// the centering transfo is added: absolute coordinates in the file
+	container.setCenteringTransfo(650000., -6000000.);
+	container.save(terraBinFileName);
+	BOOST_CHECK_EQUAL(terraBinRecordLength(terraBinFileName, header), sizeof(TerraScanPnt) + 4);
+	BOOST_CHECK_EQUAL(header.Units, 1000);
+	BOOST_CHECK_EQUAL(header.OrgX, -648765000.);
+	BOOST_CHECK_EQUAL(header.OrgY, -861227000.);
+	BOOST_CHECK(maxCoordinateError(LidarDataContainer(terraBinFileName), container, 650000., -6000000.) <= 0.5e-3 + 1e-9);
+	container.setCenteringTransfo(0., 0.);
+
+	// extents which do not fit in int32 millimetres: centimetres, then an error if they do not fit in meters
+	container.beginAttribute<float64>("x")[1] = 3e6;
+	container.save(terraBinFileName);
+	BOOST_CHECK_EQUAL(terraBinRecordLength(terraBinFileName, header), sizeof(TerraScanPnt) + 4);
+	BOOST_CHECK_EQUAL(header.Units, 100);
+	BOOST_CHECK(maxCoordinateError(LidarDataContainer(terraBinFileName), container) <= 0.5e-2 + 1e-9);
+	container.beginAttribute<float64>("x")[1] = 3e9;
+	BOOST_CHECK_THROW(container.save(terraBinFileName), std::logic_error);
+
+	boost::filesystem::remove(terraBinFileName);
+}
+
+
 BOOST_AUTO_TEST_SUITE_END()